@@ -0,0 +1,533 @@
+// async_file_reader.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include "file_reader.hpp"  // STD_PATH
+#include "chunk_pool.hpp"
+#include <string>
+#include <cstring>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+// Alignment for O_DIRECT / FILE_FLAG_NO_BUFFERING buffers, offsets and lengths
+constexpr size_t DIRECT_IO_ALIGN = 4096;
+constexpr size_t _default_async_depth = 4;
+
+#ifndef _WIN32
+// Minimal io_uring wrapper over raw syscalls (no liburing dependency)
+class IoUring {
+private:
+    int fd_ = -1;
+    void* sq_ring_ = nullptr;
+    size_t sq_ring_sz_ = 0;
+    void* cq_ring_ = nullptr;
+    size_t cq_ring_sz_ = 0;
+    struct io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_sz_ = 0;
+
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_head_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    struct io_uring_cqe* cqes_ = nullptr;
+
+    unsigned to_submit_ = 0;
+
+    void release() noexcept {
+        if (sqes_) munmap(sqes_, sqes_sz_);
+        if (cq_ring_ && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_sz_);
+        if (sq_ring_) munmap(sq_ring_, sq_ring_sz_);
+        if (fd_ != -1) ::close(fd_);
+        sqes_ = nullptr;
+        cq_ring_ = sq_ring_ = nullptr;
+        fd_ = -1;
+    }
+
+public:
+    explicit IoUring(unsigned entries) {
+        struct io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+        if (fd_ < 0) {
+            fd_ = -1;
+            throw std::runtime_error(std::string("[IoUring] io_uring_setup failed: ") + strerror(errno));
+        }
+
+        sq_ring_sz_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_ring_sz_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+        bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) {
+            sq_ring_sz_ = cq_ring_sz_ = std::max(sq_ring_sz_, cq_ring_sz_);
+        }
+
+        sq_ring_ = mmap(nullptr, sq_ring_sz_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            sq_ring_ = nullptr;
+            release();
+            throw std::runtime_error("[IoUring] SQ ring mmap failed");
+        }
+        if (single) {
+            cq_ring_ = sq_ring_;
+        } else {
+            cq_ring_ = mmap(nullptr, cq_ring_sz_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            fd_, IORING_OFF_CQ_RING);
+            if (cq_ring_ == MAP_FAILED) {
+                cq_ring_ = nullptr;
+                release();
+                throw std::runtime_error("[IoUring] CQ ring mmap failed");
+            }
+        }
+        sqes_sz_ = p.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqes = mmap(nullptr, sqes_sz_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            release();
+            throw std::runtime_error("[IoUring] SQE array mmap failed");
+        }
+        sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+        uint8_t* sq = static_cast<uint8_t*>(sq_ring_);
+        uint8_t* cq = static_cast<uint8_t*>(cq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_entries_ = p.sq_entries;
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+    }
+
+    ~IoUring() { release(); }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // Queue one read / write; returns false if the submission queue is full
+    bool queue_read(int fd, void* buf, unsigned len, uint64_t off, uint64_t user_data) noexcept {
+        return queue_rw(IORING_OP_READ, fd, buf, len, off, user_data);
+    }
+
+    bool queue_write(int fd, const void* buf, unsigned len, uint64_t off, uint64_t user_data) noexcept {
+        return queue_rw(IORING_OP_WRITE, fd, const_cast<void*>(buf), len, off, user_data);
+    }
+
+    bool queue_rw(uint8_t opcode, int fd, void* buf, unsigned len, uint64_t off, uint64_t user_data) noexcept {
+        unsigned tail = *sq_tail_;
+        if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+            return false;
+        }
+        unsigned idx = tail & sq_mask_;
+        struct io_uring_sqe* sqe = &sqes_[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(buf);
+        sqe->len = len;
+        sqe->off = off;
+        sqe->user_data = user_data;
+        sq_array_[idx] = idx;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++to_submit_;
+        return true;
+    }
+
+    // Submit queued SQEs and optionally block until min_complete CQEs are posted
+    void submit(unsigned min_complete = 0) {
+        unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+        while (true) {
+            long rc = syscall(__NR_io_uring_enter, fd_, to_submit_, min_complete, flags, nullptr, 0);
+            if (rc >= 0) {
+                to_submit_ -= std::min<unsigned>(to_submit_, static_cast<unsigned>(rc));
+                return;
+            }
+            if (errno != EINTR) {
+                throw std::runtime_error(std::string("[IoUring] io_uring_enter failed: ") + strerror(errno));
+            }
+        }
+    }
+
+    bool pop_completion(uint64_t& user_data, int32_t& res) noexcept {
+        unsigned head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        const struct io_uring_cqe* cqe = &cqes_[head & cq_mask_];
+        user_data = cqe->user_data;
+        res = cqe->res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+};
+#endif
+
+// Read-ahead file source: keeps `depth` chunks in flight (io_uring on Linux,
+// overlapped ReadFile on Windows) into DIRECT_IO_ALIGN-aligned buffers, so
+// the next chunk loads while the caller processes the current one.
+// Direct I/O is used when chunk size and offset are aligned, buffered I/O otherwise.
+class AsyncFileReader : public I_STREAM_READER {
+private:
+    struct Slot {
+        ChunkPool::Chunk chunk;
+        uint8_t* buf = nullptr;
+        size_t file_off = 0;
+        size_t want = 0;   // bytes of the chunk
+        size_t got = 0;    // bytes completed
+        bool busy = false; // holds a chunk (in flight or ready)
+        bool done = false; // completed
+        bool failed = false;
+#ifdef _WIN32
+        OVERLAPPED ov = {};
+        HANDLE h = INVALID_HANDLE_VALUE;
+#endif
+    };
+
+    STD_PATH path;
+    size_t chunk_sz;
+    size_t offs;
+    size_t depth;
+    bool want_direct;
+    size_t fsz = 0;
+    size_t chunk_count = 0;
+    size_t buf_sz = 0;
+
+    std::unique_ptr<ChunkPool> pool;  // DIRECT_IO_ALIGN-aligned slot buffers
+    std::vector<Slot> slots;
+    size_t head = 0;         // slot delivered next
+    size_t next_off = 0;     // next file offset to submit
+    bool view_out = false;   // head slot lent out by next_view()
+    ReaderCounters counters;
+
+#ifdef _WIN32
+    HANDLE h_buffered = INVALID_HANDLE_VALUE;
+    HANDLE h_direct = INVALID_HANDLE_VALUE;
+#else
+    int fd_buffered = -1;
+    int fd_direct = -1;
+    IoUring* ring = nullptr;  // nullptr: synchronous pread fallback
+#endif
+
+    bool aligned_io(size_t off, size_t len) const noexcept {
+        return off % DIRECT_IO_ALIGN == 0 && (len % DIRECT_IO_ALIGN == 0 || off + len == fsz);
+    }
+
+    void open_files() {
+#ifdef _WIN32
+        std::wstring wp = path.wstring();
+        h_buffered = CreateFileW(wp.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (h_buffered == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("[AsyncFileReader] Failed to open file: " + path.string());
+        }
+        if (want_direct) {
+            h_direct = CreateFileW(wp.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                   OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING, nullptr);
+        }
+#else
+        fd_buffered = ::open(path.string().c_str(), O_RDONLY);
+        if (fd_buffered == -1) {
+            throw std::runtime_error("[AsyncFileReader] Failed to open file: " + path.string());
+        }
+        posix_fadvise(fd_buffered, 0, 0, POSIX_FADV_SEQUENTIAL);
+        if (want_direct) {
+            fd_direct = ::open(path.string().c_str(), O_RDONLY | O_DIRECT);  // -1: fs without O_DIRECT
+        }
+        try {
+            ring = new IoUring(static_cast<unsigned>(depth));
+        } catch (const std::runtime_error&) {
+            ring = nullptr;  // no io_uring (old kernel / seccomp): synchronous reads
+        }
+#endif
+    }
+
+    void submit(Slot& s, size_t idx) {
+        s.file_off = next_off;
+        s.want = std::min(chunk_sz, fsz - next_off);
+        s.got = 0;
+        s.busy = true;
+        s.done = false;
+        s.failed = false;
+        next_off += s.want;
+        issue(s, idx);
+    }
+
+    // Start (or continue after a short read) the transfer of s
+    void issue(Slot& s, size_t idx) {
+        size_t off = s.file_off + s.got;
+        size_t len = s.want - s.got;
+#ifdef _WIN32
+        bool direct = h_direct != INVALID_HANDLE_VALUE && s.got == 0 && aligned_io(off, len);
+        s.h = direct ? h_direct : h_buffered;
+        DWORD n = static_cast<DWORD>(direct ? (len + DIRECT_IO_ALIGN - 1) & ~(DIRECT_IO_ALIGN - 1) : len);
+        HANDLE ev = s.ov.hEvent;
+        std::memset(&s.ov, 0, sizeof(s.ov));
+        s.ov.hEvent = ev;
+        s.ov.Offset = static_cast<DWORD>(off & 0xFFFFFFFFull);
+        s.ov.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(off) >> 32);
+        if (!ReadFile(s.h, s.buf + s.got, n, nullptr, &s.ov)) {
+            DWORD err = GetLastError();
+            if (err == ERROR_HANDLE_EOF) {
+                s.done = true;
+            } else if (err != ERROR_IO_PENDING) {
+                s.done = s.failed = true;
+            }
+        }
+        (void)idx;
+#else
+        bool direct = fd_direct != -1 && s.got == 0 && aligned_io(off, len);
+        int fd = direct ? fd_direct : fd_buffered;
+        // O_DIRECT length must stay aligned; the tail beyond EOF reads short
+        size_t n = direct ? (len + DIRECT_IO_ALIGN - 1) & ~(DIRECT_IO_ALIGN - 1) : len;
+        if (ring) {
+            if (!ring->queue_read(fd, s.buf + s.got, static_cast<unsigned>(n), off, idx)) {
+                ring->submit();
+                ring->queue_read(fd, s.buf + s.got, static_cast<unsigned>(n), off, idx);
+            }
+            ring->submit();
+        } else {
+            ssize_t rc = pread(fd, s.buf + s.got, n, static_cast<off_t>(off));
+            complete(s, idx, rc < 0 ? -errno : static_cast<int32_t>(rc));
+        }
+#endif
+    }
+
+#ifndef _WIN32
+    void complete(Slot& s, size_t idx, int32_t res) {
+        if (res < 0) {
+            if (res == -EINTR || res == -EAGAIN) {
+                issue(s, idx);
+                return;
+            }
+            s.done = s.failed = true;
+            return;
+        }
+        s.got += static_cast<size_t>(res);
+        if (s.got >= s.want || res == 0) {
+            s.got = std::min(s.got, s.want);
+            s.done = true;
+        } else {
+            issue(s, idx);  // short read: fetch the remainder
+        }
+    }
+#endif
+
+    void wait(Slot& s) {
+#ifdef _WIN32
+        if (s.done) {
+            return;
+        }
+        DWORD n = 0;
+        if (!GetOverlappedResult(s.h, &s.ov, &n, TRUE)) {
+            if (GetLastError() != ERROR_HANDLE_EOF) {
+                s.failed = true;
+            }
+        }
+        s.got = std::min(s.want, s.got + static_cast<size_t>(n));
+        s.done = true;
+#else
+        while (!s.done) {
+            uint64_t ud;
+            int32_t res;
+            bool any = false;
+            while (ring->pop_completion(ud, res)) {
+                any = true;
+                complete(slots[ud], static_cast<size_t>(ud), res);
+            }
+            if (!any && !s.done) {
+                ring->submit(1);
+            }
+        }
+#endif
+    }
+
+    // Queue the next chunk into the head slot and advance
+    void recycle_head() {
+        Slot& s = slots[head];
+        s.busy = false;
+        if (next_off < fsz) {
+            submit(s, head);
+        }
+        head = (head + 1) % slots.size();
+        view_out = false;
+    }
+
+    void drain() {
+        for (Slot& s : slots) {
+            if (s.busy) {
+                wait(s);
+                s.busy = false;
+            }
+        }
+        view_out = false;
+    }
+
+    void start(size_t offset) {
+        head = 0;
+        next_off = offset;
+        for (size_t i = 0; i < slots.size() && next_off < fsz; ++i) {
+            submit(slots[i], i);
+        }
+    }
+
+public:
+    // depth: chunks kept in flight; direct: use O_DIRECT / FILE_FLAG_NO_BUFFERING when aligned
+    AsyncFileReader(const std::string& file_path, size_t chunk_size, size_t offset = 0,
+                    size_t queue_depth = _default_async_depth, bool direct = true)
+        : path(file_path), chunk_sz(chunk_size), offs(offset),
+          depth(queue_depth ? queue_depth : 1), want_direct(direct)
+    {
+        fsz = fs::file_size(path);
+        chunk_count = (fsz + chunk_sz - 1) / chunk_sz;
+        buf_sz = (chunk_sz + DIRECT_IO_ALIGN - 1) & ~(DIRECT_IO_ALIGN - 1);
+
+        ChunkPoolOpts pool_opts;
+        pool_opts.align = DIRECT_IO_ALIGN;
+        pool.reset(new ChunkPool(buf_sz, depth, pool_opts));
+        slots.resize(depth);
+        for (Slot& s : slots) {
+            s.chunk = pool->try_acquire();
+            s.buf = s.chunk.data();
+#ifdef _WIN32
+            std::memset(&s.ov, 0, sizeof(s.ov));
+            s.ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+#endif
+        }
+        try {
+            open_files();
+            jump_to(offs);
+        } catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    ~AsyncFileReader() override { close(); }
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    // Next chunk in the reader's aligned buffer; size 0 at EOF.
+    // Valid until the next next_view()/read_into()/jump_to() call.
+    ByteView next_view() {
+        if (view_out) {
+            recycle_head();
+        }
+        Slot& s = slots[head];
+        if (!s.busy) {
+            return ByteView{nullptr, 0};  // EOF
+        }
+        wait(s);
+        if (s.failed) {
+            throw std::runtime_error("[AsyncFileReader] Read error");
+        }
+        view_out = true;
+        return ByteView{s.buf, s.got};
+    }
+
+    size_t read_into(uint8_t* buff_ptr) override {
+        return counters.timed_read(*this, [&]() {
+            ByteView v = next_view();
+            if (v.size) {
+                std::memcpy(buff_ptr, v.data, v.size);
+            }
+            if (view_out) {
+                recycle_head();  // refill right away, the caller owns its copy
+            }
+            return v.size;
+        });
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override {
+        if (!ReaderCounters::enabled) {
+            return false;
+        }
+        counters.snapshot(st);
+        return true;
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_sz; }
+    std::string get_type() const noexcept override { return "async file reader: " + path.string(); }
+
+    // Cancels read-ahead (waits for in-flight reads) and restarts at offset
+    void jump_to(size_t offset) {
+        if (offset > fsz) {
+            throw std::runtime_error("[AsyncFileReader] Failed to seek to offset");
+        }
+        drain();
+        start(offset);
+    }
+
+    size_t get_size() const noexcept { return fsz; }
+    size_t get_chunk_count() const noexcept { return chunk_count; }
+    size_t get_queue_depth() const noexcept { return depth; }
+    STD_PATH get_file_path() const noexcept { return path; }
+
+    bool is_direct() const noexcept {
+#ifdef _WIN32
+        return h_direct != INVALID_HANDLE_VALUE;
+#else
+        return fd_direct != -1;
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (h_buffered != INVALID_HANDLE_VALUE || h_direct != INVALID_HANDLE_VALUE) {
+            drain();
+        }
+        for (Slot& s : slots) {
+            if (s.ov.hEvent) {
+                CloseHandle(s.ov.hEvent);
+                s.ov.hEvent = nullptr;
+            }
+        }
+        if (h_direct != INVALID_HANDLE_VALUE) {
+            CloseHandle(h_direct);
+            h_direct = INVALID_HANDLE_VALUE;
+        }
+        if (h_buffered != INVALID_HANDLE_VALUE) {
+            CloseHandle(h_buffered);
+            h_buffered = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (ring) {
+            drain();  // kernel must not write into freed buffers
+            delete ring;
+            ring = nullptr;
+        }
+        if (fd_direct != -1) {
+            ::close(fd_direct);
+            fd_direct = -1;
+        }
+        if (fd_buffered != -1) {
+            ::close(fd_buffered);
+            fd_buffered = -1;
+        }
+#endif
+        for (Slot& s : slots) {
+            s.chunk.release();
+            s.buf = nullptr;
+            s.busy = false;
+        }
+    }
+};
@@ -0,0 +1,295 @@
+// chunk_pool.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include "cpu_placement.hpp"
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <iostream>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+struct ChunkPoolOpts {
+    size_t align = 4096;     // chunk start alignment (power of two, <= page size unless hugepages)
+    bool hugepages = false;  // back the slab with huge pages when the OS allows it
+    int numa_node = -1;      // slab pages on this NUMA node (e.g. the NIC's), -1 = first touch
+};
+
+// Fixed set of equally sized chunk buffers carved out of one aligned slab.
+// Chunks are handed out as move-only RAII handles and return to the pool
+// when the handle is dropped; acquire/release are lock-free and may be
+// called from any thread, so chunks can travel reader -> queue -> consumer
+// with no allocation and no copy.
+class ChunkPool {
+public:
+    class Chunk {
+    private:
+        ChunkPool* pool_ = nullptr;
+        uint32_t idx_ = 0;
+        size_t size_ = 0;
+
+        friend class ChunkPool;
+        Chunk(ChunkPool* pool, uint32_t idx) noexcept : pool_(pool), idx_(idx) {}
+
+    public:
+        Chunk() noexcept = default;
+        ~Chunk() { release(); }
+
+        Chunk(Chunk&& o) noexcept : pool_(o.pool_), idx_(o.idx_), size_(o.size_) { o.pool_ = nullptr; }
+        Chunk& operator=(Chunk&& o) noexcept {
+            if (this != &o) {
+                release();
+                pool_ = o.pool_;
+                idx_ = o.idx_;
+                size_ = o.size_;
+                o.pool_ = nullptr;
+            }
+            return *this;
+        }
+        Chunk(const Chunk&) = delete;
+        Chunk& operator=(const Chunk&) = delete;
+
+        explicit operator bool() const noexcept { return pool_ != nullptr; }
+
+        uint8_t* data() const noexcept { return pool_ ? pool_->slot(idx_) : nullptr; }
+        size_t capacity() const noexcept { return pool_ ? pool_->chunk_size() : 0; }
+        uint32_t index() const noexcept { return idx_; }
+
+        // Payload bytes (set by whoever filled the chunk)
+        size_t size() const noexcept { return size_; }
+        void set_size(size_t n) noexcept { size_ = n; }
+
+        ByteView view() const noexcept { return ByteView{data(), size_}; }
+
+        // Return to the pool early
+        void release() noexcept {
+            if (pool_) {
+                pool_->put(idx_);
+                pool_ = nullptr;
+                size_ = 0;
+            }
+        }
+    };
+
+private:
+    // Bounded MPMC queue of free slot indices (Vyukov)
+    struct Cell {
+        std::atomic<size_t> seq;
+        uint32_t idx;
+    };
+
+    size_t chunk_size_;
+    size_t count_;
+    size_t stride_;
+    ChunkPoolOpts opts_;
+    uint8_t* slab_ = nullptr;
+    size_t slab_size_ = 0;
+    bool huge_ = false;
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> enq_{0};
+    alignas(64) std::atomic<size_t> deq_{0};
+    alignas(64) std::atomic<size_t> free_count_{0};
+
+    void alloc_slab() {
+#ifdef _WIN32
+        auto valloc = [&](size_t sz, DWORD type) -> void* {
+            if (opts_.numa_node >= 0) {
+                return VirtualAllocExNuma(GetCurrentProcess(), nullptr, sz, type, PAGE_READWRITE,
+                                          static_cast<DWORD>(opts_.numa_node));
+            }
+            return VirtualAlloc(nullptr, sz, type, PAGE_READWRITE);
+        };
+        if (opts_.hugepages) {
+            SIZE_T large = GetLargePageMinimum();
+            if (large) {
+                size_t sz = (slab_size_ + large - 1) & ~(large - 1);
+                void* p = valloc(sz, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES);
+                if (p) {
+                    slab_ = static_cast<uint8_t*>(p);
+                    slab_size_ = sz;
+                    huge_ = true;
+                    return;
+                }
+            }
+        }
+        void* p = valloc(slab_size_, MEM_RESERVE | MEM_COMMIT);
+        if (!p) {
+            throw std::runtime_error("[ChunkPool] VirtualAlloc failed");
+        }
+        slab_ = static_cast<uint8_t*>(p);
+#else
+        if (opts_.hugepages) {
+    #ifdef MAP_HUGETLB
+            const size_t huge = 2 * 1024 * 1024;
+            size_t sz = (slab_size_ + huge - 1) & ~(huge - 1);
+            void* p = mmap(nullptr, sz, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                place(p, sz);
+                slab_ = static_cast<uint8_t*>(p);
+                slab_size_ = sz;
+                huge_ = true;
+                return;
+            }
+    #endif
+        }
+        void* p = mmap(nullptr, slab_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("[ChunkPool] mmap failed for " + std::to_string(slab_size_) + " bytes");
+        }
+    #ifdef MADV_HUGEPAGE
+        if (opts_.hugepages) {
+            madvise(p, slab_size_, MADV_HUGEPAGE);  // transparent huge pages fallback
+        }
+    #endif
+        place(p, slab_size_);
+        slab_ = static_cast<uint8_t*>(p);
+#endif
+    }
+
+#ifndef _WIN32
+    // NUMA placement before the first touch
+    void place(void* p, size_t sz) const noexcept {
+        if (opts_.numa_node >= 0 && !bind_memory_to_numa_node(p, sz, opts_.numa_node)) {
+            std::cerr << "Warning: Failed to bind chunk pool to NUMA node " << opts_.numa_node << "\n";
+        }
+    }
+#endif
+
+    void put(uint32_t idx) noexcept {
+        size_t pos = enq_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& c = cells_[pos & mask_];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enq_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.idx = idx;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    free_count_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            } else {
+                pos = enq_.load(std::memory_order_relaxed);  // capacity >= count: never full
+            }
+        }
+    }
+
+    bool take(uint32_t& idx) noexcept {
+        size_t pos = deq_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& c = cells_[pos & mask_];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (deq_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    idx = c.idx;
+                    c.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    free_count_.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // empty
+            } else {
+                pos = deq_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+public:
+    ChunkPool(size_t chunk_size, size_t count, const ChunkPoolOpts& opts = ChunkPoolOpts())
+        : chunk_size_(chunk_size), count_(count ? count : 1), opts_(opts)
+    {
+        if (opts_.align == 0 || (opts_.align & (opts_.align - 1)) != 0) {
+            throw std::runtime_error("[ChunkPool] Alignment must be a power of two");
+        }
+        stride_ = (chunk_size_ + opts_.align - 1) & ~(opts_.align - 1);
+        slab_size_ = stride_ * count_;
+        alloc_slab();
+
+        size_t cap = 1;
+        while (cap < count_) {
+            cap <<= 1;
+        }
+        mask_ = cap - 1;
+        cells_.reset(new Cell[cap]);
+        for (size_t i = 0; i < cap; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < count_; ++i) {
+            put(static_cast<uint32_t>(i));
+        }
+    }
+
+    ~ChunkPool() {
+        // All Chunk handles must be gone by now
+        if (slab_) {
+#ifdef _WIN32
+            VirtualFree(slab_, 0, MEM_RELEASE);
+#else
+            munmap(slab_, slab_size_);
+#endif
+        }
+    }
+
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    // Non-blocking; returns an empty handle when the pool is exhausted
+    Chunk try_acquire() noexcept {
+        uint32_t idx;
+        if (!take(idx)) {
+            return Chunk();
+        }
+        return Chunk(this, idx);
+    }
+
+    // Waits (spin, then yield/sleep) up to timeout_ms for a free chunk; < 0 waits forever.
+    // Returns an empty handle on timeout.
+    Chunk acquire(int32_t timeout_ms = -1) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        for (unsigned spin = 0;; ++spin) {
+            Chunk c = try_acquire();
+            if (c) {
+                return c;
+            }
+            if (spin < 64) {
+                continue;
+            }
+            if (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline) {
+                return Chunk();
+            }
+            if (spin < 256) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+    uint8_t* slot(size_t idx) const noexcept { return slab_ + idx * stride_; }
+
+    size_t chunk_size() const noexcept { return chunk_size_; }
+    size_t count() const noexcept { return count_; }
+    size_t available() const noexcept { return free_count_.load(std::memory_order_relaxed); }
+    bool uses_hugepages() const noexcept { return huge_; }
+
+    // Slab backing all chunks (e.g. for DMA / UMEM registration)
+    uint8_t* slab() const noexcept { return slab_; }
+    size_t slab_size() const noexcept { return slab_size_; }
+    size_t stride() const noexcept { return stride_; }
+};
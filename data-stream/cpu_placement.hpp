@@ -0,0 +1,273 @@
+// cpu_placement.hpp
+#pragma once
+#include "stream_reader.hpp"  // native_handle_t
+#include <thread>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdlib>
+#include <cstdint>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #if defined(__MINGW32__) && __has_include(<pthread.h>)
+        #include <pthread.h>  // winpthreads: pthread_gethandle()
+    #endif
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/syscall.h>
+    #include <linux/mempolicy.h>
+#endif
+
+// CPU option values besides a CPU number (>= 0) and -1 (no pinning)
+constexpr int CPU_NIC_LOCAL = -2;  // CPUs of the capture NIC's NUMA node (dev), spread by queue index
+constexpr int CPU_FOLLOW_RX = -3;  // the CPU the kernel delivers the socket's packets on (SO_INCOMING_CPU)
+
+// NUMA node option values besides a node number (>= 0) and -1 (OS default, first touch)
+constexpr int NUMA_NIC_NODE = -2;  // the node the capture NIC (dev) is attached to
+
+namespace cpu_detail {
+
+#ifdef _WIN32
+using os_thread_t = HANDLE;
+
+// MinGW (posix thread model) makes native_handle() a winpthreads pthread_t
+inline HANDLE os_thread(std::thread& t) noexcept {
+#ifdef __WINPTHREADS_VERSION
+    return pthread_gethandle(t.native_handle());
+#else
+    return t.native_handle();
+#endif
+}
+#else
+using os_thread_t = pthread_t;
+
+inline pthread_t os_thread(std::thread& t) noexcept { return t.native_handle(); }
+#endif
+
+inline bool pin(os_thread_t h, int cpu) noexcept {
+#ifdef _WIN32
+    if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+        return false;  // beyond one processor group's affinity mask
+    }
+    return SetThreadAffinityMask(h, DWORD_PTR(1) << cpu) != 0;
+#else
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(h, sizeof(set), &set) == 0;
+#endif
+}
+
+inline bool realtime(os_thread_t h, int priority) noexcept {
+    if (priority <= 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return SetThreadPriority(h, THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+    struct sched_param sp;
+    sp.sched_priority = priority;
+    return pthread_setschedparam(h, SCHED_FIFO, &sp) == 0;
+#endif
+}
+
+// "0-3,8,10-11" (sysfs cpulist)
+inline std::vector<int> parse_cpu_list(const std::string& s) {
+    std::vector<int> out;
+    const char* p = s.c_str();
+    while (*p) {
+        char* end = nullptr;
+        long a = std::strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        long b = a;
+        if (*end == '-') {
+            p = end + 1;
+            b = std::strtol(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+        }
+        for (long c = a; c <= b; ++c) {
+            out.push_back(static_cast<int>(c));
+        }
+        if (*end != ',') {
+            break;
+        }
+        p = end + 1;
+    }
+    return out;
+}
+
+inline std::string read_sysfs(const std::string& path) {
+    std::ifstream f(path);
+    std::string s;
+    std::getline(f, s);
+    return s;
+}
+
+} // namespace cpu_detail
+
+// Spin-wait hint (busy polling loops)
+inline void spin_pause() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Pin a thread to one CPU; returns false if the OS refused
+inline bool pin_thread_to_cpu(std::thread& t, int cpu) noexcept { return cpu_detail::pin(cpu_detail::os_thread(t), cpu); }
+
+inline bool pin_this_thread_to_cpu(int cpu) noexcept {
+#ifdef _WIN32
+    return cpu_detail::pin(GetCurrentThread(), cpu);
+#else
+    return cpu_detail::pin(pthread_self(), cpu);
+#endif
+}
+
+// SCHED_FIFO at priority (1..99; needs CAP_SYS_NICE or an rtprio limit).
+// Windows: THREAD_PRIORITY_TIME_CRITICAL. priority <= 0 leaves the thread as is.
+// A spinning (busy_wait) real-time thread starves everything else on its
+// CPU, the sender included on a loopback test: give it an isolated core.
+inline bool set_thread_rt_priority(std::thread& t, int priority) noexcept {
+    return cpu_detail::realtime(cpu_detail::os_thread(t), priority);
+}
+
+inline bool set_this_thread_rt_priority(int priority) noexcept {
+#ifdef _WIN32
+    return cpu_detail::realtime(GetCurrentThread(), priority);
+#else
+    return cpu_detail::realtime(pthread_self(), priority);
+#endif
+}
+
+// NUMA node of a network interface, -1 if unknown (virtual device, single node, Windows)
+inline int nic_numa_node(const std::string& dev) {
+#ifdef _WIN32
+    (void)dev;
+    return -1;
+#else
+    if (dev.empty()) {
+        return -1;
+    }
+    std::string s = cpu_detail::read_sysfs("/sys/class/net/" + dev + "/device/numa_node");
+    return s.empty() ? -1 : std::atoi(s.c_str());
+#endif
+}
+
+// CPUs local to a network interface (its NUMA node), empty if unknown
+inline std::vector<int> nic_local_cpus(const std::string& dev) {
+#ifdef _WIN32
+    (void)dev;
+    return {};
+#else
+    if (dev.empty()) {
+        return {};
+    }
+    return cpu_detail::parse_cpu_list(cpu_detail::read_sysfs("/sys/class/net/" + dev + "/device/local_cpulist"));
+#endif
+}
+
+// CPU option -> CPU number for thread `index` (CPU_NIC_LOCAL), -1 = no pinning.
+// CPU_FOLLOW_RX is resolved later from the socket and passed through.
+inline int resolve_cpu(int cpu, const std::string& dev, size_t index = 0) {
+    if (cpu != CPU_NIC_LOCAL) {
+        return cpu >= 0 || cpu == CPU_FOLLOW_RX ? cpu : -1;
+    }
+    std::vector<int> cpus = nic_local_cpus(dev);
+    return cpus.empty() ? -1 : cpus[index % cpus.size()];
+}
+
+inline int resolve_numa_node(int node, const std::string& dev) {
+    return node == NUMA_NIC_NODE ? nic_numa_node(dev) : (node >= 0 ? node : -1);
+}
+
+// CPU that processed the socket's last received packet, -1 if unknown
+inline int socket_incoming_cpu(native_handle_t fd) noexcept {
+#if defined(SO_INCOMING_CPU) && !defined(_WIN32)
+    int cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (getsockopt(static_cast<int>(fd), SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) != 0) {
+        return -1;
+    }
+    return cpu;
+#else
+    (void)fd;
+    return -1;
+#endif
+}
+
+// Prefer `node` for the not yet touched pages of [p, p + len) (mbind, MPOL_PREFERRED)
+inline bool bind_memory_to_numa_node(void* p, size_t len, int node) noexcept {
+#if defined(SYS_mbind) && !defined(_WIN32)
+    if (node < 0 || node >= 64) {
+        return false;
+    }
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_mbind, p, len, MPOL_PREFERRED, &mask, sizeof(mask) * 8, 0) == 0;
+#else
+    (void)p;
+    (void)len;
+    (void)node;
+    return false;
+#endif
+}
+
+// Memory the kernel allocates for this thread while in scope (packet rings,
+// populated mappings) prefers `node`; the previous policy is restored after.
+// -1 = no change
+class ScopedNumaPolicy {
+private:
+    bool set_ = false;
+#if defined(SYS_set_mempolicy) && defined(SYS_get_mempolicy) && !defined(_WIN32)
+    static constexpr unsigned long MAX_NODES = 1024;
+    int old_mode_ = MPOL_DEFAULT;
+    unsigned long old_mask_[MAX_NODES / (8 * sizeof(unsigned long))] = {};
+#endif
+
+public:
+    explicit ScopedNumaPolicy(int node) noexcept {
+#if defined(SYS_set_mempolicy) && defined(SYS_get_mempolicy) && !defined(_WIN32)
+        if (node < 0 || node >= 64) {
+            return;
+        }
+        if (syscall(SYS_get_mempolicy, &old_mode_, old_mask_, MAX_NODES, nullptr, 0) != 0) {
+            return;
+        }
+        unsigned long mask = 1UL << node;
+        set_ = syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, sizeof(mask) * 8) == 0;
+#else
+        (void)node;
+#endif
+    }
+
+    ~ScopedNumaPolicy() {
+#if defined(SYS_set_mempolicy) && defined(SYS_get_mempolicy) && !defined(_WIN32)
+        if (set_) {
+            syscall(SYS_set_mempolicy, old_mode_, old_mode_ == MPOL_DEFAULT ? nullptr : old_mask_,
+                    old_mode_ == MPOL_DEFAULT ? 0UL : MAX_NODES);
+        }
+#endif
+    }
+
+    ScopedNumaPolicy(const ScopedNumaPolicy&) = delete;
+    ScopedNumaPolicy& operator=(const ScopedNumaPolicy&) = delete;
+
+    bool active() const noexcept { return set_; }
+};
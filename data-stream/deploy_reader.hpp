@@ -0,0 +1,548 @@
+// deploy_reader.hpp
+#pragma once
+#include "file_reader.hpp"
+#include "multi_file_reader.hpp"
+#include "mmap_file_reader.hpp"
+#include "async_file_reader.hpp"
+#include "pcap_reader.hpp"
+#include "sock_reader.hpp"
+#include "multi_queue_reader.hpp"
+#include "threaded_reader.hpp"
+#include "seq_tracker.hpp"
+#include "iq_convert.hpp"
+#include "file_writer.hpp"
+#include <map>
+#include <set>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <stdexcept>
+
+// Parsed reader URI: scheme://location?key=value&key=value
+struct ReaderUri {
+    std::string scheme;
+    std::string location;                       // path (file, pcap) or [dev:]ip:port (udp)
+    std::map<std::string, std::string> params;
+
+    bool has(const std::string& key) const { return params.count(key) != 0; }
+};
+
+namespace deploy_detail {
+
+inline std::string percent_decode(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '%' && i + 2 < s.size() && std::isxdigit(static_cast<unsigned char>(s[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(s[i + 2]))) {
+            out += static_cast<char>(std::strtol(s.substr(i + 1, 2).c_str(), nullptr, 16));
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+[[noreturn]] inline void bad_value(const std::string& key, const std::string& v) {
+    throw std::runtime_error("[DeployReader] Invalid value for '" + key + "': " + v);
+}
+
+// Typed parameter access; keys nobody asked for after a build are typos
+class Params {
+private:
+    std::map<std::string, std::string> kv_;
+    std::set<std::string> used_;
+
+public:
+    explicit Params(const std::map<std::string, std::string>& kv) : kv_(kv) {}
+
+    bool take(const std::string& key, std::string& out) {
+        auto it = kv_.find(key);
+        if (it == kv_.end()) {
+            return false;
+        }
+        out = it->second;
+        used_.insert(key);
+        return true;
+    }
+
+    std::string str(const std::string& key, const std::string& def) {
+        std::string v;
+        return take(key, v) ? v : def;
+    }
+
+    // Integer with optional K / M / G (binary) suffix, at most max
+    uint64_t size(const std::string& key, uint64_t def, uint64_t max = UINT64_MAX) {
+        std::string v;
+        if (!take(key, v)) {
+            return def;
+        }
+        char* end = nullptr;
+        errno = 0;
+        unsigned long long n = std::strtoull(v.c_str(), &end, 0);
+        if (end == v.c_str() || v[0] == '-' || errno == ERANGE) {
+            bad_value(key, v);
+        }
+        unsigned shift = 0;
+        switch (*end) {
+            case 'k': case 'K': shift = 10; ++end; break;
+            case 'm': case 'M': shift = 20; ++end; break;
+            case 'g': case 'G': shift = 30; ++end; break;
+            default: break;
+        }
+        if (*end != '\0' || n > (max >> shift)) {
+            bad_value(key, v);
+        }
+        return n << shift;
+    }
+
+    // Signed integer within [min, max]
+    int64_t integer(const std::string& key, int64_t def, int64_t min = INT64_MIN, int64_t max = INT64_MAX) {
+        std::string v;
+        if (!take(key, v)) {
+            return def;
+        }
+        char* end = nullptr;
+        errno = 0;
+        long long n = std::strtoll(v.c_str(), &end, 10);
+        if (end == v.c_str() || *end != '\0' || errno == ERANGE || n < min || n > max) {
+            bad_value(key, v);
+        }
+        return n;
+    }
+
+    // CPU number, "nic" (CPU_NIC_LOCAL) or "rx" (CPU_FOLLOW_RX)
+    int cpu(const std::string& key, int def) {
+        std::string v;
+        if (!take(key, v)) {
+            return def;
+        }
+        if (v == "nic") {
+            return CPU_NIC_LOCAL;
+        }
+        if (v == "rx") {
+            return CPU_FOLLOW_RX;
+        }
+        char* end = nullptr;
+        long n = std::strtol(v.c_str(), &end, 10);
+        if (end == v.c_str() || *end != '\0' || n < -1) {
+            bad_value(key, v);
+        }
+        return static_cast<int>(n);
+    }
+
+    // NUMA node number or "nic" (NUMA_NIC_NODE)
+    int numa(const std::string& key, int def) {
+        std::string v;
+        if (!take(key, v)) {
+            return def;
+        }
+        if (v == "nic") {
+            return NUMA_NIC_NODE;
+        }
+        char* end = nullptr;
+        long n = std::strtol(v.c_str(), &end, 10);
+        if (end == v.c_str() || *end != '\0' || n < -1) {
+            bad_value(key, v);
+        }
+        return static_cast<int>(n);
+    }
+
+    // "" (bare key), 1/0, true/false, yes/no, on/off
+    bool flag(const std::string& key, bool def) {
+        std::string v;
+        if (!take(key, v)) {
+            return def;
+        }
+        if (v.empty() || v == "1" || v == "true" || v == "yes" || v == "on") {
+            return true;
+        }
+        if (v == "0" || v == "false" || v == "no" || v == "off") {
+            return false;
+        }
+        bad_value(key, v);
+    }
+
+    template<class E>
+    E choice(const std::string& key, E def, const std::vector<std::pair<const char*, E>>& names) {
+        std::string v;
+        if (!take(key, v)) {
+            return def;
+        }
+        for (const auto& n : names) {
+            if (v == n.first) {
+                return n.second;
+            }
+        }
+        bad_value(key, v);
+    }
+
+    void check_unused() const {
+        std::string keys;
+        for (const auto& kv : kv_) {
+            if (!used_.count(kv.first)) {
+                keys += (keys.empty() ? "" : ", ") + kv.first;
+            }
+        }
+        if (!keys.empty()) {
+            throw std::runtime_error("[DeployReader] Unknown parameter(s): " + keys);
+        }
+    }
+};
+
+inline std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t p = s.find(sep, start);
+        if (p == std::string::npos) {
+            p = s.size();
+        }
+        if (p > start) {
+            out.push_back(s.substr(start, p - start));
+        }
+        start = p + 1;
+    }
+    return out;
+}
+
+// [dev:]ip:port, IPv6 in brackets ([dev:][ff02::1]:port); dev may itself
+// be a Npcap "\Device\NPF_{GUID}" name
+inline void parse_endpoint(const std::string& loc, std::string& dev, std::string& ip, uint16_t& port) {
+    size_t c2 = loc.rfind(':');
+    if (c2 == std::string::npos) {
+        throw std::runtime_error("[DeployReader] Expected [dev:]ip:port, got '" + loc + "'");
+    }
+    char* end = nullptr;
+    long p = std::strtol(loc.c_str() + c2 + 1, &end, 10);
+    if (*end != '\0' || p < 1 || p > 65535) {
+        throw std::runtime_error("[DeployReader] Invalid port in '" + loc + "'");
+    }
+    port = static_cast<uint16_t>(p);
+    if (c2 > 0 && loc[c2 - 1] == ']') {
+        size_t open = loc.rfind('[', c2 - 1);
+        if (open == std::string::npos) {
+            throw std::runtime_error("[DeployReader] Unbalanced brackets in '" + loc + "'");
+        }
+        ip = loc.substr(open + 1, c2 - 2 - open);
+        dev = open > 0 ? loc.substr(0, open - 1) : "";
+        if (open > 0 && loc[open - 1] != ':') {
+            throw std::runtime_error("[DeployReader] Expected [dev:][ip6]:port, got '" + loc + "'");
+        }
+        if (ip.empty()) {
+            ip = "::";
+        }
+        return;
+    }
+    size_t c1 = c2 == 0 ? std::string::npos : loc.rfind(':', c2 - 1);
+    if (c1 == std::string::npos) {
+        dev.clear();
+        ip = loc.substr(0, c2);
+    } else {
+        dev = loc.substr(0, c1);
+        ip = loc.substr(c1 + 1, c2 - c1 - 1);
+    }
+    if (ip.empty()) {
+        ip = "0.0.0.0";
+    }
+}
+
+} // namespace deploy_detail
+
+// Split "scheme://location?k=v&k2=v2" (values percent-decoded).
+// file:///abs/path and file://rel/path both work; "file:///C:/x" -> "C:/x".
+inline ReaderUri parse_reader_uri(const std::string& uri) {
+    ReaderUri u;
+    size_t sep = uri.find("://");
+    if (sep == std::string::npos || sep == 0) {
+        throw std::runtime_error("[DeployReader] Missing scheme in '" + uri + "'");
+    }
+    u.scheme = uri.substr(0, sep);
+    for (char& c : u.scheme) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    std::string rest = uri.substr(sep + 3);
+    size_t q = rest.find('?');
+    u.location = deploy_detail::percent_decode(rest.substr(0, q));
+    if (u.location.size() > 2 && u.location[0] == '/' && u.location[2] == ':' &&
+        std::isalpha(static_cast<unsigned char>(u.location[1]))) {
+        u.location.erase(0, 1);
+    }
+    if (q != std::string::npos) {
+        for (const std::string& kv : deploy_detail::split(rest.substr(q + 1), '&')) {
+            size_t eq = kv.find('=');
+            std::string key = kv.substr(0, eq);
+            u.params[key] = eq == std::string::npos ? "" : deploy_detail::percent_decode(kv.substr(eq + 1));
+        }
+    }
+    return u;
+}
+
+namespace deploy_detail {
+
+// Everything is parsed into these plain specs (and the key set checked)
+// before a single file or socket is opened; the build_* functions only
+// construct from validated specs.
+
+struct FileSpec {
+    std::string mode;
+    size_t offs = 0;
+    size_t buf = _default_buf_sz;
+    size_t readahead = 0;
+    size_t depth = _default_async_depth;
+    bool direct = true;
+};
+
+inline FileSpec parse_file(Params& p) {
+    FileSpec f;
+    f.offs = p.size("offs", 0);
+    f.mode = p.str("mode", "stdio");
+    if (f.mode == "stdio" || f.mode == "multi") {
+        f.buf = p.size("buf", f.buf);
+    } else if (f.mode == "mmap") {
+        f.readahead = p.size("readahead", f.readahead);
+    } else if (f.mode == "async") {
+        f.depth = p.size("depth", f.depth);
+        f.direct = p.flag("direct", f.direct);
+    } else {
+        bad_value("mode", f.mode);
+    }
+    return f;
+}
+
+inline I_STREAM_READER* build_file(size_t chunk, const ReaderUri& u, const FileSpec& f) {
+    if (f.mode == "stdio") {
+        return new FileReader(u.location, chunk, f.offs, f.buf);
+    }
+    if (f.mode == "multi") {
+        return new MultiFileReader(u.location, chunk, f.offs, f.buf);
+    }
+    if (f.mode == "mmap") {
+        return new MmapFileReader(u.location, chunk, f.offs, f.readahead);
+    }
+    return new AsyncFileReader(u.location, chunk, f.offs, f.depth, f.direct);
+}
+
+struct UdpSpec {
+    std::string dev, ip;
+    uint16_t port = 0;
+    int32_t timeout_ms = 1000;
+    bool is_raw = false;
+    SocketReaderOpts opts;
+    size_t queues = 0;          // 0 = single socket reader
+    MultiQueueOpts mq;
+};
+
+inline UdpSpec parse_udp(const ReaderUri& u, Params& p) {
+    UdpSpec s;
+    parse_endpoint(u.location, s.dev, s.ip, s.port);
+    s.timeout_ms = static_cast<int32_t>(p.integer("timeout", s.timeout_ms, -1, INT32_MAX));
+
+    SocketReaderOpts& opts = s.opts;
+    opts.engine = p.choice<SocketEngine>("engine", SocketEngine::RECV,
+        {{"recv", SocketEngine::RECV}, {"tpacket", SocketEngine::TPACKET},
+         {"pcap", SocketEngine::PCAP}, {"xdp", SocketEngine::XDP}});
+    s.is_raw = p.flag("raw", opts.engine != SocketEngine::RECV);
+    opts.batch = p.size("batch", opts.batch);
+    opts.max_dgram_size = p.size("dgram", opts.max_dgram_size);
+    opts.ring_block_size = static_cast<uint32_t>(p.size("ring_block", opts.ring_block_size, UINT32_MAX));
+    opts.ring_block_count = static_cast<uint32_t>(p.size("ring_blocks", opts.ring_block_count, UINT32_MAX));
+    opts.ring_frame_size = static_cast<uint32_t>(p.size("ring_frame", opts.ring_frame_size, UINT32_MAX));
+    opts.ring_block_tov_ms = static_cast<uint32_t>(p.size("ring_tov", opts.ring_block_tov_ms, UINT32_MAX));
+    opts.pcap_buffer_size = p.size("pcap_buf", opts.pcap_buffer_size, INT_MAX);
+    opts.pcap_snaplen = p.size("snaplen", opts.pcap_snaplen);
+    opts.pcap_promisc = p.flag("promisc", opts.pcap_promisc);
+    opts.xdp_queue = static_cast<uint32_t>(p.size("xdp_queue", opts.xdp_queue, UINT32_MAX));
+    opts.xdp_frame_size = static_cast<uint32_t>(p.size("xdp_frame", opts.xdp_frame_size, UINT32_MAX));
+    opts.xdp_frame_count = static_cast<uint32_t>(p.size("xdp_frames", opts.xdp_frame_count, UINT32_MAX));
+    opts.xdp_ring_size = static_cast<uint32_t>(p.size("xdp_ring", opts.xdp_ring_size, UINT32_MAX));
+    opts.xdp_mode = p.choice<XdpMode>("xdp_mode", opts.xdp_mode,
+        {{"auto", XdpMode::AUTO}, {"zerocopy", XdpMode::ZEROCOPY},
+         {"copy", XdpMode::COPY}, {"generic", XdpMode::GENERIC}});
+    opts.nonblocking = p.flag("nonblock", opts.nonblocking);
+    opts.busy_poll_us = static_cast<uint32_t>(p.size("busy_poll", opts.busy_poll_us, UINT32_MAX));
+    opts.busy_wait = p.flag("busy_wait", opts.busy_wait);
+    opts.numa_node = p.numa("numa", opts.numa_node);
+    opts.rcvbuf = p.size("rcvbuf", opts.rcvbuf);
+    opts.rcvbuf_auto = p.flag("rcvbuf_auto", opts.rcvbuf_auto);
+    opts.rcvbuf_max = p.size("rcvbuf_max", opts.rcvbuf_max);
+    opts.mcast_sources = split(p.str("mcast_src", ""), ',');
+    opts.packet_meta = p.flag("meta", opts.packet_meta);
+    opts.timestamps = p.choice<TimestampMode>("tstamp", opts.timestamps,
+        {{"none", TimestampMode::NONE}, {"sw", TimestampMode::SOFTWARE}, {"hw", TimestampMode::HARDWARE}});
+
+    s.queues = p.size("queues", 0);
+    if (s.queues == 0) {
+        return s;
+    }
+    MultiQueueOpts& mq = s.mq;
+    mq.queues = s.queues;
+    mq.first_cpu = p.cpu("cpu", mq.first_cpu);
+    mq.rt_priority = static_cast<int>(p.integer("rt", mq.rt_priority, 0, 99));
+    mq.depth = p.size("queue_depth", mq.depth);
+    mq.balance = p.choice<QueueBalance>("balance", mq.balance,
+        {{"hash", QueueBalance::HASH}, {"rr", QueueBalance::ROUND_ROBIN},
+         {"cpu", QueueBalance::CPU}, {"seq", QueueBalance::SEQ}});
+    mq.ordered = p.flag("ordered", mq.ordered);
+    mq.reorder_wait_us = static_cast<uint32_t>(p.size("reorder_wait_us", mq.reorder_wait_us, UINT32_MAX));
+    mq.seq_offset = p.size("seq.offset", mq.seq_offset);
+    mq.seq_width = p.choice<size_t>("seq.width", mq.seq_width, {{"1", 1}, {"2", 2}, {"4", 4}, {"8", 8}});
+    mq.big_endian = p.flag("seq.be", mq.big_endian);
+    return s;
+}
+
+inline I_STREAM_READER* build_udp(size_t chunk, const UdpSpec& s) {
+    if (s.queues == 0) {
+        return create_socket_reader(s.ip, s.port, s.dev, s.timeout_ms, chunk, s.is_raw, s.opts);
+    }
+    return create_multi_queue_reader(s.ip, s.port, s.dev, s.timeout_ms, chunk, s.is_raw, s.opts, s.mq);
+}
+
+// One decorator stage; only the opts of `name` are filled in
+struct StageSpec {
+    std::string name;
+    SeqTrackerOpts seq;
+    ThreadedReaderOpts thread;
+    IqStageOpts iq;
+    FileWriterOpts record;
+    std::string record_path;
+};
+
+inline StageSpec parse_stage(const std::string& stage, Params& p) {
+    StageSpec s;
+    s.name = stage;
+    if (stage == "seq") {
+        SeqTrackerOpts& o = s.seq;
+        o.seq_offset = p.size("seq.offset", o.seq_offset);
+        o.seq_width = p.choice<size_t>("seq.width", o.seq_width, {{"1", 1}, {"2", 2}, {"4", 4}, {"8", 8}});
+        o.big_endian = p.flag("seq.be", o.big_endian);
+        o.strip_header = p.flag("seq.strip", o.strip_header);
+        o.policy = p.choice<GapPolicy>("seq.gap", o.policy,
+            {{"count", GapPolicy::COUNT}, {"zero", GapPolicy::ZERO_FILL}});
+        o.fill_size = p.size("seq.fill_size", o.fill_size);
+        o.max_fill = p.size("seq.max_fill", o.max_fill);
+        o.resync_gap = p.size("seq.resync", o.resync_gap);
+        o.drop_duplicates = p.flag("seq.drop_dups", o.drop_duplicates);
+    } else if (stage == "thread") {
+        ThreadedReaderOpts& o = s.thread;
+        o.depth = p.size("thread.depth", o.depth);
+        o.cpu = p.cpu("thread.cpu", o.cpu);
+        if (o.cpu == CPU_NIC_LOCAL) {
+            bad_value("thread.cpu", "nic");  // no device at this stage: use a number or rx
+        }
+        o.rt_priority = static_cast<int>(p.integer("thread.rt", o.rt_priority, 0, 99));
+        o.numa_node = p.numa("thread.numa", o.numa_node);
+        if (o.numa_node == NUMA_NIC_NODE) {
+            bad_value("thread.numa", "nic");
+        }
+        o.eof_on_empty = p.flag("thread.eof", o.eof_on_empty);
+    } else if (stage == "iq") {
+        IqStageOpts& o = s.iq;
+        o.hdr_sz = p.size("iq.hdr", o.hdr_sz);
+        o.normalize = p.flag("iq.norm", o.normalize);
+        o.kernel = p.choice<IqKernel>("iq.kernel", o.kernel,
+            {{"auto", IqKernel::AUTO}, {"scalar", IqKernel::SCALAR}, {"sse2", IqKernel::SSE2},
+             {"avx2", IqKernel::AVX2}, {"avx512", IqKernel::AVX512}, {"neon", IqKernel::NEON}});
+    } else if (stage == "record") {
+        FileWriterOpts& o = s.record;
+        s.record_path = p.str("record.path", "");
+        if (s.record_path.empty()) {
+            throw std::runtime_error("[DeployReader] Stage 'record' needs record.path");
+        }
+        o.buffer_size = p.size("record.buf", o.buffer_size);
+        o.depth = p.size("record.depth", o.depth);
+        o.direct = p.flag("record.direct", o.direct);
+        o.preallocate = p.size("record.prealloc", o.preallocate);
+        o.rotate_bytes = p.size("record.rotate", o.rotate_bytes);
+        o.rotate_sec = static_cast<double>(p.integer("record.rotate_sec", 0, 0));
+    } else {
+        bad_value("stages", stage);
+    }
+    return s;
+}
+
+// Wraps `inner` (owned) into one decorator stage
+inline I_STREAM_READER* build_stage(const StageSpec& s, I_STREAM_READER* inner) {
+    std::unique_ptr<I_STREAM_READER> guard(inner);
+    I_STREAM_READER* out = nullptr;
+    if (s.name == "seq") {
+        out = new SeqTrackingReader(inner, s.seq, true);
+    } else if (s.name == "thread") {
+        out = new ThreadedStreamReader(inner, s.thread, true);
+    } else if (s.name == "iq") {
+        out = new IqConvertReader(inner, s.iq, true);
+    } else {
+        out = new RecordingReader(inner, s.record_path, s.record, true);
+    }
+    guard.release();
+    return out;
+}
+
+} // namespace deploy_detail
+
+// Runtime reader factory: the source and the decorator pipeline come from
+// a URI, so switching engines / stages is deployment config.
+//   file:///data/x.bin?offs=4096&mode=stdio|mmap|async[&buf=4M|&readahead=8M|&depth=4&direct=0]
+//   file:///data/rec/rec_*.bin?mode=multi[&buf=4M]   (directory, wildcard or @manifest, see expand_file_set)
+//   pcap:///data/trace.pcapng?port=9999
+//   udp://enp3s0:192.168.250.196:9999?engine=recv|tpacket|pcap|xdp&batch=64[&raw=1][&timeout=1000]
+//       [&tstamp=sw|hw][&meta=1][&nonblock=1][&queues=4&balance=seq&cpu=2|nic|rx&rt=50]
+//       [&busy_poll=50&busy_wait=1][&numa=0|nic][&rcvbuf=16M&rcvbuf_auto=1&rcvbuf_max=256M]
+//       + engine keys (ring_*, pcap_*, xdp_*)
+//   udp://enp3s0:239.1.2.3:9999?mcast_src=10.0.0.5,10.0.0.6   (group joined on dev, optional SSM sources)
+//   udp://[ff15::1234]:9999, udp://eth0:[::]:9999             (IPv6, UDP engine)
+// Stages wrap the source inner -> outer in the order given:
+//   &stages=seq,thread,iq,record with seq.* / thread.* / iq.* / record.* keys (see parse_stage)
+// Unknown keys throw before anything is opened, so a typo never silently
+// falls back to a default.
+// Returned reader owns the whole chain; allocate get_chunk_size() of it
+// (the iq stage doubles the source chunk size).
+inline I_STREAM_READER* DeployReader(size_t chunk_size, const ReaderUri& uri) {
+    deploy_detail::Params p(uri.params);
+    std::vector<std::string> stages = deploy_detail::split(p.str("stages", ""), ',');
+    chunk_size = p.size("chunk", chunk_size);
+    if (chunk_size == 0) {
+        throw std::runtime_error("[DeployReader] Chunk size must be > 0");
+    }
+
+    // Parse and check every key first: nothing is opened (or truncated) on a typo
+    deploy_detail::FileSpec file;
+    deploy_detail::UdpSpec udp;
+    uint16_t pcap_port = 0;
+    if (uri.scheme == "file") {
+        file = deploy_detail::parse_file(p);
+    } else if (uri.scheme == "pcap") {
+        pcap_port = static_cast<uint16_t>(p.size("port", 0, 65535));
+    } else if (uri.scheme == "udp") {
+        udp = deploy_detail::parse_udp(uri, p);
+    } else {
+        throw std::runtime_error("[DeployReader] Unknown scheme '" + uri.scheme + "'");
+    }
+    std::vector<deploy_detail::StageSpec> specs;
+    for (const std::string& s : stages) {
+        specs.push_back(deploy_detail::parse_stage(s, p));
+    }
+    p.check_unused();
+
+    std::unique_ptr<I_STREAM_READER> reader;
+    if (uri.scheme == "file") {
+        reader.reset(deploy_detail::build_file(chunk_size, uri, file));
+    } else if (uri.scheme == "pcap") {
+        reader.reset(new PcapReader(uri.location, chunk_size, pcap_port));
+    } else {
+        reader.reset(deploy_detail::build_udp(chunk_size, udp));
+    }
+    for (const deploy_detail::StageSpec& s : specs) {
+        reader.reset(deploy_detail::build_stage(s, reader.release()));
+    }
+    return reader.release();
+}
+
+inline I_STREAM_READER* DeployReader(size_t chunk_size, const std::string& uri) {
+    return DeployReader(chunk_size, parse_reader_uri(uri));
+}
@@ -1,6 +1,7 @@
 // file_reader.hpp
 #pragma once
 #include "stream_reader.hpp"
+#include "reader_stats.hpp"
 #include <cstdio>
 #include <string>
 #include <filesystem>
@@ -28,6 +29,7 @@ private:
 
     size_t file_buffer_sz;
     char* vbuf_ = nullptr;
+    ReaderCounters counters;
 
 public:
     FileReader(const std::string& file_path, size_t chunk_size, size_t offset = 0, size_t file_buffer_size = _default_buf_sz)
@@ -65,11 +67,32 @@ public:
     ~FileReader() override { close(); }
 
     size_t read_into(uint8_t* buff_ptr) override {
-        size_t rd = fread(buff_ptr, 1, chunk_sz, pf);
-        if (rd < chunk_sz && ferror(pf)) {
-            throw std::runtime_error("[FileReader] Read error");
+        return counters.timed_read(*this, [&]() {
+            size_t rd = fread(buff_ptr, 1, chunk_sz, pf);
+            if (rd < chunk_sz && ferror(pf)) {
+                throw std::runtime_error("[FileReader] Read error");
+            }
+            return rd;
+        });
+    }
+
+    // END at EOF; only a disk I/O error throws
+    ReadResult try_read_into(uint8_t* buff_ptr) override {
+        return counters.timed_try_read(*this, [&]() {
+            size_t rd = fread(buff_ptr, 1, chunk_sz, pf);
+            if (rd < chunk_sz && ferror(pf)) {
+                throw std::runtime_error("[FileReader] Read error");
+            }
+            return ReadResult{rd ? ReadStatus::OK : ReadStatus::END, rd};
+        });
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override {
+        if (!ReaderCounters::enabled) {
+            return false;
         }
-        return rd;
+        counters.snapshot(st);
+        return true;
     }
 
     size_t get_chunk_size() const noexcept override { return chunk_sz; }
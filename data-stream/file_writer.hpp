@@ -0,0 +1,439 @@
+// file_writer.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include "async_file_reader.hpp"  // IoUring, DIRECT_IO_ALIGN
+#include "chunk_pool.hpp"
+#include <string>
+#include <cstring>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+
+struct FileWriterOpts {
+    size_t buffer_size = 4u << 20;  // bytes per write, rounded up to DIRECT_IO_ALIGN
+    size_t depth = 4;               // buffers: one filling, the rest in flight
+    bool direct = true;             // O_DIRECT / FILE_FLAG_NO_BUFFERING (buffered if the fs refuses)
+    uint64_t preallocate = 0;       // bytes reserved per file up front, 0 = grow as written
+    uint64_t rotate_bytes = 0;      // start the next file once this size would be exceeded, 0 = never
+    double rotate_sec = 0.0;        // ... or after this many seconds, 0 = never
+};
+
+// Stream-to-disk writer: appends into DIRECT_IO_ALIGN-aligned buffers and
+// writes each full buffer asynchronously (io_uring on Linux, overlapped
+// WriteFile on Windows) while the next one fills. The last partial buffer
+// is written padded and the file trimmed to the exact byte count on close,
+// so the output plays back through FileReader / MmapFileReader as is.
+// With rotation, files are named <stem>_0000<ext>, <stem>_0001<ext>, ...;
+// one write() call never spans two files.
+class FileWriter {
+private:
+    struct Slot {
+        ChunkPool::Chunk chunk;
+        uint8_t* buf = nullptr;
+        size_t used = 0;        // bytes filled
+        size_t len = 0;         // bytes submitted (used, padded for direct I/O)
+        size_t done = 0;        // bytes completed
+        uint64_t file_off = 0;
+        bool busy = false;      // in flight
+#ifdef _WIN32
+        OVERLAPPED ov = {};
+#endif
+    };
+
+    STD_PATH base_path;
+    FileWriterOpts opts;
+    size_t buf_sz;
+    std::unique_ptr<ChunkPool> pool;
+    std::vector<Slot> slots;
+    size_t cur = 0;             // slot being filled
+
+    STD_PATH file_path;
+    uint32_t file_index = 0;
+    uint64_t file_bytes = 0;    // bytes accepted into the current file
+    uint64_t total_bytes = 0;
+    uint64_t submit_off = 0;    // file offset of the current slot
+    bool is_open = false;
+    bool direct = false;
+    int last_error = 0;
+    std::chrono::steady_clock::time_point file_t0;
+
+#ifdef _WIN32
+    HANDLE h = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+    IoUring* ring = nullptr;    // nullptr: synchronous pwrite fallback
+#endif
+
+    void release() noexcept {
+#ifdef _WIN32
+        if (h != INVALID_HANDLE_VALUE) {
+            CloseHandle(h);
+            h = INVALID_HANDLE_VALUE;
+        }
+        for (Slot& s : slots) {
+            if (s.ov.hEvent) {
+                CloseHandle(s.ov.hEvent);
+                s.ov.hEvent = nullptr;
+            }
+        }
+#else
+        if (fd != -1) {
+            ::close(fd);
+            fd = -1;
+        }
+        delete ring;
+        ring = nullptr;
+#endif
+        for (Slot& s : slots) {
+            s.chunk.release();
+            s.buf = nullptr;
+        }
+    }
+
+    STD_PATH name_for(uint32_t idx) const {
+        if (opts.rotate_bytes == 0 && opts.rotate_sec <= 0.0) {
+            return base_path;
+        }
+        char num[16];
+        std::snprintf(num, sizeof(num), "_%04u", idx);
+        STD_PATH p = base_path;
+        p.replace_filename(base_path.stem().string() + num + base_path.extension().string());
+        return p;
+    }
+
+    void open_file() {
+        file_path = name_for(file_index);
+        file_bytes = 0;
+        submit_off = 0;
+        file_t0 = std::chrono::steady_clock::now();
+#ifdef _WIN32
+        std::wstring wp = file_path.wstring();
+        DWORD flags = FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN;
+        h = CreateFileW(wp.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                        flags | (opts.direct ? FILE_FLAG_NO_BUFFERING : 0), nullptr);
+        direct = opts.direct && h != INVALID_HANDLE_VALUE;
+        if (h == INVALID_HANDLE_VALUE && opts.direct) {
+            h = CreateFileW(wp.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, flags, nullptr);
+        }
+        if (h == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("[FileWriter] Failed to create file: " + file_path.string());
+        }
+        if (opts.preallocate) {
+            FILE_ALLOCATION_INFO ai;
+            ai.AllocationSize.QuadPart = static_cast<LONGLONG>(opts.preallocate);
+            SetFileInformationByHandle(h, FileAllocationInfo, &ai, sizeof(ai));
+        }
+#else
+        const std::string p = file_path.string();
+        fd = opts.direct ? ::open(p.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644) : -1;
+        direct = fd != -1;
+        if (fd == -1) {
+            fd = ::open(p.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);  // fs without O_DIRECT (tmpfs)
+        }
+        if (fd == -1) {
+            throw std::runtime_error("[FileWriter] Failed to create file: " + p + ": " + strerror(errno));
+        }
+        if (opts.preallocate && fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(opts.preallocate)) != 0 &&
+            file_index == 0) {
+            std::cerr << "Warning: fallocate not supported for " << p << ". Writing without preallocation.\n";
+        }
+#endif
+        is_open = true;
+    }
+
+#ifndef _WIN32
+    void complete(Slot& s, size_t idx, int32_t res) {
+        if (res < 0) {
+            if (res == -EINTR || res == -EAGAIN) {
+                issue(s, idx);
+                return;
+            }
+            last_error = -res;
+            s.busy = false;
+            return;
+        }
+        if (res == 0) {
+            last_error = ENOSPC;
+            s.busy = false;
+            return;
+        }
+        s.done += static_cast<size_t>(res);
+        if (s.done >= s.len) {
+            s.busy = false;
+        } else {
+            issue(s, idx);  // short write (disk nearly full): push the rest
+        }
+    }
+#endif
+
+    // Start (or continue after a short write) the transfer of s
+    void issue(Slot& s, size_t idx) {
+        const uint64_t off = s.file_off + s.done;
+        const size_t n = s.len - s.done;
+#ifdef _WIN32
+        HANDLE ev = s.ov.hEvent;
+        std::memset(&s.ov, 0, sizeof(s.ov));
+        s.ov.hEvent = ev;
+        s.ov.Offset = static_cast<DWORD>(off & 0xFFFFFFFFull);
+        s.ov.OffsetHigh = static_cast<DWORD>(off >> 32);
+        if (!WriteFile(h, s.buf + s.done, static_cast<DWORD>(n), nullptr, &s.ov) &&
+            GetLastError() != ERROR_IO_PENDING) {
+            last_error = static_cast<int>(GetLastError());
+            s.busy = false;
+        }
+        (void)idx;
+#else
+        if (ring) {
+            if (!ring->queue_write(fd, s.buf + s.done, static_cast<unsigned>(n), off, idx)) {
+                ring->submit();
+                ring->queue_write(fd, s.buf + s.done, static_cast<unsigned>(n), off, idx);
+            }
+            ring->submit();
+        } else {
+            ssize_t rc = pwrite(fd, s.buf + s.done, n, static_cast<off_t>(off));
+            complete(s, idx, rc < 0 ? -errno : static_cast<int32_t>(rc));
+        }
+#endif
+    }
+
+    void wait(Slot& s) {
+#ifdef _WIN32
+        if (!s.busy) {
+            return;
+        }
+        DWORD n = 0;
+        if (!GetOverlappedResult(h, &s.ov, &n, TRUE)) {
+            last_error = static_cast<int>(GetLastError());
+        } else if (n != s.len) {
+            last_error = ERROR_DISK_FULL;
+        }
+        s.busy = false;
+#else
+        while (s.busy && ring) {
+            uint64_t ud;
+            int32_t res;
+            bool any = false;
+            while (ring->pop_completion(ud, res)) {
+                any = true;
+                complete(slots[ud], static_cast<size_t>(ud), res);
+            }
+            if (!any && s.busy) {
+                ring->submit(1);
+            }
+        }
+#endif
+    }
+
+    void check_error() const {
+        if (last_error) {
+#ifdef _WIN32
+            throw std::runtime_error("[FileWriter] Write failed on " + file_path.string() +
+                                     " (error " + std::to_string(last_error) + ")");
+#else
+            throw std::runtime_error("[FileWriter] Write failed on " + file_path.string() + ": " + strerror(last_error));
+#endif
+        }
+    }
+
+    // Hand the current slot to the kernel and move to the next free one
+    void submit_current() {
+        Slot& s = slots[cur];
+        if (s.used == 0) {
+            return;
+        }
+        s.len = direct ? (s.used + DIRECT_IO_ALIGN - 1) & ~(DIRECT_IO_ALIGN - 1) : s.used;
+        if (s.len != s.used) {
+            std::memset(s.buf + s.used, 0, s.len - s.used);  // tail padding, trimmed on close
+        }
+        s.done = 0;
+        s.file_off = submit_off;
+        s.busy = true;
+        submit_off += s.used;
+        issue(s, cur);
+        cur = (cur + 1) % slots.size();
+        wait(slots[cur]);  // only blocks when every buffer is in flight
+        slots[cur].used = 0;
+        check_error();
+    }
+
+    void drain() {
+        for (Slot& s : slots) {
+            wait(s);
+        }
+    }
+
+    // Flush, trim the direct-I/O padding and close the current file
+    void close_file() {
+        if (!is_open) {
+            return;
+        }
+        submit_current();
+        drain();
+        is_open = false;
+#ifdef _WIN32
+        FILE_END_OF_FILE_INFO eof;
+        eof.EndOfFile.QuadPart = static_cast<LONGLONG>(file_bytes);
+        SetFileInformationByHandle(h, FileEndOfFileInfo, &eof, sizeof(eof));
+        CloseHandle(h);
+        h = INVALID_HANDLE_VALUE;
+#else
+        if (ftruncate(fd, static_cast<off_t>(file_bytes)) != 0 && !last_error) {
+            last_error = errno;
+        }
+        ::close(fd);
+        fd = -1;
+#endif
+        check_error();
+    }
+
+    bool rotate_due(size_t len) const noexcept {
+        if (file_bytes == 0) {
+            return false;
+        }
+        if (opts.rotate_bytes && file_bytes + len > opts.rotate_bytes) {
+            return true;
+        }
+        return opts.rotate_sec > 0.0 &&
+               std::chrono::duration<double>(std::chrono::steady_clock::now() - file_t0).count() >= opts.rotate_sec;
+    }
+
+public:
+    FileWriter(const std::string& path, const FileWriterOpts& writer_opts = FileWriterOpts())
+        : base_path(path), opts(writer_opts)
+    {
+        buf_sz = (std::max<size_t>(opts.buffer_size, 1) + DIRECT_IO_ALIGN - 1) & ~(DIRECT_IO_ALIGN - 1);
+        const size_t depth = std::max<size_t>(opts.depth, 2);
+        ChunkPoolOpts pool_opts;
+        pool_opts.align = DIRECT_IO_ALIGN;
+        pool.reset(new ChunkPool(buf_sz, depth, pool_opts));
+        slots.resize(depth);
+        for (Slot& s : slots) {
+            s.chunk = pool->try_acquire();
+            s.buf = s.chunk.data();
+#ifdef _WIN32
+            s.ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+#endif
+        }
+#ifndef _WIN32
+        try {
+            ring = new IoUring(static_cast<unsigned>(depth));
+        } catch (const std::runtime_error&) {
+            ring = nullptr;  // no io_uring: synchronous writes
+        }
+#endif
+        try {
+            open_file();
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~FileWriter() {
+        try {
+            close();
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << "\n";
+        }
+        release();
+    }
+
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    // Append len bytes (copied; the caller's buffer is free on return).
+    // Blocks only when the disk falls `depth` buffers behind; throws on write errors.
+    void write(const uint8_t* data, size_t len) {
+        if (!is_open) {
+            throw std::runtime_error("[FileWriter] Writer is closed");
+        }
+        if (rotate_due(len)) {
+            close_file();
+            ++file_index;
+            open_file();
+        }
+        file_bytes += len;
+        total_bytes += len;
+        while (len > 0) {
+            Slot& s = slots[cur];
+            size_t n = std::min(len, buf_sz - s.used);
+            std::memcpy(s.buf + s.used, data, n);
+            s.used += n;
+            data += n;
+            len -= n;
+            if (s.used == buf_sz) {
+                submit_current();
+            }
+        }
+    }
+
+    // Flush everything and close the current file (no further writes)
+    void close() {
+        close_file();
+    }
+
+    uint64_t get_bytes_written() const noexcept { return total_bytes; }
+    uint64_t get_file_bytes() const noexcept { return file_bytes; }
+    uint32_t get_file_index() const noexcept { return file_index; }
+    STD_PATH get_file_path() const noexcept { return file_path; }
+    bool is_direct() const noexcept { return direct; }
+
+};
+
+// Decorator: passes the wrapped reader's chunks through unchanged and
+// records every chunk to disk (FileWriter) on the way. Wrap it around a
+// ThreadedStreamReader to keep disk latency away from the capture thread.
+// Only the payload bytes are recorded, not the datagram table.
+class RecordingReader : public I_STREAM_READER {
+private:
+    I_STREAM_READER* inner_;
+    bool own_inner_;
+    FileWriter writer_;
+
+public:
+    RecordingReader(I_STREAM_READER* inner,
+                    const std::string& path,
+                    const FileWriterOpts& opts = FileWriterOpts(),
+                    bool own_inner = false)
+        : inner_(inner), own_inner_(own_inner), writer_(path, opts)
+    {
+        if (!inner_) {
+            throw std::runtime_error("[RecordingReader] Inner reader is null");
+        }
+    }
+
+    ~RecordingReader() override {
+        if (own_inner_) {
+            delete inner_;
+        }
+    }
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    size_t read_into(uint8_t* buff_ptr) override {
+        size_t rd = inner_->read_into(buff_ptr);
+        if (rd) {
+            writer_.write(buff_ptr, rd);
+        }
+        return rd;
+    }
+
+    size_t get_chunk_size() const noexcept override { return inner_->get_chunk_size(); }
+    std::string get_type() const noexcept override { return "record(" + inner_->get_type() + ")"; }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        return inner_->get_segments(segs);
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        return inner_->get_packet_meta(meta);
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override { return inner_->get_stats(st); }
+
+    FileWriter& get_writer() noexcept { return writer_; }
+};
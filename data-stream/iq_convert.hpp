@@ -0,0 +1,383 @@
+// iq_convert.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include <complex>
+#include <vector>
+#include <cstring>
+#include <string>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define DATASTREAM_IQ_X86 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define DATASTREAM_IQ_TARGET(t)
+    #else
+        #define DATASTREAM_IQ_TARGET(t) __attribute__((target(t)))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || (defined(__ARM_NEON) && defined(__arm__))
+    #define DATASTREAM_IQ_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// Stream samples are interleaved int16 LE: i0 q0 i1 q1 ... (little-endian host assumed)
+constexpr float INT16_FULL_SCALE = 32768.0f;
+
+using cf32 = std::complex<float>;
+
+enum class IqKernel {
+    AUTO,    // best supported by this CPU
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512,
+    NEON,
+};
+
+inline const char* iq_kernel_name(IqKernel k) noexcept {
+    switch (k) {
+        case IqKernel::AUTO:   return "auto";
+        case IqKernel::SCALAR: return "scalar";
+        case IqKernel::SSE2:   return "sse2";
+        case IqKernel::AVX2:   return "avx2";
+        case IqKernel::AVX512: return "avx512";
+        case IqKernel::NEON:   return "neon";
+    }
+    return "?";
+}
+
+// Kernels: n int16 values at src (any alignment) -> n floats at dst, times scale
+namespace iq_detail {
+
+inline void i16_to_f32_scalar(const uint8_t* src, float* dst, size_t n, float scale) noexcept {
+    for (size_t k = 0; k < n; ++k) {
+        int16_t v;
+        std::memcpy(&v, src + 2 * k, sizeof(v));
+        dst[k] = static_cast<float>(v) * scale;
+    }
+}
+
+#ifdef DATASTREAM_IQ_X86
+DATASTREAM_IQ_TARGET("sse2")
+inline void i16_to_f32_sse2(const uint8_t* src, float* dst, size_t n, float scale) noexcept {
+    const __m128 s = _mm_set1_ps(scale);
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * k));
+        // Sign-extend via unpack into the high half + arithmetic shift
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(dst + k, _mm_mul_ps(_mm_cvtepi32_ps(lo), s));
+        _mm_storeu_ps(dst + k + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), s));
+    }
+    i16_to_f32_scalar(src + 2 * k, dst + k, n - k, scale);
+}
+
+DATASTREAM_IQ_TARGET("avx2")
+inline void i16_to_f32_avx2(const uint8_t* src, float* dst, size_t n, float scale) noexcept {
+    const __m256 s = _mm256_set1_ps(scale);
+    size_t k = 0;
+    for (; k + 16 <= n; k += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * k));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * k + 16));
+        _mm256_storeu_ps(dst + k, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), s));
+        _mm256_storeu_ps(dst + k + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), s));
+    }
+    i16_to_f32_sse2(src + 2 * k, dst + k, n - k, scale);
+}
+
+DATASTREAM_IQ_TARGET("avx512f")
+inline void i16_to_f32_avx512(const uint8_t* src, float* dst, size_t n, float scale) noexcept {
+    const __m512 s = _mm512_set1_ps(scale);
+    size_t k = 0;
+    for (; k + 32 <= n; k += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * k));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * k + 32));
+        _mm512_storeu_ps(dst + k, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(a)), s));
+        _mm512_storeu_ps(dst + k + 16, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(b)), s));
+    }
+    i16_to_f32_avx2(src + 2 * k, dst + k, n - k, scale);
+}
+#endif
+
+#ifdef DATASTREAM_IQ_NEON
+inline void i16_to_f32_neon(const uint8_t* src, float* dst, size_t n, float scale) noexcept {
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        int16x8_t x = vreinterpretq_s16_u8(vld1q_u8(src + 2 * k));
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(x)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(x)));
+        vst1q_f32(dst + k, vmulq_n_f32(lo, scale));
+        vst1q_f32(dst + k + 4, vmulq_n_f32(hi, scale));
+    }
+    i16_to_f32_scalar(src + 2 * k, dst + k, n - k, scale);
+}
+#endif
+
+#ifdef DATASTREAM_IQ_X86
+// CPU + OS support (XSAVE-enabled register state) for a kernel
+inline bool x86_supports(IqKernel k) noexcept {
+    #ifdef _MSC_VER
+    int r[4];
+    __cpuid(r, 0);
+    int max_leaf = r[0];
+    __cpuid(r, 1);
+    bool sse2 = (r[3] >> 26) & 1;
+    bool osxsave = (r[2] >> 27) & 1;
+    bool avx = (r[2] >> 28) & 1;
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool ymm = (xcr0 & 0x6) == 0x6;
+    bool zmm = (xcr0 & 0xE6) == 0xE6;
+    bool avx2 = false, avx512f = false;
+    if (max_leaf >= 7) {
+        __cpuidex(r, 7, 0);
+        avx2 = (r[1] >> 5) & 1;
+        avx512f = (r[1] >> 16) & 1;
+    }
+    switch (k) {
+        case IqKernel::SSE2:   return sse2;
+        case IqKernel::AVX2:   return avx && ymm && avx2;
+        case IqKernel::AVX512: return ymm && zmm && avx512f;
+        default:               return k == IqKernel::SCALAR;
+    }
+    #else
+    __builtin_cpu_init();
+    switch (k) {
+        case IqKernel::SSE2:   return __builtin_cpu_supports("sse2");
+        case IqKernel::AVX2:   return __builtin_cpu_supports("avx2");
+        case IqKernel::AVX512: return __builtin_cpu_supports("avx512f");
+        default:               return k == IqKernel::SCALAR;
+    }
+    #endif
+}
+#endif
+
+} // namespace iq_detail
+
+// Whether the kernel can run on this machine
+inline bool iq_kernel_supported(IqKernel k) noexcept {
+    switch (k) {
+        case IqKernel::AUTO:
+        case IqKernel::SCALAR:
+            return true;
+#ifdef DATASTREAM_IQ_X86
+        case IqKernel::SSE2:
+        case IqKernel::AVX2:
+        case IqKernel::AVX512:
+            return iq_detail::x86_supports(k);
+#endif
+#ifdef DATASTREAM_IQ_NEON
+        case IqKernel::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+inline IqKernel best_iq_kernel() noexcept {
+    static const IqKernel best = [] {
+        for (IqKernel k : {IqKernel::AVX512, IqKernel::AVX2, IqKernel::SSE2, IqKernel::NEON}) {
+            if (iq_kernel_supported(k)) {
+                return k;
+            }
+        }
+        return IqKernel::SCALAR;
+    }();
+    return best;
+}
+
+// int16 -> float32 converter bound to one kernel (resolved once, no per-call dispatch)
+class IqConverter {
+public:
+    using Fn = void (*)(const uint8_t*, float*, size_t, float) noexcept;
+
+private:
+    IqKernel kernel_;
+    Fn fn_;
+    float scale_;
+
+public:
+    // scale: multiplier per value, e.g. 1 / INT16_FULL_SCALE for [-1, 1) normalization
+    explicit IqConverter(float scale = 1.0f / INT16_FULL_SCALE, IqKernel kernel = IqKernel::AUTO)
+        : kernel_(kernel == IqKernel::AUTO ? best_iq_kernel() : kernel)
+        , fn_(iq_detail::i16_to_f32_scalar)
+        , scale_(scale)
+    {
+        if (!iq_kernel_supported(kernel_)) {
+            throw std::runtime_error(std::string("[IqConverter] Kernel not supported on this CPU: ") +
+                                     iq_kernel_name(kernel_));
+        }
+        switch (kernel_) {
+#ifdef DATASTREAM_IQ_X86
+            case IqKernel::SSE2:   fn_ = iq_detail::i16_to_f32_sse2; break;
+            case IqKernel::AVX2:   fn_ = iq_detail::i16_to_f32_avx2; break;
+            case IqKernel::AVX512: fn_ = iq_detail::i16_to_f32_avx512; break;
+#endif
+#ifdef DATASTREAM_IQ_NEON
+            case IqKernel::NEON:   fn_ = iq_detail::i16_to_f32_neon; break;
+#endif
+            default: break;
+        }
+    }
+
+    // Raw interleaved IQ bytes -> complex samples; a trailing partial sample is ignored.
+    // Returns: samples written (bytes / 4)
+    size_t convert(const uint8_t* src, size_t bytes, cf32* dst) const noexcept {
+        size_t samples = bytes / 4;
+        fn_(src, reinterpret_cast<float*>(dst), samples * 2, scale_);
+        return samples;
+    }
+
+    size_t convert(ByteView v, cf32* dst) const noexcept { return convert(v.data, v.size, dst); }
+
+    // Whole chunk in one pass: every datagram (segment) minus its hdr_sz-byte header.
+    // segs == nullptr / seg_count == 0: chunk is one headerless run.
+    // Returns: samples written
+    size_t convert_chunk(const uint8_t* chunk, size_t size, const ChunkSegment* segs, size_t seg_count,
+                         size_t hdr_sz, cf32* dst) const noexcept {
+        if (!segs || seg_count == 0) {
+            return convert(chunk, size, dst);
+        }
+        size_t out = 0;
+        for (size_t k = 0; k < seg_count; ++k) {
+            if (segs[k].length <= hdr_sz) {
+                continue;
+            }
+            out += convert(chunk + segs[k].offset + hdr_sz, segs[k].length - hdr_sz, dst + out);
+        }
+        return out;
+    }
+
+    IqKernel get_kernel() const noexcept { return kernel_; }
+    float get_scale() const noexcept { return scale_; }
+};
+
+struct IqStageOpts {
+    size_t hdr_sz = 8;         // per-datagram header to skip (gen_tst_udp_test_stream.py: 8-byte seq)
+    bool normalize = true;     // scale by 1 / INT16_FULL_SCALE, else raw integer values
+    IqKernel kernel = IqKernel::AUTO;
+};
+
+// Pipeline stage: pulls raw int16 IQ chunks from the wrapped reader and
+// hands out complex float samples, header-stripped and scaled in one pass.
+// As an I_STREAM_READER its output bytes are cf32 values (chunk size =
+// 2x inner); read_iq() fills an own 64-byte aligned sample buffer.
+// Segments / metadata are remapped to the float output. Readers without
+// a datagram table (files) are taken as headerless sample runs.
+// Inner: ReaderRef (IqConvertReader) or ReaderValue<R> (static pipelines).
+template<class Inner>
+class BasicIqConvertReader : public I_STREAM_READER {
+private:
+    Inner inner_;
+    IqStageOpts opts_;
+    IqConverter conv_;
+    size_t in_chunk_;
+    std::vector<uint8_t> raw_;
+    size_t raw_size_ = 0;            // bytes of the last inner read
+    std::vector<cf32> samples_;      // over-allocated by one cache line for alignment
+    cf32* aligned_ = nullptr;
+    std::vector<ChunkSegment> segments_;
+    std::vector<PacketMeta> meta_;
+
+    // Convert the next inner chunk to dst, rebuilding the segment table in float bytes
+    size_t pull(cf32* dst) {
+        raw_size_ = 0;
+        size_t rd = inner_.read_into(raw_.data());
+        raw_size_ = rd;
+        const ChunkSegment* segs;
+        size_t seg_count = inner_.get_segments(segs);
+        const PacketMeta* meta;
+        size_t meta_count = inner_.get_packet_meta(meta);
+
+        segments_.clear();
+        meta_.clear();
+        if (seg_count == 0) {
+            return conv_.convert(raw_.data(), rd, dst);
+        }
+        size_t out = 0;
+        for (size_t k = 0; k < seg_count; ++k) {
+            size_t n = 0;
+            if (segs[k].length > opts_.hdr_sz) {
+                n = conv_.convert(raw_.data() + segs[k].offset + opts_.hdr_sz,
+                                  segs[k].length - opts_.hdr_sz, dst + out);
+            }
+            segments_.push_back({out * sizeof(cf32), n * sizeof(cf32), segs[k].flags});
+            if (meta_count == seg_count) {
+                meta_.push_back(meta[k]);
+            }
+            out += n;
+        }
+        return out;
+    }
+
+public:
+    // Inner built in place from inner_args (ReaderRef: reader pointer [, own])
+    template<class... A>
+    explicit BasicIqConvertReader(const IqStageOpts& opts, A&&... inner_args)
+        : inner_(std::forward<A>(inner_args)...)
+        , opts_(opts)
+        , conv_(opts.normalize ? 1.0f / INT16_FULL_SCALE : 1.0f, opts.kernel)
+        , in_chunk_(inner_.get_chunk_size())
+        , raw_(in_chunk_)
+    {
+        samples_.resize(get_max_samples() + 64 / sizeof(cf32));
+        uintptr_t p = reinterpret_cast<uintptr_t>(samples_.data());
+        aligned_ = reinterpret_cast<cf32*>((p + 63) & ~uintptr_t(63));
+    }
+
+    template<class I = Inner, std::enable_if_t<std::is_same<I, ReaderRef>::value, int> = 0>
+    BasicIqConvertReader(I_STREAM_READER* inner,
+                         const IqStageOpts& opts = IqStageOpts(),
+                         bool own_inner = false)
+        : BasicIqConvertReader(opts, inner, own_inner)
+    {
+    }
+
+    BasicIqConvertReader(const BasicIqConvertReader&) = delete;
+    BasicIqConvertReader& operator=(const BasicIqConvertReader&) = delete;
+
+    // Caller's buffer receives cf32 values; returns bytes (samples * 8)
+    size_t read_into(uint8_t* buff_ptr) override {
+        return pull(reinterpret_cast<cf32*>(buff_ptr)) * sizeof(cf32);
+    }
+
+    // Next chunk as samples in the stage's aligned buffer, valid until the next call
+    size_t read_iq(const cf32*& samples) {
+        size_t n = pull(aligned_);
+        samples = aligned_;
+        return n;
+    }
+
+    // Next chunk as samples into caller's buffer (>= get_max_samples())
+    size_t read_iq(cf32* dst) { return pull(dst); }
+
+    size_t get_chunk_size() const noexcept override { return get_max_samples() * sizeof(cf32); }
+    size_t get_max_samples() const noexcept { return in_chunk_ / 4; }
+    // Inner bytes behind the last read (0 = inner end of stream, even if headers-only data gave no samples)
+    size_t get_last_raw_size() const noexcept { return raw_size_; }
+
+    std::string get_type() const noexcept override {
+        return std::string("iq_f32/") + iq_kernel_name(conv_.get_kernel()) + "(" + inner_.get_type() + ")";
+    }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = meta_.data();
+        return meta_.size();
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override { return inner_.get_stats(st); }
+
+    const IqConverter& get_converter() const noexcept { return conv_; }
+    auto get_inner() noexcept { return inner_.get(); }
+    auto get_inner() const noexcept { return inner_.get(); }
+};
+
+// Runtime stage over any I_STREAM_READER*
+using IqConvertReader = BasicIqConvertReader<ReaderRef>;
@@ -0,0 +1,235 @@
+// mmap_file_reader.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include "file_reader.hpp"  // STD_PATH
+#include <string>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file (RAII)
+class MappedFile {
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::filesystem::path& path) { open(path); }
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    void open(const std::filesystem::path& path) {
+        close();
+#ifdef _WIN32
+        file_ = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("[MappedFile] Failed to open file: " + path.string());
+        }
+        LARGE_INTEGER fsz;
+        if (!GetFileSizeEx(file_, &fsz)) {
+            close();
+            throw std::runtime_error("[MappedFile] Failed to get file size: " + path.string());
+        }
+        size_ = static_cast<size_t>(fsz.QuadPart);
+        if (size_ == 0) {
+            return;  // nothing to map
+        }
+        mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) {
+            close();
+            throw std::runtime_error("[MappedFile] CreateFileMapping failed: " + path.string());
+        }
+        data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (!data_) {
+            close();
+            throw std::runtime_error("[MappedFile] MapViewOfFile failed: " + path.string());
+        }
+#else
+        fd_ = ::open(path.string().c_str(), O_RDONLY);
+        if (fd_ == -1) {
+            throw std::runtime_error("[MappedFile] Failed to open file: " + path.string());
+        }
+        struct stat st;
+        if (fstat(fd_, &st) != 0) {
+            close();
+            throw std::runtime_error("[MappedFile] fstat failed: " + path.string());
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) {
+            return;  // nothing to map
+        }
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            close();
+            throw std::runtime_error("[MappedFile] mmap failed: " + path.string());
+        }
+        data_ = static_cast<const uint8_t*>(p);
+        madvise(p, size_, MADV_SEQUENTIAL);
+#endif
+    }
+
+    // Hint the kernel to start paging in [offset, offset + len)
+    void prefetch(size_t offset, size_t len) const noexcept {
+        if (!data_ || offset >= size_) {
+            return;
+        }
+        len = std::min(len, size_ - offset);
+#ifdef _WIN32
+    #if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<uint8_t*>(data_ + offset);
+        range.NumberOfBytes = len;
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    #endif
+#else
+        // madvise needs a page-aligned start
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t aligned = offset & ~(page - 1);
+        madvise(const_cast<uint8_t*>(data_ + aligned), len + (offset - aligned), MADV_WILLNEED);
+#endif
+    }
+
+    void close() noexcept {
+#ifdef _WIN32
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            CloseHandle(mapping_);
+            mapping_ = nullptr;
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+            file_ = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (data_) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+        }
+        if (fd_ != -1) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const uint8_t* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+};
+
+// Zero-copy file source: chunks are handed out as views into a read-only
+// mapping (next_view), read_into() is a single memcpy from page cache.
+class MmapFileReader : public I_STREAM_READER {
+private:
+    STD_PATH path;
+    size_t chunk_sz;
+    size_t offs;        // Initial offset
+    size_t readahead;   // WILLNEED window ahead of the cursor
+    MappedFile map;
+    size_t pos = 0;
+    size_t prefetched = 0;  // end of the last WILLNEED window
+    size_t chunk_count;
+    ReaderCounters counters;
+
+    // Keep the kernel read-ahead one window in front of the cursor
+    void advance_hint() noexcept {
+        if (pos + readahead / 2 >= prefetched) {
+            map.prefetch(pos, readahead);
+            prefetched = pos + readahead;
+        }
+    }
+
+public:
+    // readahead: 0 = two chunks
+    MmapFileReader(const std::string& file_path, size_t chunk_size, size_t offset = 0, size_t readahead_size = 0)
+        : path(file_path), chunk_sz(chunk_size), offs(offset),
+          readahead(readahead_size ? readahead_size : 2 * chunk_size), map(path)
+    {
+        chunk_count = (map.size() + chunk_sz - 1) / chunk_sz;
+        jump_to(offs);
+    }
+
+    ~MmapFileReader() override { close(); }
+
+    size_t read_into(uint8_t* buff_ptr) override {
+        return counters.timed_read(*this, [&]() {
+            ByteView v = next_view();
+            if (v.size) {
+                std::memcpy(buff_ptr, v.data, v.size);
+            }
+            return v.size;
+        });
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override {
+        if (!ReaderCounters::enabled) {
+            return false;
+        }
+        counters.snapshot(st);
+        return true;
+    }
+
+    // Next chunk in place; size 0 at EOF. Valid until close().
+    ByteView next_view() noexcept {
+        size_t n = std::min(chunk_sz, map.size() - pos);
+        ByteView v{map.data() + pos, n};
+        pos += n;
+        advance_hint();
+        return v;
+    }
+
+    // Arbitrary range in place, clamped to file size
+    ByteView view_at(size_t offset, size_t len) const noexcept {
+        if (offset >= map.size()) {
+            return ByteView{nullptr, 0};
+        }
+        return ByteView{map.data() + offset, std::min(len, map.size() - offset)};
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_sz; }
+    std::string get_type() const noexcept override { return "mmap file reader: " + path.string(); }
+
+    // O(1): moves the cursor and re-arms read-ahead at the new position
+    void jump_to(size_t offset) {
+        if (offset > map.size()) {
+            throw std::runtime_error("[MmapFileReader] Failed to seek to offset");
+        }
+        pos = offset;
+        prefetched = 0;
+        advance_hint();
+    }
+
+    size_t get_size() const noexcept { return map.size(); }
+    size_t get_chunk_count() const noexcept { return chunk_count; }
+    size_t get_position() const noexcept { return pos; }
+    STD_PATH get_file_path() const noexcept { return path; }
+
+    void close() { map.close(); pos = 0; }
+};
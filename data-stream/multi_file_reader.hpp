@@ -0,0 +1,373 @@
+// multi_file_reader.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include "reader_stats.hpp"
+#include "file_reader.hpp"  // fseek64, STD_PATH, _default_buf_sz
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <future>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+namespace multi_file_detail {
+
+// Natural order: "rec_2.bin" < "rec_10.bin", so unpadded rotation indices sort right
+inline bool natural_less(const std::string& a, const std::string& b) {
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (std::isdigit(static_cast<unsigned char>(a[i])) && std::isdigit(static_cast<unsigned char>(b[j]))) {
+            size_t ie = i, je = j;
+            while (ie < a.size() && std::isdigit(static_cast<unsigned char>(a[ie]))) ++ie;
+            while (je < b.size() && std::isdigit(static_cast<unsigned char>(b[je]))) ++je;
+            size_t is = i, js = j;
+            while (is + 1 < ie && a[is] == '0') ++is;  // skip leading zeros
+            while (js + 1 < je && b[js] == '0') ++js;
+            if (ie - is != je - js) {
+                return ie - is < je - js;
+            }
+            int c = a.compare(is, ie - is, b, js, je - js);
+            if (c != 0) {
+                return c < 0;
+            }
+            i = ie;
+            j = je;
+        } else {
+            if (a[i] != b[j]) {
+                return a[i] < b[j];
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return a.size() - i < b.size() - j;
+}
+
+// Shell-style match of a file name: '*' any run, '?' any one character
+inline bool wildcard_match(const char* pat, const char* s) {
+    const char* star = nullptr;
+    const char* resume = nullptr;
+    while (*s) {
+        if (*pat == '?' || *pat == *s) {
+            ++pat;
+            ++s;
+        } else if (*pat == '*') {
+            star = pat++;
+            resume = s;
+        } else if (star) {
+            pat = star + 1;
+            s = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (*pat == '*') {
+        ++pat;
+    }
+    return *pat == '\0';
+}
+
+inline void sort_paths(std::vector<STD_PATH>& v) {
+    std::sort(v.begin(), v.end(), [](const STD_PATH& a, const STD_PATH& b) {
+        return natural_less(a.filename().string(), b.filename().string());
+    });
+}
+
+} // namespace multi_file_detail
+
+// Expands a file set spec into an ordered path list:
+//   /data/rec/            every regular file in the directory, natural order
+//   /data/rec/run1_*.bin  wildcard in the file name part (* and ?), natural order
+//   @/data/rec/list.txt   manifest: one path per line, '#' comments, relative to the manifest
+//   /data/rec/x.bin       a single file
+inline std::vector<STD_PATH> expand_file_set(const std::string& spec) {
+    std::vector<STD_PATH> out;
+    if (!spec.empty() && spec[0] == '@') {
+        STD_PATH manifest(spec.substr(1));
+        std::ifstream in(manifest);
+        if (!in) {
+            throw std::runtime_error("[MultiFileReader] Failed to open manifest: " + manifest.string());
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t b = line.find_first_not_of(" \t\r");
+            if (b == std::string::npos || line[b] == '#') {
+                continue;
+            }
+            size_t e = line.find_last_not_of(" \t\r");
+            STD_PATH p(line.substr(b, e - b + 1));
+            out.push_back(p.is_relative() ? manifest.parent_path() / p : p);
+        }
+        return out;
+    }
+
+    STD_PATH p(spec);
+    std::string name = p.filename().string();
+    if (name.find_first_of("*?") != std::string::npos) {
+        STD_PATH dir = p.has_parent_path() ? p.parent_path() : STD_PATH(".");
+        for (const auto& e : fs::directory_iterator(dir)) {
+            if (e.is_regular_file() && multi_file_detail::wildcard_match(name.c_str(), e.path().filename().string().c_str())) {
+                out.push_back(e.path());
+            }
+        }
+        multi_file_detail::sort_paths(out);
+    } else if (fs::is_directory(p)) {
+        for (const auto& e : fs::directory_iterator(p)) {
+            if (e.is_regular_file()) {
+                out.push_back(e.path());
+            }
+        }
+        multi_file_detail::sort_paths(out);
+    } else {
+        out.push_back(p);
+    }
+    return out;
+}
+
+// Ordered set of files (e.g. FileWriter rotation segments) read as one
+// continuous stream: chunks are stitched across file boundaries, offsets
+// and jump_to() are global. Next segment is opened and its first chunk
+// read on a helper thread while the current one is being consumed, so a
+// boundary costs no open / seek on the reading thread.
+// Sizes are indexed at construction; files growing afterwards are read
+// up to the indexed size only. Empty files are skipped.
+class MultiFileReader : public I_STREAM_READER {
+private:
+    struct Segment {
+        FILE* pf = nullptr;
+        char* vbuf = nullptr;
+        std::vector<uint8_t> head;      // first bytes, read ahead by prefetch
+    };
+
+    std::vector<STD_PATH> paths;
+    std::vector<size_t> sizes;
+    std::vector<size_t> starts;         // global offset of each segment
+    size_t chunk_sz;
+    size_t total_sz = 0;
+    size_t file_buffer_sz;
+
+    Segment cur;
+    size_t cur_idx = 0;                 // == paths.size() at end of stream
+    size_t seg_pos = 0;                 // bytes of cur consumed
+
+    std::future<Segment> next;
+    size_t next_idx = SIZE_MAX;
+    ReaderCounters counters;
+
+    static Segment open_segment(const STD_PATH& path, size_t buf_sz, size_t head_bytes) {
+        Segment s;
+        s.pf = fopen(path.string().c_str(), "rb");
+        if (!s.pf) {
+            throw std::runtime_error("[MultiFileReader] Failed to open file: " + path.string());
+        }
+        if (buf_sz > 8*1024) {
+            s.vbuf = (char*)std::malloc(buf_sz);
+            if (!s.vbuf || setvbuf(s.pf, s.vbuf, _IOFBF, buf_sz) != 0) {
+                close_segment(s);
+                throw std::runtime_error("[MultiFileReader] Failed to set stdio buffer");
+            }
+        }
+        if (head_bytes) {
+            s.head.resize(head_bytes);
+            size_t rd = fread(s.head.data(), 1, head_bytes, s.pf);
+            if (rd < head_bytes) {
+                close_segment(s);
+                throw std::runtime_error("[MultiFileReader] Unexpected end of file: " + path.string());
+            }
+        }
+        return s;
+    }
+
+    static void close_segment(Segment& s) noexcept {
+        if (s.pf) {
+            fclose(s.pf);
+            s.pf = nullptr;
+        }
+        if (s.vbuf) {
+            std::free(s.vbuf);
+            s.vbuf = nullptr;
+        }
+        s.head.clear();
+    }
+
+    void start_prefetch(size_t idx) {
+        if (idx >= paths.size()) {
+            return;
+        }
+        next_idx = idx;
+        next = std::async(std::launch::async, open_segment, paths[idx], file_buffer_sz,
+                          std::min(chunk_sz, sizes[idx]));
+    }
+
+    void discard_prefetch() noexcept {
+        if (next.valid()) {
+            try {
+                Segment s = next.get();
+                close_segment(s);
+            } catch (...) {
+                // opened again on demand, the error resurfaces there
+            }
+        }
+        next_idx = SIZE_MAX;
+    }
+
+    // Positions cur at `local`. pf stays right after the head while
+    // seg_pos <= head size, so a target inside the head needs no seek.
+    void seek_local(size_t local) {
+        if (local < cur.head.size() && seg_pos <= cur.head.size()) {
+            seg_pos = local;
+            return;
+        }
+        if (local != cur.head.size() || seg_pos > cur.head.size()) {
+            if (fseek64(cur.pf, local, SEEK_SET) != 0) {
+                throw std::runtime_error("[MultiFileReader] Failed to seek in " + paths[cur_idx].string());
+            }
+        }
+        cur.head.clear();
+        seg_pos = local;
+    }
+
+    // Makes idx current, positioned at local offset `local`
+    void enter(size_t idx, size_t local) {
+        close_segment(cur);
+        cur_idx = idx;
+        seg_pos = 0;
+        if (idx >= paths.size()) {
+            discard_prefetch();
+            return;
+        }
+        if (idx == next_idx && next.valid()) {
+            next_idx = SIZE_MAX;
+            cur = next.get();
+        } else {
+            discard_prefetch();
+            cur = open_segment(paths[idx], file_buffer_sz, 0);
+        }
+        seek_local(local);
+        start_prefetch(idx + 1);
+    }
+
+public:
+    MultiFileReader(const std::vector<STD_PATH>& files, size_t chunk_size, size_t offset = 0,
+                    size_t file_buffer_size = _default_buf_sz)
+        : chunk_sz(chunk_size), file_buffer_sz(file_buffer_size)
+    {
+        if (chunk_sz == 0) {
+            throw std::runtime_error("[MultiFileReader] Chunk size must be > 0");
+        }
+        for (const STD_PATH& f : files) {
+            std::error_code ec;
+            size_t sz = fs::file_size(f, ec);
+            if (ec) {
+                throw std::runtime_error("[MultiFileReader] Failed to stat file: " + f.string());
+            }
+            if (sz == 0) {
+                continue;
+            }
+            paths.push_back(f);
+            sizes.push_back(sz);
+            starts.push_back(total_sz);
+            total_sz += sz;
+        }
+        if (paths.empty()) {
+            throw std::runtime_error("[MultiFileReader] No data files in the set");
+        }
+        jump_to(offset);
+    }
+
+    // spec as in expand_file_set(): directory, wildcard, @manifest or single file
+    MultiFileReader(const std::string& spec, size_t chunk_size, size_t offset = 0,
+                    size_t file_buffer_size = _default_buf_sz)
+        : MultiFileReader(expand_file_set(spec), chunk_size, offset, file_buffer_size) {}
+
+    ~MultiFileReader() override { close(); }
+
+    MultiFileReader(const MultiFileReader&) = delete;
+    MultiFileReader& operator=(const MultiFileReader&) = delete;
+
+    size_t read_into(uint8_t* buff_ptr) override {
+        return counters.timed_read(*this, [&]() {
+            size_t filled = 0;
+            while (filled < chunk_sz && cur_idx < paths.size()) {
+                size_t left = sizes[cur_idx] - seg_pos;
+                if (left == 0) {
+                    enter(cur_idx + 1, 0);
+                    continue;
+                }
+                size_t want = std::min(chunk_sz - filled, left);
+                size_t n;
+                if (seg_pos < cur.head.size()) {
+                    n = std::min(want, cur.head.size() - seg_pos);
+                    std::memcpy(buff_ptr + filled, cur.head.data() + seg_pos, n);
+                } else {
+                    n = fread(buff_ptr + filled, 1, want, cur.pf);
+                    if (n < want) {
+                        if (ferror(cur.pf)) {
+                            throw std::runtime_error("[MultiFileReader] Read error: " + paths[cur_idx].string());
+                        }
+                        throw std::runtime_error("[MultiFileReader] File shrank below its indexed size: " +
+                                                 paths[cur_idx].string());
+                    }
+                }
+                seg_pos += n;
+                filled += n;
+            }
+            return filled;
+        });
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override {
+        if (!ReaderCounters::enabled) {
+            return false;
+        }
+        counters.snapshot(st);
+        return true;
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_sz; }
+    std::string get_type() const noexcept override {
+        return "multi-file reader: " + std::to_string(paths.size()) + " files from " + paths.front().string();
+    }
+
+    // Global offset over the concatenated set; offset == get_size() is end of stream
+    void jump_to(size_t offset) {
+        if (offset > total_sz) {
+            throw std::runtime_error("[MultiFileReader] Offset beyond end of the file set");
+        }
+        size_t idx = static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin()) - 1;
+        if (offset == total_sz) {
+            enter(paths.size(), 0);
+            return;
+        }
+        size_t local = offset - starts[idx];
+        if (idx == cur_idx && cur.pf) {
+            seek_local(local);
+            return;
+        }
+        enter(idx, local);
+    }
+
+    size_t get_position() const noexcept {
+        return cur_idx < paths.size() ? starts[cur_idx] + seg_pos : total_sz;
+    }
+
+    size_t get_size() const noexcept { return total_sz; }
+    size_t get_chunk_count() const noexcept { return (total_sz + chunk_sz - 1) / chunk_sz; }
+    size_t get_file_count() const noexcept { return paths.size(); }
+    size_t get_current_file() const noexcept { return cur_idx; }
+    const STD_PATH& get_file_path(size_t i) const noexcept { return paths[i]; }
+    size_t get_file_size(size_t i) const noexcept { return sizes[i]; }
+    size_t get_file_offset(size_t i) const noexcept { return starts[i]; }
+
+    void close() {
+        discard_prefetch();
+        close_segment(cur);
+        cur_idx = paths.size();
+    }
+};
@@ -0,0 +1,338 @@
+// multi_queue_reader.hpp
+#pragma once
+#include "sock_reader.hpp"
+#include "threaded_reader.hpp"
+#include "seq_tracker.hpp"
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+
+struct MultiQueueOpts {
+    size_t queues = 2;                  // sockets / capture threads
+    std::vector<int> cpus;              // capture thread CPU per queue, empty = first_cpu + i
+    int first_cpu = -1;                 // -1 = no pinning, CPU_NIC_LOCAL = spread over dev's NUMA node,
+                                        // CPU_FOLLOW_RX = each thread onto its socket's receive CPU
+    int rt_priority = 0;                // > 0: capture threads run SCHED_FIFO at this priority
+    size_t depth = 8;                   // ring depth per queue
+    QueueBalance balance = QueueBalance::SEQ;
+    bool ordered = true;                // merge by sequence number, else round robin
+    size_t seq_offset = 0;              // sequence header, as in SeqTrackerOpts
+    size_t seq_width = 8;
+    bool big_endian = false;
+    uint32_t reorder_wait_us = 500;     // max wait for a lagging queue before emitting out of turn
+};
+
+// Receive scaling facade: N sockets in one SO_REUSEPORT group (UDP) or
+// PACKET_FANOUT group (raw), each drained by its own (optionally pinned)
+// ThreadedStreamReader. Datagrams from all queues are merged back into
+// sequence order using the embedded sequence number; a queue that lags
+// is waited for at most reorder_wait_us.
+// Output chunks carry a datagram table (get_segments).
+class MultiQueueReader : public I_STREAM_READER {
+private:
+    struct Queue {
+        std::unique_ptr<ThreadedStreamReader> reader;
+        BorrowedChunk cur{};
+        ChunkSegment whole{};           // segment for readers without a datagram table
+        const ChunkSegment* segs = nullptr;
+        size_t seg_count = 0;
+        size_t seg_idx = 0;
+        bool has = false;               // cur borrowed, segs[seg_idx] is the head
+        bool timed_out = false;         // reported ReadTimeout since its last data
+        bool finished = false;
+        uint64_t head_seq = 0;
+        uint64_t datagrams = 0;
+    };
+
+    size_t chunk_size_;
+    MultiQueueOpts mq_;
+    size_t hdr_len_;
+    std::vector<Queue> queues_;
+
+    bool started_ = false;
+    uint64_t next_seq_ = 0;             // next in-turn sequence number
+    bool have_base_ = false;
+    uint64_t base_seq_ = 0;             // first raw head seen: unwrap reference until started_
+    size_t rr_ = 0;
+    uint64_t out_of_order_ = 0;         // emitted behind a later sequence number
+    uint64_t forced_ = 0;               // emitted out of turn after reorder_wait_us
+
+    std::vector<ChunkSegment> segments_;
+    std::vector<PacketMeta> meta_;
+
+    static uint16_t next_fanout_group() noexcept {
+        static std::atomic<uint16_t> counter{0};
+#ifdef _WIN32
+        uint16_t id = counter.fetch_add(1);
+#else
+        uint16_t id = static_cast<uint16_t>(getpid() * 31 + counter.fetch_add(1));
+#endif
+        return id ? id : 1;
+    }
+
+    void load_head(Queue& q) noexcept {
+        const ChunkSegment& s = q.segs[q.seg_idx];
+        if (mq_.ordered && s.length >= hdr_len_) {
+            uint64_t raw = decode_seq(q.cur.data + s.offset + mq_.seq_offset, mq_.seq_width, mq_.big_endian);
+            if (!started_ && !have_base_) {
+                // Not next_seq_ == 0: a narrow counter starting above half range would go negative
+                base_seq_ = raw;
+                have_base_ = true;
+            }
+            q.head_seq = unwrap_seq(raw, started_ ? next_seq_ : base_seq_, mq_.seq_width);
+        } else {
+            q.head_seq = next_seq_;  // no header: always in turn
+        }
+    }
+
+    // Borrow the next chunk of q if one is ready (never blocks)
+    void pull(Queue& q) {
+        if (q.has || q.finished || !q.reader->is_ready()) {
+            return;
+        }
+        try {
+            if (!q.reader->acquire(q.cur)) {
+                q.finished = true;
+                return;
+            }
+        } catch (const ReadTimeout&) {
+            q.timed_out = true;
+            return;
+        }
+        q.timed_out = false;
+        if (q.cur.seg_count > 0) {
+            q.segs = q.cur.segs;
+            q.seg_count = q.cur.seg_count;
+        } else if (q.cur.size > 0) {
+            q.whole = ChunkSegment{0, q.cur.size, 0};
+            q.segs = &q.whole;
+            q.seg_count = 1;
+        } else {
+            q.reader->release();  // empty read (interrupted)
+            return;
+        }
+        q.seg_idx = 0;
+        q.has = true;
+        load_head(q);
+    }
+
+    Queue* pick() noexcept {
+        Queue* best = nullptr;
+        const size_t n = queues_.size();
+        for (size_t k = 0; k < n; ++k) {
+            Queue& q = queues_[(rr_ + k) % n];
+            if (!q.has) {
+                continue;
+            }
+            if (!mq_.ordered) {
+                rr_ = (rr_ + k + 1) % n;
+                return &q;
+            }
+            if (!best || q.head_seq < best->head_seq) {
+                best = &q;
+            }
+        }
+        return best;
+    }
+
+    static void backoff(unsigned n) {
+        if (n < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    }
+
+public:
+    MultiQueueReader(const std::string& ip,
+                     uint16_t port,
+                     const std::string& dev,
+                     int32_t timeout_ms,
+                     size_t chunk_size,
+                     bool is_raw,
+                     const SocketReaderOpts& opts = SocketReaderOpts(),
+                     const MultiQueueOpts& mq = MultiQueueOpts())
+        : chunk_size_(chunk_size)
+        , mq_(mq)
+        , hdr_len_(mq.seq_offset + mq.seq_width)
+    {
+        const size_t n = mq_.queues ? mq_.queues : 1;
+
+        SocketReaderOpts qopts = opts;
+        qopts.balance = mq_.balance;
+        qopts.queue_count = static_cast<uint32_t>(n);
+        qopts.balance_byte = static_cast<uint32_t>(mq_.seq_offset + (mq_.big_endian ? mq_.seq_width - 1 : 0));
+        if (is_raw) {
+            qopts.fanout_group = opts.fanout_group ? opts.fanout_group : next_fanout_group();
+        } else {
+            qopts.reuseport = true;
+        }
+
+        queues_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            ThreadedReaderOpts t;
+            t.depth = mq_.depth;
+            t.cpu = i < mq_.cpus.size() ? mq_.cpus[i]
+                  : mq_.first_cpu >= 0   ? mq_.first_cpu + static_cast<int>(i)
+                                         : resolve_cpu(mq_.first_cpu, dev, i);
+            t.rt_priority = mq_.rt_priority;
+            t.numa_node = resolve_numa_node(opts.numa_node, dev);  // chunk pools next to the NIC
+            t.eof_on_empty = false;
+            std::unique_ptr<I_STREAM_READER> inner(
+                create_socket_reader(ip, port, dev, timeout_ms, chunk_size, is_raw, qopts));
+            queues_[i].reader.reset(new ThreadedStreamReader(inner.get(), t, true));
+            inner.release();
+        }
+    }
+
+    MultiQueueReader(const MultiQueueReader&) = delete;
+    MultiQueueReader& operator=(const MultiQueueReader&) = delete;
+
+    // Merges ready datagrams until the chunk is full or no queue has more.
+    // Throws ReadTimeout once every queue reported a receive timeout.
+    size_t read_into(uint8_t* buff_ptr) override {
+        segments_.clear();
+        meta_.clear();
+        size_t pos = 0;
+        bool waiting = false;
+        std::chrono::steady_clock::time_point wait_start;
+        unsigned spins = 0;
+
+        while (true) {
+            for (Queue& q : queues_) {
+                pull(q);
+            }
+
+            Queue* best = pick();
+            if (best) {
+                // Late datagrams (duplicates, stragglers) go out at once: waiting cannot fix them
+                bool in_turn = !mq_.ordered || (started_ && best->head_seq <= next_seq_);
+                if (!in_turn) {
+                    // Could a queue without a head still deliver an earlier datagram?
+                    bool complete = true;
+                    for (const Queue& q : queues_) {
+                        complete &= q.has || q.timed_out || q.finished;
+                    }
+                    if (!complete) {
+                        auto now = std::chrono::steady_clock::now();
+                        if (!waiting) {
+                            waiting = true;
+                            wait_start = now;
+                        }
+                        if (now - wait_start < std::chrono::microseconds(mq_.reorder_wait_us)) {
+                            backoff(spins++);
+                            continue;
+                        }
+                        ++forced_;
+                    }
+                }
+                waiting = false;
+                spins = 0;
+
+                const ChunkSegment& s = best->segs[best->seg_idx];
+                if (pos + s.length > chunk_size_) {
+                    break;  // head leads the next chunk
+                }
+                std::memcpy(buff_ptr + pos, best->cur.data + s.offset, s.length);
+                segments_.push_back({pos, s.length, s.flags});
+                if (best->cur.meta_count == best->seg_count) {
+                    meta_.push_back(best->cur.meta[best->seg_idx]);
+                }
+                pos += s.length;
+                ++best->datagrams;
+
+                if (mq_.ordered) {
+                    if (started_ && best->head_seq < next_seq_) {
+                        ++out_of_order_;
+                    } else {
+                        next_seq_ = best->head_seq + 1;
+                    }
+                    started_ = true;
+                }
+                if (++best->seg_idx == best->seg_count) {
+                    best->reader->release();
+                    best->has = false;
+                } else {
+                    load_head(*best);
+                }
+                continue;
+            }
+
+            // Nothing buffered on any queue
+            if (pos > 0) {
+                break;
+            }
+            bool all_finished = true;
+            bool all_quiet = true;
+            for (const Queue& q : queues_) {
+                all_finished &= q.finished;
+                all_quiet &= q.timed_out || q.finished;
+            }
+            if (all_finished) {
+                return 0;
+            }
+            if (all_quiet) {
+                for (Queue& q : queues_) {
+                    q.timed_out = false;
+                }
+                throw ReadTimeout("Socket receive timeout expired on all " +
+                                  std::to_string(queues_.size()) + " queues");
+            }
+            backoff(spins++);
+        }
+        return pos;
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_size_; }
+
+    std::string get_type() const noexcept override {
+        return "multiqueue[" + std::to_string(queues_.size()) + "](" +
+               queues_.front().reader->get_inner()->get_type() + ")";
+    }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = meta_.data();
+        return meta_.size();
+    }
+
+    // Sum over the queues; false when no queue keeps counters
+    bool get_stats(ReaderStats& st) const noexcept override {
+        st = ReaderStats{};
+        bool any = false;
+        for (const Queue& q : queues_) {
+            ReaderStats qs;
+            if (q.reader->get_stats(qs)) {
+                st += qs;
+                any = true;
+            }
+        }
+        return any;
+    }
+
+    size_t get_queue_count() const noexcept { return queues_.size(); }
+    ThreadedStreamReader* get_queue(size_t i) const noexcept { return queues_[i].reader.get(); }
+    uint64_t get_queue_datagrams(size_t i) const noexcept { return queues_[i].datagrams; }
+    uint64_t get_out_of_order_count() const noexcept { return out_of_order_; }
+    uint64_t get_forced_count() const noexcept { return forced_; }
+};
+
+// Factory (same parameters as create_socket_reader plus queue layout)
+inline I_STREAM_READER* create_multi_queue_reader(
+    const std::string& ip,
+    uint16_t port,
+    const std::string& dev,
+    int32_t timeout_ms,
+    size_t chunk_size,
+    bool is_raw,
+    const SocketReaderOpts& opts = SocketReaderOpts(),
+    const MultiQueueOpts& mq = MultiQueueOpts())
+{
+    return new MultiQueueReader(ip, port, dev, timeout_ms, chunk_size, is_raw, opts, mq);
+}
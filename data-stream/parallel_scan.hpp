@@ -0,0 +1,439 @@
+// parallel_scan.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include "mmap_file_reader.hpp"    // MappedFile
+#include "threaded_reader.hpp"     // pin_thread_to_cpu, CACHE_LINE_SIZE
+#include "chunk_pool.hpp"
+#include <atomic>
+#include <cerrno>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <string>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// How workers see the file
+enum class ScanIo {
+    PREAD,  // own handle + own aligned buffer per worker, positional reads
+    MMAP,   // views into one shared read-only mapping, no copy
+};
+
+struct ParallelScanOpts {
+    size_t threads = 0;         // 0 = std::thread::hardware_concurrency()
+    size_t grain = 8;           // chunks taken per task
+    ScanIo io = ScanIo::PREAD;
+    int first_cpu = -1;         // pin worker i to first_cpu + i, -1 = no pinning
+    size_t window = 0;          // ordered scans: results held for the sink, 0 = 4 * threads * grain
+};
+
+struct ParallelScanStats {
+    size_t chunks = 0;
+    size_t bytes = 0;
+    size_t steals = 0;          // ranges taken from another worker (unordered scans)
+    double seconds = 0.0;
+};
+
+namespace parallel_scan_detail {
+
+// Per-worker read handle: positional reads, no shared file offset
+class PreadFile {
+private:
+#ifdef _WIN32
+    HANDLE h_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+#endif
+
+public:
+    explicit PreadFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+        h_ = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (h_ == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("[ParallelFileScan] Failed to open file: " + path.string());
+        }
+#else
+        fd_ = ::open(path.string().c_str(), O_RDONLY);
+        if (fd_ == -1) {
+            throw std::runtime_error("[ParallelFileScan] Failed to open file: " + path.string());
+        }
+    #ifdef POSIX_FADV_SEQUENTIAL
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);  // ranges are read front to back
+    #endif
+#endif
+    }
+
+    ~PreadFile() {
+#ifdef _WIN32
+        if (h_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(h_);
+        }
+#else
+        if (fd_ != -1) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    PreadFile(const PreadFile&) = delete;
+    PreadFile& operator=(const PreadFile&) = delete;
+
+    // Reads len bytes at offset (short only at EOF)
+    size_t read_at(uint8_t* dst, size_t len, size_t offset) {
+        size_t got = 0;
+        while (got < len) {
+#ifdef _WIN32
+            OVERLAPPED ov{};
+            uint64_t off = offset + got;
+            ov.Offset = static_cast<DWORD>(off);
+            ov.OffsetHigh = static_cast<DWORD>(off >> 32);
+            DWORD want = static_cast<DWORD>(std::min<size_t>(len - got, 0x40000000));
+            DWORD rd = 0;
+            if (!ReadFile(h_, dst + got, want, &rd, &ov)) {
+                if (GetLastError() == ERROR_HANDLE_EOF) {
+                    break;
+                }
+                throw std::runtime_error("[ParallelFileScan] Read error");
+            }
+#else
+            ssize_t rd = ::pread(fd_, dst + got, len - got, static_cast<off_t>(offset + got));
+            if (rd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("[ParallelFileScan] Read error");
+            }
+#endif
+            if (rd == 0) {
+                break;
+            }
+            got += static_cast<size_t>(rd);
+        }
+        return got;
+    }
+};
+
+// Contiguous chunk range owned by one worker; the owner eats from the
+// front, thieves split off the back half
+struct alignas(CACHE_LINE_SIZE) Range {
+    std::mutex m;
+    size_t lo = 0;
+    size_t hi = 0;
+};
+
+} // namespace parallel_scan_detail
+
+// Splits a file into chunk_size chunks (chunk i = [i * chunk_size, ...),
+// the last one may be short) and processes them on a thread pool.
+// run(): fn(chunk_index, view) is called concurrently in no particular
+// order; each worker starts on its own contiguous range (sequential
+// read-ahead per worker) and steals half of a busy peer's remainder when
+// it runs dry.
+// run_ordered(): map(chunk_index, view) runs concurrently and returns a
+// value; sink(chunk_index, value) is called on the calling thread in
+// chunk order, with at most `window` results buffered.
+// Views are valid during the callback only. The first exception thrown
+// by a callback or a read stops the scan and is rethrown by run*().
+class ParallelFileScan {
+private:
+    STD_PATH path;
+    size_t chunk_sz;
+    ParallelScanOpts opts;
+    size_t fsz = 0;
+    size_t chunk_count = 0;
+    size_t threads = 1;
+    MappedFile map;             // ScanIo::MMAP only
+
+    std::atomic<bool> stop_{false};
+    std::mutex err_m_;
+    std::exception_ptr err_;
+
+    void fail(std::exception_ptr e) {
+        {
+            std::lock_guard<std::mutex> lk(err_m_);
+            if (!err_) {
+                err_ = e;
+            }
+        }
+        stop_.store(true, std::memory_order_relaxed);
+    }
+
+    // Worker-local access to chunk i
+    class View {
+    private:
+        const ParallelFileScan& s_;
+        std::unique_ptr<parallel_scan_detail::PreadFile> file_;
+        std::unique_ptr<ChunkPool> pool_;
+        ChunkPool::Chunk buf_;
+
+    public:
+        explicit View(const ParallelFileScan& s) : s_(s) {
+            if (s.opts.io == ScanIo::PREAD) {
+                file_.reset(new parallel_scan_detail::PreadFile(s.path));
+                pool_.reset(new ChunkPool(s.chunk_sz, 1));
+                buf_ = pool_->acquire();
+            }
+        }
+
+        ByteView get(size_t i) {
+            size_t off = i * s_.chunk_sz;
+            size_t len = std::min(s_.chunk_sz, s_.fsz - off);
+            if (s_.opts.io == ScanIo::MMAP) {
+                return ByteView{s_.map.data() + off, len};
+            }
+            size_t rd = file_->read_at(buf_.data(), len, off);
+            if (rd != len) {
+                throw std::runtime_error("[ParallelFileScan] File shrank during the scan");
+            }
+            return ByteView{buf_.data(), len};
+        }
+
+        // Page in the next task while this one is processed
+        void hint(size_t lo, size_t hi) const noexcept {
+            if (s_.opts.io == ScanIo::MMAP && lo < hi) {
+                s_.map.prefetch(lo * s_.chunk_sz, (hi - lo) * s_.chunk_sz);
+            }
+        }
+    };
+
+    template<class Body>
+    void spawn(std::vector<std::thread>& pool, Body body) {
+        for (size_t w = 0; w < threads; ++w) {
+            pool.emplace_back([this, w, body]() {
+                try {
+                    body(w);
+                } catch (...) {
+                    fail(std::current_exception());
+                }
+            });
+            if (opts.first_cpu >= 0 && !pin_thread_to_cpu(pool.back(), opts.first_cpu + static_cast<int>(w))) {
+                std::cerr << "Warning: failed to pin scan worker " << w << " to CPU " << opts.first_cpu + w << "\n";
+            }
+        }
+    }
+
+    void start() {
+        stop_ = false;
+        err_ = nullptr;
+    }
+
+    void finish(std::vector<std::thread>& pool) {
+        for (std::thread& t : pool) {
+            if (t.joinable()) {
+                t.join();
+            }
+        }
+        if (err_) {
+            std::rethrow_exception(err_);
+        }
+    }
+
+public:
+    ParallelFileScan(const std::string& file_path, size_t chunk_size, const ParallelScanOpts& scan_opts = {})
+        : path(file_path), chunk_sz(chunk_size), opts(scan_opts)
+    {
+        if (chunk_sz == 0) {
+            throw std::runtime_error("[ParallelFileScan] Chunk size must be > 0");
+        }
+        if (opts.grain == 0) {
+            opts.grain = 1;
+        }
+        if (opts.io == ScanIo::MMAP) {
+            map.open(path);
+            fsz = map.size();
+        } else {
+            fsz = fs::file_size(path);
+        }
+        chunk_count = (fsz + chunk_sz - 1) / chunk_sz;
+        threads = opts.threads ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::max<size_t>(1, std::min(threads, (chunk_count + opts.grain - 1) / opts.grain));
+        if (opts.window == 0) {
+            opts.window = 4 * threads * opts.grain;
+        }
+    }
+
+    ParallelFileScan(const ParallelFileScan&) = delete;
+    ParallelFileScan& operator=(const ParallelFileScan&) = delete;
+
+    // fn(size_t chunk_index, ByteView view), called from the workers
+    template<class Fn>
+    ParallelScanStats run(Fn&& fn) {
+        using parallel_scan_detail::Range;
+        start();
+        const auto t0 = std::chrono::steady_clock::now();
+        std::unique_ptr<Range[]> ranges(new Range[threads]);
+        for (size_t w = 0; w < threads; ++w) {
+            ranges[w].lo = chunk_count * w / threads;
+            ranges[w].hi = chunk_count * (w + 1) / threads;
+        }
+        std::atomic<size_t> steals{0};
+
+        std::vector<std::thread> pool;
+        spawn(pool, [&](size_t w) {
+            View view(*this);
+            Range& own = ranges[w];
+            while (!stop_.load(std::memory_order_relaxed)) {
+                size_t lo, hi, end;
+                {
+                    std::lock_guard<std::mutex> lk(own.m);
+                    lo = own.lo;
+                    end = own.hi;
+                    hi = std::min(end, lo + opts.grain);
+                    own.lo = hi;
+                }
+                if (lo == hi) {
+                    // Own range done: take the back half of the largest remainder
+                    size_t victim = threads, best = 0;
+                    for (size_t k = 1; k < threads; ++k) {
+                        size_t v = (w + k) % threads;
+                        std::lock_guard<std::mutex> lk(ranges[v].m);
+                        if (ranges[v].hi - ranges[v].lo > best) {
+                            best = ranges[v].hi - ranges[v].lo;
+                            victim = v;
+                        }
+                    }
+                    if (victim == threads) {
+                        break;
+                    }
+                    size_t s_lo, s_hi;
+                    {
+                        std::lock_guard<std::mutex> lk(ranges[victim].m);
+                        size_t rem = ranges[victim].hi - ranges[victim].lo;
+                        if (rem == 0) {
+                            continue;
+                        }
+                        s_hi = ranges[victim].hi;
+                        s_lo = s_hi - (rem + 1) / 2;
+                        ranges[victim].hi = s_lo;
+                    }
+                    std::lock_guard<std::mutex> lk(own.m);
+                    own.lo = s_lo;
+                    own.hi = s_hi;
+                    steals.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                view.hint(hi, std::min(hi + opts.grain, end));
+                for (size_t i = lo; i < hi && !stop_.load(std::memory_order_relaxed); ++i) {
+                    fn(i, view.get(i));
+                }
+            }
+        });
+        finish(pool);
+
+        ParallelScanStats st;
+        st.chunks = chunk_count;
+        st.bytes = fsz;
+        st.steals = steals.load();
+        st.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return st;
+    }
+
+    // map(size_t chunk_index, ByteView view) -> R on the workers,
+    // sink(size_t chunk_index, R&& value) in chunk order on this thread
+    template<class Map, class Sink>
+    ParallelScanStats run_ordered(Map&& map_fn, Sink&& sink) {
+        using R = std::decay_t<std::invoke_result_t<Map&, size_t, ByteView>>;
+        start();
+        const auto t0 = std::chrono::steady_clock::now();
+        const size_t window = opts.window;
+        std::vector<std::optional<R>> ring(window);     // slot i % window
+        std::mutex m;
+        std::condition_variable cv_ready, cv_space;
+        size_t emitted = 0;                             // next chunk for the sink
+        // Tasks are dealt in order so the lowest outstanding chunk is always in work
+        std::atomic<size_t> next_task{0};
+
+        std::vector<std::thread> pool;
+        spawn(pool, [&](size_t) {
+            View view(*this);
+            while (!stop_.load(std::memory_order_relaxed)) {
+                size_t lo = next_task.fetch_add(opts.grain, std::memory_order_relaxed);
+                if (lo >= chunk_count) {
+                    break;
+                }
+                size_t hi = std::min(chunk_count, lo + opts.grain);
+                view.hint(hi, std::min(chunk_count, hi + opts.grain));
+                for (size_t i = lo; i < hi; ++i) {
+                    {
+                        std::unique_lock<std::mutex> lk(m);
+                        cv_space.wait(lk, [&]() { return i < emitted + window || stop_.load(); });
+                    }
+                    if (stop_.load(std::memory_order_relaxed)) {
+                        break;
+                    }
+                    R r = map_fn(i, view.get(i));
+                    {
+                        std::lock_guard<std::mutex> lk(m);
+                        ring[i % window].emplace(std::move(r));
+                    }
+                    cv_ready.notify_one();
+                }
+            }
+        });
+        auto wake_all = [&]() {
+            std::lock_guard<std::mutex> lk(m);
+            cv_ready.notify_all();
+            cv_space.notify_all();
+        };
+
+        try {
+            while (emitted < chunk_count) {
+                std::optional<R> r;
+                {
+                    std::unique_lock<std::mutex> lk(m);
+                    cv_ready.wait_for(lk, std::chrono::milliseconds(50), [&]() {
+                        return ring[emitted % window].has_value() || stop_.load();
+                    });
+                    if (stop_.load()) {
+                        break;
+                    }
+                    if (!ring[emitted % window]) {
+                        continue;
+                    }
+                    r.swap(ring[emitted % window]);
+                }
+                sink(emitted, std::move(*r));
+                {
+                    std::lock_guard<std::mutex> lk(m);
+                    ++emitted;
+                }
+                cv_space.notify_all();
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        wake_all();
+        finish(pool);
+
+        ParallelScanStats st;
+        st.chunks = chunk_count;
+        st.bytes = fsz;
+        st.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return st;
+    }
+
+    size_t get_size() const noexcept { return fsz; }
+    size_t get_chunk_size() const noexcept { return chunk_sz; }
+    size_t get_chunk_count() const noexcept { return chunk_count; }
+    size_t get_thread_count() const noexcept { return threads; }
+    STD_PATH get_file_path() const noexcept { return path; }
+};
@@ -0,0 +1,356 @@
+// pcap_live_reader.hpp
+#pragma once
+
+#include "socket_common.hpp"
+#include "pcap_reader.hpp"  // link-layer parsing shared with capture file replay
+
+// Built only when libpcap / Npcap is available (CMake defines DATASTREAM_HAS_PCAP)
+#ifdef DATASTREAM_HAS_PCAP
+#include <pcap.h>
+#include <chrono>
+#include <thread>
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+// Raw capture engine on libpcap (Linux, macOS, non-root with CAP_NET_RAW)
+// or Npcap (Windows). The handle runs in immediate mode with a large
+// capture buffer and a compiled "udp dst port" filter; packets are taken
+// zero-copy with pcap_next_ex in non-blocking mode, so one read_into()
+// drains everything already captured (up to opts.batch datagrams) and only
+// waits on the selectable fd / event when the buffer is empty.
+class PcapLiveReader : public I_STREAM_READER {
+private:
+    pcap_t* pcap_ = nullptr;
+    std::string ip_;
+    uint16_t port_;
+    std::string dev_;
+    int32_t timeout_ms_;
+    size_t chunk_size_;
+    SocketReaderOpts opts_;
+    std::unique_ptr<MulticastMembership> mcast_;  // group join when ip is multicast
+    uint32_t link_ = 0;
+    TsSource ts_source_ = TsSource::SOFTWARE;
+    uint64_t ts_scale_ = 1000;  // tv_usec field unit -> ns
+
+    // Packet returned by pcap_next_ex that did not fit into the previous
+    // chunk; libpcap keeps it valid until the next pcap_next_ex call
+    bool have_held_ = false;
+    const uint8_t* held_data_ = nullptr;
+    struct pcap_pkthdr* held_hdr_ = nullptr;
+
+    std::vector<ChunkSegment> segments_;
+    std::vector<PacketMeta> meta_;  // parallel to segments_ when opts_.wants_meta()
+    uint64_t truncated_count_ = 0;
+    uint64_t rejected_count_ = 0;   // passed the filter but not a parsable IPv4/UDP datagram
+    ReaderCounters counters_;
+
+    [[noreturn]] void fail(const std::string& msg) {
+        std::string err = pcap_ ? pcap_geterr(pcap_) : "";
+        release();
+        throw SocketError(msg + (err.empty() ? "" : ": " + err));
+    }
+
+    void release() noexcept {
+        if (pcap_) {
+            pcap_close(pcap_);
+            pcap_ = nullptr;
+        }
+    }
+
+    static std::string filter_expr(const std::string& ip, uint16_t port) {
+        std::string expr = "udp dst port " + std::to_string(port);
+        if (!ip.empty() && ip != "0.0.0.0") {
+            expr += " and dst host " + ip;
+        }
+        return expr;
+    }
+
+    void setup_handle() {
+        char errbuf[PCAP_ERRBUF_SIZE] = {0};
+#ifdef _WIN32
+        if (dev_.empty()) {
+            throw SocketError("Npcap capture needs a device name (\\Device\\NPF_{GUID})");
+        }
+        const char* dev = dev_.c_str();
+#else
+        const char* dev = dev_.empty() ? "any" : dev_.c_str();
+#endif
+        pcap_ = pcap_create(dev, errbuf);
+        if (!pcap_) {
+            throw SocketError("pcap_create(" + std::string(dev) + ") failed: " + errbuf);
+        }
+        int snaplen = static_cast<int>(std::min<size_t>(opts_.pcap_snaplen, 262144));
+        if (pcap_set_snaplen(pcap_, snaplen) != 0 ||
+            pcap_set_promisc(pcap_, opts_.pcap_promisc ? 1 : 0) != 0 ||
+            pcap_set_buffer_size(pcap_, static_cast<int>(opts_.pcap_buffer_size)) != 0 ||
+            pcap_set_timeout(pcap_, timeout_ms_ > 0 ? timeout_ms_ : 1000) != 0) {
+            fail("Failed to configure pcap handle");
+        }
+        if (pcap_set_immediate_mode(pcap_, 1) != 0) {
+            fail("Failed to enable pcap immediate mode");
+        }
+        if (pcap_set_tstamp_precision(pcap_, PCAP_TSTAMP_PRECISION_NANO) == 0) {
+            ts_scale_ = 1;
+        }
+        if (opts_.timestamps == TimestampMode::HARDWARE) {
+            if (pcap_set_tstamp_type(pcap_, PCAP_TSTAMP_ADAPTER) == 0) {
+                ts_source_ = TsSource::HARDWARE;
+            } else {
+                std::cerr << "Warning: adapter timestamps not supported on " << dev
+                          << ". Falling back to host timestamps.\n";
+            }
+        }
+
+        int st = pcap_activate(pcap_);
+        if (st < 0) {
+            fail("pcap_activate(" + std::string(dev) + ") failed (" + pcap_statustostr(st) + ")");
+        }
+        if (st > 0) {
+            std::cerr << "Warning: pcap_activate(" << dev << "): " << pcap_statustostr(st)
+                      << " " << pcap_geterr(pcap_) << "\n";
+            if (st == PCAP_WARNING_TSTAMP_TYPE_NOTSUP) {
+                ts_source_ = TsSource::SOFTWARE;
+            }
+        }
+
+        int dlt = pcap_datalink(pcap_);
+        link_ = dlt == DLT_RAW ? PCAP_LINK_RAW : static_cast<uint32_t>(dlt);
+        if (link_ != PCAP_LINK_ETHERNET && link_ != PCAP_LINK_LINUX_SLL && link_ != PCAP_LINK_LINUX_SLL2 &&
+            link_ != PCAP_LINK_NULL && link_ != PCAP_LINK_RAW && link_ != PCAP_LINK_IPV4) {
+            fail("Unsupported link type " + std::string(pcap_datalink_val_to_name(dlt) ? pcap_datalink_val_to_name(dlt) : "?"));
+        }
+
+        struct bpf_program prog;
+        std::string expr = filter_expr(ip_, port_);
+        if (pcap_compile(pcap_, &prog, expr.c_str(), 1, PCAP_NETMASK_UNKNOWN) != 0) {
+            fail("Failed to compile capture filter \"" + expr + "\"");
+        }
+        int rc = pcap_setfilter(pcap_, &prog);
+        pcap_freecode(&prog);
+        if (rc != 0) {
+            fail("Failed to attach capture filter");
+        }
+        if (pcap_setnonblock(pcap_, 1, errbuf) != 0) {
+            std::string err = errbuf;
+            release();
+            throw SocketError("Failed to set pcap non-blocking mode: " + err);
+        }
+    }
+
+    // Wait until the capture buffer has data; false on timeout
+    bool wait_readable(int32_t ms) {
+#ifdef _WIN32
+        HANDLE ev = pcap_getevent(pcap_);
+        return WaitForSingleObject(ev, ms >= 0 ? static_cast<DWORD>(ms) : INFINITE) == WAIT_OBJECT_0;
+#else
+        int fd = pcap_get_selectable_fd(pcap_);
+        if (fd < 0) {
+            // No pollable fd (some BSD devices): short sleep, caller re-checks the deadline
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return true;
+        }
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int rc = poll(&pfd, 1, ms);
+        if (rc == -1 && errno != EINTR) {
+            throw SocketError("poll on pcap handle failed: " + get_last_socket_error());
+        }
+        return rc > 0;
+#endif
+    }
+
+    // Next captured packet (held one first); false when none is ready
+    bool next_packet(const uint8_t*& data, struct pcap_pkthdr*& hdr) {
+        if (have_held_) {
+            data = held_data_;
+            hdr = held_hdr_;
+            return true;
+        }
+        const u_char* d;
+        int rc = pcap_next_ex(pcap_, &hdr, &d);
+        if (rc == 1) {
+            data = d;
+            held_data_ = data;
+            held_hdr_ = hdr;
+            have_held_ = true;
+            return true;
+        }
+        if (rc == 0) {
+            return false;
+        }
+        throw SocketError("pcap_next_ex failed: " + std::string(pcap_geterr(pcap_)));
+    }
+
+public:
+    PcapLiveReader(const std::string& ip,
+                   uint16_t port,
+                   const std::string& dev,
+                   int32_t timeout_ms,
+                   size_t chunk_size,
+                   const SocketReaderOpts& opts = SocketReaderOpts())
+        : ip_(ip), port_(port), dev_(dev), timeout_ms_(timeout_ms), chunk_size_(chunk_size), opts_(opts)
+#ifdef _WIN32
+        , mcast_(capture_membership(ip, "", opts))  // NPF device names are no interface index
+#else
+        , mcast_(capture_membership(ip, dev, opts))
+#endif
+    {
+        setup_handle();
+        segments_.reserve(opts_.batch);
+    }
+
+    ~PcapLiveReader() override { release(); }
+
+    PcapLiveReader(const PcapLiveReader&) = delete;
+    PcapLiveReader& operator=(const PcapLiveReader&) = delete;
+
+private:
+    // Up to opts.batch whole datagrams; blocks (wait) only while nothing is captured.
+    // st: TIMEOUT after timeout_ms without traffic (timeout_ms <= 0: wait forever),
+    // WOULD_BLOCK when nothing is captured and !wait.
+    size_t read_chunk(uint8_t* buff_ptr, bool wait, ReadStatus& st) {
+        segments_.clear();
+        meta_.clear();
+        st = ReadStatus::OK;
+        const size_t max_dgrams = opts_.batch ? opts_.batch : 1;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms_);
+        size_t pos = 0;
+
+        while (segments_.size() < max_dgrams) {
+            const uint8_t* data;
+            struct pcap_pkthdr* hdr;
+            if (!next_packet(data, hdr)) {
+                if (pos > 0) {
+                    break;
+                }
+                if (!wait) {
+                    st = ReadStatus::WOULD_BLOCK;
+                    return 0;
+                }
+                int32_t wait_ms = -1;
+                if (timeout_ms_ > 0) {
+                    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - std::chrono::steady_clock::now()).count();
+                    if (left <= 0) {
+                        st = ReadStatus::TIMEOUT;
+                        return 0;
+                    }
+                    wait_ms = static_cast<int32_t>(left);
+                }
+                wait_readable(wait_ms);
+                continue;
+            }
+
+            size_t ip_len = 0;
+            const uint8_t* ip = pcap_detail::find_ipv4(link_, data, hdr->caplen, ip_len);
+            const uint8_t* payload = nullptr;
+            size_t payload_len = 0;
+            FrameStatus fst = ip ? parse_udp_ipv4(ip, ip_len, port_, payload, payload_len)
+                                 : FrameStatus::WRONG_PORT;  // not IPv4: foreign traffic
+            if (fst != FrameStatus::OK) {
+                have_held_ = false;
+                ++rejected_count_;
+                count_rejected_frame(counters_, fst);
+                continue;
+            }
+
+            uint32_t flags = hdr->caplen < hdr->len ? SEG_TRUNCATED : 0;
+            size_t len = payload_len;
+            if (pos + len > chunk_size_) {
+                if (pos > 0) {
+                    break;  // stays held for the next chunk
+                }
+                len = chunk_size_;
+                flags |= SEG_TRUNCATED;
+            }
+            truncated_count_ += (flags & SEG_TRUNCATED) != 0;
+            std::memcpy(buff_ptr + pos, payload, len);
+            segments_.push_back({pos, len, flags});
+            if (opts_.wants_meta()) {
+                PacketMeta m{};
+                m.ts_ns = uint64_t(hdr->ts.tv_sec) * 1000000000ull + uint64_t(hdr->ts.tv_usec) * ts_scale_;
+                m.ts_source = ts_source_;
+                udp_ipv4_source(ip, payload, m);
+                meta_.push_back(m);
+            }
+            pos += len;
+            have_held_ = false;
+        }
+        return pos;
+    }
+
+public:
+    size_t read_into(uint8_t* buff_ptr) override {
+        return counters_.timed_read(*this, [&]() {
+            ReadStatus st;
+            size_t rd = read_chunk(buff_ptr, true, st);
+            if (st == ReadStatus::TIMEOUT) {
+                throw ReadTimeout("Capture timeout expired (" + std::to_string(timeout_ms_) + " ms)");
+            }
+            return rd;
+        });
+    }
+
+    ReadResult try_read_into(uint8_t* buff_ptr) override {
+        return counters_.timed_try_read(*this, [&]() {
+            ReadStatus st;
+            size_t rd = read_chunk(buff_ptr, !opts_.nonblocking, st);
+            return ReadResult{st, rd};
+        });
+    }
+
+    // Linux: selectable fd (-1 on devices without one); Windows: the Npcap
+    // event HANDLE for WaitForMultipleObjects, not a socket
+    native_handle_t get_native_handle() const noexcept override {
+#ifdef _WIN32
+        return reinterpret_cast<native_handle_t>(pcap_getevent(pcap_));
+#else
+        return pcap_get_selectable_fd(pcap_);
+#endif
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override {
+        if (!ReaderCounters::enabled) {
+            return false;
+        }
+        counters_.snapshot(st);
+        // Kernel / driver drops: get_capture_stats() (pcap_stats is not safe to call concurrently)
+        return true;
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_size_; }
+
+    std::string get_type() const noexcept override { return "SocketReader<PCAP>"; }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = meta_.data();
+        return meta_.size();
+    }
+
+    // Capture counters from libpcap / the driver (received, dropped by buffer, dropped by interface)
+    bool get_capture_stats(uint64_t& received, uint64_t& dropped, uint64_t& if_dropped) const noexcept {
+        struct pcap_stat ps;
+        if (pcap_stats(pcap_, &ps) != 0) {
+            return false;
+        }
+        received = ps.ps_recv;
+        dropped = ps.ps_drop;
+        if_dropped = ps.ps_ifdrop;
+        return true;
+    }
+
+    uint64_t get_truncated_count() const noexcept { return truncated_count_; }
+    uint64_t get_rejected_count() const noexcept { return rejected_count_; }
+    uint32_t get_link_type() const noexcept { return link_; }
+    static const char* get_library_version() noexcept { return pcap_lib_version(); }
+};
+
+#endif // DATASTREAM_HAS_PCAP
@@ -0,0 +1,451 @@
+// pcap_reader.hpp
+#pragma once
+#include "socket_common.hpp"     // before windows.h: winsock2 must come first
+#include "mmap_file_reader.hpp"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+// Link-layer types (tcpdump.org/linktypes.html) understood by PcapReader
+enum PcapLinkType : uint32_t {
+    PCAP_LINK_NULL = 0,         // BSD loopback: 4-byte host-order address family
+    PCAP_LINK_ETHERNET = 1,     // 802.1Q / QinQ tags are skipped
+    PCAP_LINK_RAW = 101,        // bare IPv4/IPv6
+    PCAP_LINK_LINUX_SLL = 113,  // Linux "any" cooked v1
+    PCAP_LINK_IPV4 = 228,
+    PCAP_LINK_LINUX_SLL2 = 276, // Linux "any" cooked v2
+};
+
+namespace pcap_detail {
+
+constexpr uint32_t PCAP_MAGIC_US = 0xA1B2C3D4;
+constexpr uint32_t PCAP_MAGIC_NS = 0xA1B23C4D;
+constexpr uint32_t PCAPNG_SHB = 0x0A0D0D0A;
+constexpr uint32_t PCAPNG_IDB = 0x00000001;
+constexpr uint32_t PCAPNG_SPB = 0x00000003;
+constexpr uint32_t PCAPNG_EPB = 0x00000006;
+constexpr uint32_t PCAPNG_BYTE_ORDER = 0x1A2B3C4D;
+
+inline uint16_t bswap16(uint16_t v) noexcept { return static_cast<uint16_t>((v >> 8) | (v << 8)); }
+inline uint32_t bswap32(uint32_t v) noexcept {
+    return (v >> 24) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24);
+}
+
+// IPv4 header of a captured frame, nullptr if not IPv4
+inline const uint8_t* find_ipv4(uint32_t link, const uint8_t* f, size_t len, size_t& ip_len) noexcept {
+    size_t off = 0;
+    uint16_t proto = 0;
+    switch (link) {
+        case PCAP_LINK_ETHERNET: {
+            off = 12;
+            if (len < off + 2) {
+                return nullptr;
+            }
+            proto = static_cast<uint16_t>((f[off] << 8) | f[off + 1]);
+            while ((proto == 0x8100 || proto == 0x88A8) && len >= off + 6) {
+                off += 4;
+                proto = static_cast<uint16_t>((f[off] << 8) | f[off + 1]);
+            }
+            off += 2;
+            break;
+        }
+        case PCAP_LINK_LINUX_SLL:
+            if (len < 16) {
+                return nullptr;
+            }
+            proto = static_cast<uint16_t>((f[14] << 8) | f[15]);
+            off = 16;
+            break;
+        case PCAP_LINK_LINUX_SLL2:
+            if (len < 20) {
+                return nullptr;
+            }
+            proto = static_cast<uint16_t>((f[0] << 8) | f[1]);
+            off = 20;
+            break;
+        case PCAP_LINK_NULL: {
+            if (len < 4) {
+                return nullptr;
+            }
+            uint32_t fam;
+            std::memcpy(&fam, f, 4);
+            if (fam != 2 && bswap32(fam) != 2) {  // AF_INET in either byte order
+                return nullptr;
+            }
+            proto = 0x0800;
+            off = 4;
+            break;
+        }
+        case PCAP_LINK_RAW:
+        case PCAP_LINK_IPV4:
+            proto = 0x0800;
+            break;
+        default:
+            return nullptr;
+    }
+    if (proto != 0x0800 || len < off + 20) {
+        return nullptr;
+    }
+    const uint8_t* ip = f + off;
+    if ((ip[0] >> 4) != 4) {
+        return nullptr;
+    }
+    ip_len = len - off;
+    return ip;
+}
+
+} // namespace pcap_detail
+
+// Capture file replay: pcap (usec / nsec) and pcapng (SHB / IDB / EPB / SPB,
+// any byte order, multiple sections) parsed from a read-only mapping.
+// Every IPv4/UDP datagram that matches the destination port (0 = any) is
+// delivered as in the raw-socket path: payload only, one segment per
+// datagram, packet metadata from the capture timestamp and source address.
+// Non-first fragments are skipped.
+//
+// Matching datagrams are indexed lazily while the file is read forward, so
+// jump_to / jump_to_time are a lookup in the index (binary search by time)
+// and only scan the not yet indexed tail once.
+class PcapReader : public I_STREAM_READER {
+public:
+    struct Entry {
+        uint64_t payload_off;   // file offset of the UDP payload
+        uint64_t ts_ns;         // capture time, ns since the Unix epoch
+        uint32_t payload_len;   // captured payload bytes
+        uint32_t src_ip;        // host byte order
+        uint16_t src_port;
+        uint16_t flags;         // SEG_TRUNCATED: snaplen cut the datagram
+    };
+
+private:
+    struct Iface {
+        uint32_t link;
+        uint64_t ts_mul;        // tick -> ns: ts * ts_mul / ts_div
+        uint64_t ts_div;
+    };
+
+    STD_PATH path_;
+    size_t chunk_sz_;
+    uint16_t port_;
+    MappedFile map_;
+
+    bool ng_ = false;
+    bool swap_ = false;
+    std::vector<Iface> ifaces_;         // pcapng: interfaces of the current section
+    std::vector<Entry> index_;
+    size_t scan_off_ = 0;               // next unparsed record / block
+    bool scan_done_ = false;
+    uint64_t records_ = 0;              // captured packets seen by the scan (all protocols)
+
+    size_t cursor_ = 0;                 // next datagram to deliver (index position)
+    std::vector<ChunkSegment> segments_;
+    std::vector<PacketMeta> meta_;
+
+    uint16_t rd16(size_t off) const noexcept {
+        uint16_t v;
+        std::memcpy(&v, map_.data() + off, 2);
+        return swap_ ? pcap_detail::bswap16(v) : v;
+    }
+
+    uint32_t rd32(size_t off) const noexcept {
+        uint32_t v;
+        std::memcpy(&v, map_.data() + off, 4);
+        return swap_ ? pcap_detail::bswap32(v) : v;
+    }
+
+    void truncated_tail() {
+        std::cerr << "Warning: " << path_.string() << " ends with a truncated record at offset "
+                  << scan_off_ << ". Ignoring the remainder.\n";
+        scan_done_ = true;
+    }
+
+    void open_header() {
+        if (map_.size() < 24) {
+            throw std::runtime_error("[PcapReader] File too small for a capture header: " + path_.string());
+        }
+        uint32_t magic;
+        std::memcpy(&magic, map_.data(), 4);
+        if (magic == pcap_detail::PCAPNG_SHB) {
+            ng_ = true;
+            scan_off_ = 0;  // the SHB is parsed as the first block
+            return;
+        }
+        uint32_t sw = pcap_detail::bswap32(magic);
+        bool ns = magic == pcap_detail::PCAP_MAGIC_NS || sw == pcap_detail::PCAP_MAGIC_NS;
+        if (magic != pcap_detail::PCAP_MAGIC_US && magic != pcap_detail::PCAP_MAGIC_NS &&
+            sw != pcap_detail::PCAP_MAGIC_US && sw != pcap_detail::PCAP_MAGIC_NS) {
+            throw std::runtime_error("[PcapReader] Not a pcap / pcapng file: " + path_.string());
+        }
+        swap_ = sw == pcap_detail::PCAP_MAGIC_US || sw == pcap_detail::PCAP_MAGIC_NS;
+        uint32_t link = rd32(20) & 0x0FFFFFFF;  // upper bits: FCS length
+        ifaces_.push_back(Iface{link, ns ? 1u : 1000u, 1});
+        scan_off_ = 24;
+    }
+
+    // pcapng if_tsresol: 10^-v or 2^-v seconds per tick
+    static Iface make_iface(uint32_t link, uint8_t tsresol) {
+        Iface f{link, 1000, 1};  // default microseconds
+        if (tsresol & 0x80) {
+            f.ts_mul = 1000000000ull;
+            f.ts_div = uint64_t(1) << std::min<uint8_t>(tsresol & 0x7F, 63);
+        } else if (tsresol <= 9) {
+            f.ts_mul = 1;
+            for (uint8_t k = tsresol; k < 9; ++k) {
+                f.ts_mul *= 10;
+            }
+        } else {
+            f.ts_mul = 1;
+            f.ts_div = 1;
+            for (uint8_t k = 9; k < std::min<uint8_t>(tsresol, 19); ++k) {
+                f.ts_div *= 10;
+            }
+        }
+        return f;
+    }
+
+    static uint64_t ticks_to_ns(const Iface& f, uint64_t ticks) noexcept {
+        if (f.ts_div == 1) {
+            return ticks * f.ts_mul;
+        }
+        return static_cast<uint64_t>(static_cast<long double>(ticks) * f.ts_mul / f.ts_div);
+    }
+
+    void parse_idb(size_t body, size_t body_len) {
+        if (body_len < 8) {
+            throw std::runtime_error("[PcapReader] Malformed interface block in " + path_.string());
+        }
+        uint32_t link = rd16(body);
+        uint8_t tsresol = 6;
+        size_t opt = body + 8;
+        const size_t end = body + body_len;
+        while (opt + 4 <= end) {
+            uint16_t code = rd16(opt);
+            uint16_t len = rd16(opt + 2);
+            if (code == 0 || opt + 4 + len > end) {
+                break;
+            }
+            if (code == 9 && len >= 1) {  // if_tsresol
+                tsresol = map_.data()[opt + 4];
+            }
+            opt += 4 + ((len + 3u) & ~3u);
+        }
+        ifaces_.push_back(make_iface(link, tsresol));
+    }
+
+    // Filter one captured frame into the index
+    void add_frame(const Iface& f, size_t frame_off, size_t cap_len, size_t orig_len, uint64_t ts_ns) {
+        ++records_;
+        const uint8_t* frame = map_.data() + frame_off;
+        size_t ip_len = 0;
+        const uint8_t* ip = pcap_detail::find_ipv4(f.link, frame, cap_len, ip_len);
+        if (!ip || ip[9] != 17 || (((ip[6] & 0x1F) << 8) | ip[7]) != 0) {
+            return;  // not UDP, or a non-first fragment
+        }
+        const size_t ihl = (ip[0] & 0x0F) * 4;
+        if (ip_len < ihl + 8) {
+            return;
+        }
+        uint16_t port = port_ ? port_ : static_cast<uint16_t>((ip[ihl + 2] << 8) | ip[ihl + 3]);
+        const uint8_t* payload;
+        size_t payload_len;
+        if (parse_udp_ipv4(ip, ip_len, port, payload, payload_len) != FrameStatus::OK) {
+            return;
+        }
+        PacketMeta m{};
+        udp_ipv4_source(ip, payload, m);
+        const uint8_t* udp = payload - 8;
+        size_t udp_len = (udp[4] << 8) | udp[5];
+        bool cut = cap_len < orig_len && udp_len >= 8 && payload_len < udp_len - 8;
+        index_.push_back(Entry{static_cast<uint64_t>(payload - map_.data()), ts_ns,
+                               static_cast<uint32_t>(payload_len), m.src_ip, m.src_port,
+                               static_cast<uint16_t>(cut ? SEG_TRUNCATED : 0)});
+    }
+
+    // Parse records until one more datagram is indexed or the file ends
+    bool scan_next() {
+        const size_t before = index_.size();
+        const size_t size = map_.size();
+        while (!scan_done_ && index_.size() == before) {
+            if (!ng_) {
+                if (scan_off_ + 16 > size) {
+                    if (scan_off_ != size) {
+                        truncated_tail();
+                    }
+                    scan_done_ = true;
+                    break;
+                }
+                uint64_t ts_hi = rd32(scan_off_);
+                uint64_t ts_lo = rd32(scan_off_ + 4);
+                size_t cap = rd32(scan_off_ + 8);
+                size_t orig = rd32(scan_off_ + 12);
+                if (scan_off_ + 16 + cap > size) {
+                    truncated_tail();
+                    break;
+                }
+                const Iface& f = ifaces_.front();
+                add_frame(f, scan_off_ + 16, cap, orig, ts_hi * 1000000000ull + ts_lo * f.ts_mul);
+                scan_off_ += 16 + cap;
+                continue;
+            }
+
+            if (scan_off_ + 12 > size) {
+                if (scan_off_ != size) {
+                    truncated_tail();
+                }
+                scan_done_ = true;
+                break;
+            }
+            uint32_t type;
+            std::memcpy(&type, map_.data() + scan_off_, 4);  // SHB type is a palindrome
+            if (type == pcap_detail::PCAPNG_SHB) {
+                uint32_t bom;
+                std::memcpy(&bom, map_.data() + scan_off_ + 8, 4);
+                if (bom != pcap_detail::PCAPNG_BYTE_ORDER && pcap_detail::bswap32(bom) != pcap_detail::PCAPNG_BYTE_ORDER) {
+                    throw std::runtime_error("[PcapReader] Bad pcapng byte-order magic in " + path_.string());
+                }
+                swap_ = bom != pcap_detail::PCAPNG_BYTE_ORDER;
+                ifaces_.clear();  // interface ids are per section
+            } else {
+                type = rd32(scan_off_);
+            }
+            size_t blen = rd32(scan_off_ + 4);
+            if (blen < 12 || (blen & 3) != 0) {
+                throw std::runtime_error("[PcapReader] Malformed pcapng block at offset " +
+                                         std::to_string(scan_off_) + " in " + path_.string());
+            }
+            if (scan_off_ + blen > size) {
+                truncated_tail();
+                break;
+            }
+            const size_t body = scan_off_ + 8;
+            const size_t body_len = blen - 12;
+            if (type == pcap_detail::PCAPNG_IDB) {
+                parse_idb(body, body_len);
+            } else if (type == pcap_detail::PCAPNG_EPB && body_len >= 20) {
+                uint32_t id = rd32(body);
+                size_t cap = rd32(body + 12);
+                size_t orig = rd32(body + 16);
+                if (id < ifaces_.size() && 20 + cap <= body_len) {
+                    uint64_t ticks = (uint64_t(rd32(body + 4)) << 32) | rd32(body + 8);
+                    add_frame(ifaces_[id], body + 20, cap, orig, ticks_to_ns(ifaces_[id], ticks));
+                }
+            } else if (type == pcap_detail::PCAPNG_SPB && body_len >= 4 && !ifaces_.empty()) {
+                size_t orig = rd32(body);
+                add_frame(ifaces_.front(), body + 4, std::min(orig, body_len - 4), orig, 0);  // no timestamp
+            }
+            scan_off_ += blen;
+        }
+        return index_.size() > before;
+    }
+
+    // Make index_[n] available if the file has it
+    bool ensure_indexed(size_t n) {
+        while (index_.size() <= n) {
+            if (!scan_next()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    // port: UDP destination port to replay, 0 = every UDP datagram
+    PcapReader(const std::string& file_path, size_t chunk_size, uint16_t port = 0)
+        : path_(file_path), chunk_sz_(chunk_size), port_(port), map_(path_)
+    {
+        open_header();
+        map_.prefetch(0, 2 * chunk_sz_);
+        ensure_indexed(0);  // pcapng: parse the leading section / interface blocks
+    }
+
+    ~PcapReader() override { close(); }
+
+    // Whole datagrams until the next one would not fit; a datagram larger
+    // than the chunk is cut to chunk size and flagged SEG_TRUNCATED
+    size_t read_into(uint8_t* buff_ptr) override {
+        segments_.clear();
+        meta_.clear();
+        size_t pos = 0;
+        while (ensure_indexed(cursor_)) {
+            const Entry& e = index_[cursor_];
+            size_t len = e.payload_len;
+            uint32_t flags = e.flags;
+            if (pos + len > chunk_sz_) {
+                if (pos > 0) {
+                    break;
+                }
+                len = chunk_sz_;
+                flags |= SEG_TRUNCATED;
+            }
+            std::memcpy(buff_ptr + pos, map_.data() + e.payload_off, len);
+            segments_.push_back({pos, len, flags});
+            meta_.push_back(PacketMeta{e.ts_ns, e.ts_ns ? TsSource::SOFTWARE : TsSource::NONE,
+                                       e.src_ip, e.src_port, flags, {}});
+            pos += len;
+            ++cursor_;
+        }
+        return pos;
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_sz_; }
+    std::string get_type() const noexcept override {
+        return std::string(ng_ ? "pcapng" : "pcap") + " reader: " + path_.string();
+    }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = meta_.data();
+        return meta_.size();
+    }
+
+    // Position at datagram n (0-based, matching datagrams only).
+    // O(1) inside the index, otherwise scans forward once.
+    void jump_to(size_t n) {
+        if (n > 0 && !ensure_indexed(n - 1)) {
+            throw std::runtime_error("[PcapReader] Datagram " + std::to_string(n) + " beyond end of capture (" +
+                                     std::to_string(index_.size()) + " datagrams)");
+        }
+        cursor_ = n;
+    }
+
+    // Position at the first datagram captured at or after ts_ns; O(log n)
+    // once indexed. Assumes capture timestamps are non-decreasing.
+    // Returns the datagram number (== get_packet_count() if none).
+    size_t jump_to_time(uint64_t ts_ns) {
+        while (!scan_done_ && (index_.empty() || index_.back().ts_ns < ts_ns)) {
+            scan_next();
+        }
+        auto it = std::lower_bound(index_.begin(), index_.end(), ts_ns,
+                                   [](const Entry& e, uint64_t t) { return e.ts_ns < t; });
+        cursor_ = static_cast<size_t>(it - index_.begin());
+        return cursor_;
+    }
+
+    // Index the whole file (one pass, no payload copies)
+    void build_index() {
+        while (scan_next()) {
+        }
+    }
+
+    // Matching datagrams in the file (completes the index)
+    size_t get_packet_count() {
+        build_index();
+        return index_.size();
+    }
+
+    const Entry* get_entry(size_t n) { return ensure_indexed(n) ? &index_[n] : nullptr; }
+
+    size_t get_position() const noexcept { return cursor_; }
+    size_t get_indexed_count() const noexcept { return index_.size(); }
+    bool is_index_complete() const noexcept { return scan_done_; }
+    uint64_t get_record_count() const noexcept { return records_; }
+    uint32_t get_link_type() const noexcept { return ifaces_.empty() ? 0 : ifaces_.front().link; }
+    size_t get_size() const noexcept { return map_.size(); }
+    STD_PATH get_file_path() const noexcept { return path_; }
+
+    void close() { map_.close(); cursor_ = 0; index_.clear(); scan_done_ = true; }
+};
@@ -0,0 +1,52 @@
+// pipeline.hpp
+#pragma once
+#include "seq_tracker.hpp"
+#include "iq_convert.hpp"
+#include "rechunk.hpp"
+
+// Compile-time reader pipelines: a source reader and decorator stages
+// nested by value, e.g.
+//
+//   Pipeline<TpacketReader, SeqTracker, I16ToF32> p(iq_opts, seq_opts,
+//                                                   ip, port, dev, timeout_ms, chunk, sock_opts);
+//
+// Stages are listed source -> sink; constructor arguments go the other way:
+// the outermost stage's opts first, then each inner stage's, then the
+// source's own constructor arguments. Stage-to-stage calls are qualified
+// (ReaderValue), so the whole chain binds statically and the compiler can
+// inline it into one loop. The outermost stage is still an I_STREAM_READER:
+// hand it out by pointer where the runtime factory style is expected, at
+// the cost of the one virtual call at the top.
+
+// Stage tags: each maps an inner type to the decorator wrapping it
+struct SeqTracker {
+    template<class In>
+    using stage = BasicSeqTrackingReader<ReaderValue<In>>;
+};
+
+struct I16ToF32 {
+    template<class In>
+    using stage = BasicIqConvertReader<ReaderValue<In>>;
+};
+
+struct Rechunk {
+    template<class In>
+    using stage = BasicRechunkReader<ReaderValue<In>>;
+};
+
+namespace pipeline_detail {
+
+template<class Src, class... Stages>
+struct compose {
+    using type = Src;
+};
+
+template<class Src, class S, class... Rest>
+struct compose<Src, S, Rest...> {
+    using type = typename compose<typename S::template stage<Src>, Rest...>::type;
+};
+
+} // namespace pipeline_detail
+
+template<class Src, class... Stages>
+using Pipeline = typename pipeline_detail::compose<Src, Stages...>::type;
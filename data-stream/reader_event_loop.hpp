@@ -0,0 +1,492 @@
+// reader_event_loop.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include "socket_common.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+#ifndef _WIN32
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+#endif
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+    #include <coroutine>
+    #include <exception>
+    #define DATASTREAM_HAS_COROUTINES 1
+#endif
+
+// One thread servicing many non-blocking readers (SocketReaderOpts::nonblocking).
+// Readiness comes from epoll (Linux) or WSAPoll (Windows, sockets only:
+// IOCP completes reads into posted buffers, which does not fit the
+// read_into(caller buffer) model). Level-triggered: a handler is called
+// while its reader's handle is readable and should read until WOULD_BLOCK,
+// since readers keep already-dequeued datagrams the handle no longer signals.
+// With C++20, coroutines co_await async_read_into() on the same loop.
+// Not thread-safe except stop(); handlers and coroutines run inside run_once().
+class ReaderEventLoop {
+public:
+    using Handler = std::function<void(I_STREAM_READER&)>;
+    using clock = std::chrono::steady_clock;
+
+    // Back-to-back reads an awaiting coroutine completes without yielding
+    static constexpr unsigned INLINE_BUDGET = 64;
+
+private:
+    struct Entry {
+        I_STREAM_READER* reader = nullptr;
+        native_handle_t handle = INVALID_NATIVE_HANDLE;
+        Handler handler;
+        bool dead = false;
+        unsigned inline_reads = 0;
+#ifdef DATASTREAM_HAS_COROUTINES
+        std::coroutine_handle<> waiter{};
+        ReadStatus* wake_status = nullptr;  // TIMEOUT when the deadline fired
+        bool has_deadline = false;
+        clock::time_point deadline{};
+#endif
+        bool waiting() const noexcept {
+#ifdef DATASTREAM_HAS_COROUTINES
+            return bool(waiter);
+#else
+            return false;
+#endif
+        }
+    };
+
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::atomic<bool> stop_{false};
+#ifdef DATASTREAM_HAS_COROUTINES
+    std::vector<std::coroutine_handle<>> ready_;    // yielded coroutines, resumed next round
+#endif
+#ifdef _WIN32
+    SOCKET wake_sock_ = INVALID_SOCKET;             // loopback UDP socket poked by stop()
+    struct sockaddr_in wake_addr_{};
+#else
+    int epfd_ = -1;
+    int wake_fd_ = -1;                              // eventfd poked by stop()
+#endif
+
+    Entry* find(const I_STREAM_READER* r) const noexcept {
+        for (const auto& e : entries_) {
+            if (e->reader == r && !e->dead) {
+                return e.get();
+            }
+        }
+        return nullptr;
+    }
+
+#ifndef _WIN32
+    // Handler entries always listen; coroutine-only entries only while a waiter is armed
+    void update_interest(Entry& e) {
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = (e.handler || e.waiting()) ? static_cast<uint32_t>(EPOLLIN) : 0u;
+        ev.data.ptr = &e;
+        if (epoll_ctl(epfd_, EPOLL_CTL_MOD, e.handle, &ev) != 0) {
+            throw std::runtime_error("[ReaderEventLoop] epoll_ctl(MOD) failed: " + get_last_socket_error());
+        }
+    }
+#endif
+
+    Entry& register_reader(I_STREAM_READER* r) {
+        if (Entry* e = find(r)) {
+            return *e;
+        }
+        native_handle_t h = r->get_native_handle();
+        if (h == INVALID_NATIVE_HANDLE) {
+            throw std::runtime_error("[ReaderEventLoop] Reader has no pollable handle: " + r->get_type());
+        }
+        std::unique_ptr<Entry> e(new Entry);
+        e->reader = r;
+        e->handle = h;
+#ifndef _WIN32
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = 0;
+        ev.data.ptr = e.get();
+        if (epoll_ctl(epfd_, EPOLL_CTL_ADD, h, &ev) != 0) {
+            throw std::runtime_error("[ReaderEventLoop] epoll_ctl(ADD) failed for " + r->get_type() +
+                                     ": " + get_last_socket_error());
+        }
+#endif
+        entries_.push_back(std::move(e));
+        return *entries_.back();
+    }
+
+    void dispatch(Entry& e) {
+        if (e.dead) {
+            return;
+        }
+#ifdef DATASTREAM_HAS_COROUTINES
+        if (e.waiter) {
+            std::coroutine_handle<> h = e.waiter;
+            e.waiter = {};
+            e.has_deadline = false;
+            *e.wake_status = ReadStatus::OK;
+            e.inline_reads = 0;
+#ifndef _WIN32
+            if (!e.handler) {
+                update_interest(e);
+            }
+#endif
+            h.resume();
+            return;
+        }
+#endif
+        if (e.handler) {
+            e.handler(*e.reader);
+        }
+    }
+
+    // Poll wait bounded by the nearest coroutine deadline
+    int poll_timeout(int32_t timeout_ms) const {
+#ifdef DATASTREAM_HAS_COROUTINES
+        if (!ready_.empty()) {
+            return 0;
+        }
+        int64_t ms = timeout_ms < 0 ? -1 : timeout_ms;
+        const auto now = clock::now();
+        for (const auto& e : entries_) {
+            if (!e->dead && e->waiter && e->has_deadline) {
+                int64_t left = std::chrono::duration_cast<std::chrono::milliseconds>(e->deadline - now).count() + 1;
+                left = std::max<int64_t>(left, 0);
+                ms = ms < 0 ? left : std::min(ms, left);
+            }
+        }
+        return static_cast<int>(ms);
+#else
+        return timeout_ms < 0 ? -1 : timeout_ms;
+#endif
+    }
+
+    void expire_deadlines() {
+#ifdef DATASTREAM_HAS_COROUTINES
+        const auto now = clock::now();
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            Entry& e = *entries_[i];
+            if (!e.dead && e.waiter && e.has_deadline && e.deadline <= now) {
+                std::coroutine_handle<> h = e.waiter;
+                e.waiter = {};
+                e.has_deadline = false;
+                *e.wake_status = ReadStatus::TIMEOUT;
+                e.inline_reads = 0;
+#ifndef _WIN32
+                if (!e.handler) {
+                    update_interest(e);
+                }
+#endif
+                h.resume();
+            }
+        }
+#endif
+    }
+
+    void purge() {
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                      [](const std::unique_ptr<Entry>& e) { return e->dead; }),
+                       entries_.end());
+    }
+
+public:
+    ReaderEventLoop() {
+#ifdef _WIN32
+        WSAInitializer::instance();
+        wake_sock_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (wake_sock_ == INVALID_SOCKET) {
+            throw SocketError("[ReaderEventLoop] Failed to create wake socket: " + get_last_socket_error());
+        }
+        wake_addr_.sin_family = AF_INET;
+        wake_addr_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int len = sizeof(wake_addr_);
+        if (bind(wake_sock_, reinterpret_cast<struct sockaddr*>(&wake_addr_), sizeof(wake_addr_)) == SOCKET_ERROR ||
+            getsockname(wake_sock_, reinterpret_cast<struct sockaddr*>(&wake_addr_), &len) == SOCKET_ERROR) {
+            closesocket(wake_sock_);
+            throw SocketError("[ReaderEventLoop] Failed to bind wake socket: " + get_last_socket_error());
+        }
+        set_socket_nonblocking(wake_sock_);
+#else
+        epfd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epfd_ == -1) {
+            throw std::runtime_error("[ReaderEventLoop] epoll_create1 failed: " + get_last_socket_error());
+        }
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ == -1) {
+            ::close(epfd_);
+            throw std::runtime_error("[ReaderEventLoop] eventfd failed: " + get_last_socket_error());
+        }
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr;
+        epoll_ctl(epfd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+#endif
+    }
+
+    ~ReaderEventLoop() {
+#ifdef _WIN32
+        if (wake_sock_ != INVALID_SOCKET) {
+            closesocket(wake_sock_);
+        }
+#else
+        if (wake_fd_ != -1) {
+            ::close(wake_fd_);
+        }
+        if (epfd_ != -1) {
+            ::close(epfd_);
+        }
+#endif
+    }
+
+    ReaderEventLoop(const ReaderEventLoop&) = delete;
+    ReaderEventLoop& operator=(const ReaderEventLoop&) = delete;
+
+    // handler(reader) runs on every readiness; the loop does not own reader
+    void add(I_STREAM_READER* reader, Handler handler) {
+        Entry& e = register_reader(reader);
+        e.handler = std::move(handler);
+#ifndef _WIN32
+        update_interest(e);
+#endif
+    }
+
+    // Safe from handlers; a coroutine still waiting on the reader is never resumed
+    void remove(I_STREAM_READER* reader) {
+        Entry* e = find(reader);
+        if (!e) {
+            return;
+        }
+#ifndef _WIN32
+        epoll_ctl(epfd_, EPOLL_CTL_DEL, e->handle, nullptr);
+#endif
+        e->dead = true;
+    }
+
+    size_t size() const noexcept {
+        size_t n = 0;
+        for (const auto& e : entries_) {
+            n += !e->dead;
+        }
+        return n;
+    }
+
+    // Waits up to timeout_ms (< 0: forever) and dispatches what became ready.
+    // Returns: handlers / coroutines run, 0 on idle timeout or wakeup
+    size_t run_once(int32_t timeout_ms = -1) {
+        size_t ran = 0;
+        int wait_ms = poll_timeout(timeout_ms);
+#ifdef _WIN32
+        std::vector<WSAPOLLFD> fds;
+        std::vector<Entry*> owners;
+        WSAPOLLFD wake{};
+        wake.fd = wake_sock_;
+        wake.events = POLLRDNORM;
+        fds.push_back(wake);
+        owners.push_back(nullptr);
+        for (const auto& e : entries_) {
+            if (!e->dead && (e->handler || e->waiting())) {
+                WSAPOLLFD p{};
+                p.fd = static_cast<SOCKET>(e->handle);
+                p.events = POLLRDNORM;
+                fds.push_back(p);
+                owners.push_back(e.get());
+            }
+        }
+        int n = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), wait_ms);
+        if (n == SOCKET_ERROR && WSAGetLastError() != WSAEINTR) {
+            throw SocketError("[ReaderEventLoop] WSAPoll() failed: " + get_last_socket_error());
+        }
+        for (size_t i = 0; n > 0 && i < fds.size(); ++i) {
+            if (!(fds[i].revents & (POLLRDNORM | POLLERR | POLLHUP))) {
+                continue;
+            }
+            if (!owners[i]) {
+                char b[16];
+                while (recv(wake_sock_, b, sizeof(b), 0) > 0) {
+                }
+                continue;
+            }
+            dispatch(*owners[i]);
+            ++ran;
+        }
+#else
+        struct epoll_event evs[64];
+        int n = epoll_wait(epfd_, evs, 64, wait_ms);
+        if (n == -1 && errno != EINTR) {
+            throw std::runtime_error("[ReaderEventLoop] epoll_wait failed: " + get_last_socket_error());
+        }
+        for (int i = 0; i < n; ++i) {
+            Entry* e = static_cast<Entry*>(evs[i].data.ptr);
+            if (!e) {
+                uint64_t v;
+                while (read(wake_fd_, &v, sizeof(v)) > 0) {
+                }
+                continue;
+            }
+            dispatch(*e);
+            ++ran;
+        }
+#endif
+        expire_deadlines();
+#ifdef DATASTREAM_HAS_COROUTINES
+        std::vector<std::coroutine_handle<>> yielded;
+        yielded.swap(ready_);
+        for (std::coroutine_handle<> h : yielded) {
+            h.resume();
+            ++ran;
+        }
+#endif
+        purge();
+        return ran;
+    }
+
+    // run_once() until stop()
+    void run() {
+        stop_ = false;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            run_once(-1);
+        }
+    }
+
+    // Thread-safe: makes run() return after the current round
+    void stop() noexcept {
+        stop_ = true;
+#ifdef _WIN32
+        char b = 0;
+        sendto(wake_sock_, &b, 1, 0, reinterpret_cast<const struct sockaddr*>(&wake_addr_), sizeof(wake_addr_));
+#else
+        uint64_t one = 1;
+        ssize_t rc = write(wake_fd_, &one, sizeof(one));
+        (void)rc;
+#endif
+    }
+
+#ifdef DATASTREAM_HAS_COROUTINES
+    // co_await loop.async_read_into(reader, buff[, timeout_ms]) -> ReadResult.
+    // Completes inline while data is queued (up to INLINE_BUDGET reads, then
+    // yields one round so other streams get their turn), otherwise suspends
+    // until the reader's handle is readable or timeout_ms (< 0: none) passes.
+    // A spurious wakeup can still end in WOULD_BLOCK: just await again.
+    class ReadAwaitable {
+    private:
+        ReaderEventLoop& loop_;
+        I_STREAM_READER& reader_;
+        uint8_t* buff_;
+        int32_t timeout_ms_;
+        ReadResult res_{ReadStatus::WOULD_BLOCK, 0};
+        ReadStatus wake_ = ReadStatus::OK;
+        bool yielded_ = false;
+
+    public:
+        ReadAwaitable(ReaderEventLoop& loop, I_STREAM_READER& reader, uint8_t* buff, int32_t timeout_ms)
+            : loop_(loop), reader_(reader), buff_(buff), timeout_ms_(timeout_ms) {}
+
+        bool await_ready() {
+            Entry& e = loop_.register_reader(&reader_);
+            if (e.inline_reads >= INLINE_BUDGET) {
+                yielded_ = true;
+                return false;
+            }
+            res_ = reader_.try_read_into(buff_);
+            if (res_.status == ReadStatus::WOULD_BLOCK) {
+                return false;
+            }
+            ++e.inline_reads;
+            return true;
+        }
+
+        void await_suspend(std::coroutine_handle<> h) {
+            Entry& e = loop_.register_reader(&reader_);
+            e.inline_reads = 0;
+            if (yielded_) {
+                loop_.ready_.push_back(h);
+                return;
+            }
+            e.waiter = h;
+            e.wake_status = &wake_;
+            e.has_deadline = timeout_ms_ >= 0;
+            if (e.has_deadline) {
+                e.deadline = clock::now() + std::chrono::milliseconds(timeout_ms_);
+            }
+#ifndef _WIN32
+            loop_.update_interest(e);
+#endif
+        }
+
+        ReadResult await_resume() {
+            if (res_.status != ReadStatus::WOULD_BLOCK && !yielded_) {
+                return res_;  // completed inline
+            }
+            if (wake_ == ReadStatus::TIMEOUT) {
+                return ReadResult{ReadStatus::TIMEOUT, 0};
+            }
+            return reader_.try_read_into(buff_);
+        }
+    };
+
+    ReadAwaitable async_read_into(I_STREAM_READER& reader, uint8_t* buff, int32_t timeout_ms = -1) {
+        return ReadAwaitable(*this, reader, buff, timeout_ms);
+    }
+#endif
+};
+
+#ifdef DATASTREAM_HAS_COROUTINES
+// Eagerly started coroutine owning its frame; the body runs up to its first
+// suspension when called, then continues inside ReaderEventLoop::run_once().
+// Keep it alive (and its readers registered) until done().
+class ReaderTask {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+
+        ReaderTask get_return_object() {
+            return ReaderTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> h_;
+
+    explicit ReaderTask(std::coroutine_handle<promise_type> h) : h_(h) {}
+
+public:
+    ReaderTask(ReaderTask&& o) noexcept : h_(o.h_) { o.h_ = {}; }
+    ReaderTask& operator=(ReaderTask&& o) noexcept {
+        if (this != &o) {
+            if (h_) {
+                h_.destroy();
+            }
+            h_ = o.h_;
+            o.h_ = {};
+        }
+        return *this;
+    }
+    ReaderTask(const ReaderTask&) = delete;
+    ReaderTask& operator=(const ReaderTask&) = delete;
+
+    ~ReaderTask() {
+        if (h_) {
+            h_.destroy();
+        }
+    }
+
+    bool done() const noexcept { return !h_ || h_.done(); }
+
+    // Rethrows what escaped the coroutine body, if anything
+    void rethrow_if_failed() const {
+        if (h_ && h_.done() && h_.promise().error) {
+            std::rethrow_exception(h_.promise().error);
+        }
+    }
+};
+#endif
@@ -0,0 +1,177 @@
+// reader_stats.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// Hot-path instrumentation, compiled in only with DATASTREAM_STATS
+// (CMake: -DDATASTREAM_WITH_STATS=ON). Without it ReaderCounters is an
+// empty type, every update is a no-op and get_stats() returns false.
+
+// read_into() duration histogram: bin i counts reads of [2^(i-1), 2^i) ns
+constexpr size_t STATS_HIST_BINS = 40;
+
+// Point-in-time copy of a reader's counters (get_stats)
+struct ReaderStats {
+    uint64_t reads = 0;          // read_into() calls that returned
+    uint64_t bytes = 0;
+    uint64_t packets = 0;        // datagrams delivered (segments)
+    uint64_t wrong_port = 0;     // frames received but discarded: foreign flow
+    uint64_t bad_frames = 0;     // frames discarded as runt / malformed IPv4 header
+    uint64_t truncated = 0;      // segments with SEG_TRUNCATED
+    uint64_t timeouts = 0;       // ReadTimeout raised
+    bool kernel_drops_valid = false;
+    uint64_t kernel_drops = 0;   // socket queue overflow (sk_drops, PACKET_STATISTICS, XDP ring drops)
+    uint64_t rcvbuf_bytes = 0;   // socket receive buffer as granted (SO_RCVBUF read back), 0 = not a recv socket
+    uint64_t rcvbuf_raises = 0;  // adaptive receive buffer growth steps (rcvbuf_auto)
+    uint64_t read_ns_hist[STATS_HIST_BINS] = {};
+
+    // Upper bound of the bin holding the p-quantile of read_into() time, ns
+    uint64_t read_ns_quantile(double p) const noexcept {
+        uint64_t total = 0;
+        for (uint64_t c : read_ns_hist) {
+            total += c;
+        }
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t want = static_cast<uint64_t>(p * double(total));
+        uint64_t acc = 0;
+        for (size_t i = 0; i < STATS_HIST_BINS; ++i) {
+            acc += read_ns_hist[i];
+            if (acc > want) {
+                return 1ull << i;
+            }
+        }
+        return 1ull << (STATS_HIST_BINS - 1);
+    }
+
+    // Sum of two readers' counters (multi-queue facades)
+    ReaderStats& operator+=(const ReaderStats& o) noexcept {
+        reads += o.reads;
+        bytes += o.bytes;
+        packets += o.packets;
+        wrong_port += o.wrong_port;
+        bad_frames += o.bad_frames;
+        truncated += o.truncated;
+        timeouts += o.timeouts;
+        kernel_drops_valid = kernel_drops_valid || o.kernel_drops_valid;
+        kernel_drops += o.kernel_drops;
+        rcvbuf_bytes += o.rcvbuf_bytes;
+        rcvbuf_raises += o.rcvbuf_raises;
+        for (size_t i = 0; i < STATS_HIST_BINS; ++i) {
+            read_ns_hist[i] += o.read_ns_hist[i];
+        }
+        return *this;
+    }
+};
+
+// Counters owned by one reader. Written only by the thread calling
+// read_into() (plain load + store, no locked RMW), read by any thread
+// through snapshot(); all accesses are relaxed.
+class ReaderCounters {
+#ifdef DATASTREAM_STATS
+private:
+    using Counter = std::atomic<uint64_t>;
+    Counter reads_{0}, bytes_{0}, packets_{0}, wrong_port_{0}, bad_frames_{0}, truncated_{0}, timeouts_{0};
+    Counter hist_[STATS_HIST_BINS] = {};
+
+    static void bump(Counter& c, uint64_t n = 1) noexcept {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void record_time(std::chrono::steady_clock::time_point t0) noexcept {
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count());
+        size_t bin = 0;
+        while (ns && bin < STATS_HIST_BINS - 1) {
+            ns >>= 1;
+            ++bin;
+        }
+        bump(hist_[bin]);
+    }
+
+    void account(const I_STREAM_READER& reader, size_t rd) noexcept {
+        bump(reads_);
+        bump(bytes_, rd);
+        const ChunkSegment* segs;
+        size_t n = reader.get_segments(segs);
+        bump(packets_, n ? n : (rd ? 1 : 0));
+        uint64_t trunc = 0;
+        for (size_t i = 0; i < n; ++i) {
+            trunc += (segs[i].flags & SEG_TRUNCATED) != 0;
+        }
+        if (trunc) {
+            bump(truncated_, trunc);
+        }
+    }
+
+public:
+    static constexpr bool enabled = true;
+
+    // Runs one read and accounts for it; segments come from the reader's own table
+    template<class F>
+    size_t timed_read(const I_STREAM_READER& reader, F&& read) {
+        const auto t0 = std::chrono::steady_clock::now();
+        size_t rd;
+        try {
+            rd = read();
+        } catch (const ReadTimeout&) {
+            bump(timeouts_);
+            record_time(t0);
+            throw;
+        }
+        record_time(t0);
+        account(reader, rd);
+        return rd;
+    }
+
+    // Same for try_read_into(); WOULD_BLOCK polls are not timed or counted
+    template<class F>
+    ReadResult timed_try_read(const I_STREAM_READER& reader, F&& read) {
+        const auto t0 = std::chrono::steady_clock::now();
+        ReadResult r = read();
+        if (r.status == ReadStatus::WOULD_BLOCK) {
+            return r;
+        }
+        record_time(t0);
+        if (r.status == ReadStatus::TIMEOUT) {
+            bump(timeouts_);
+        } else {
+            account(reader, r.size);
+        }
+        return r;
+    }
+
+    void add_wrong_port(uint64_t n = 1) noexcept { bump(wrong_port_, n); }
+    void add_bad_frame(uint64_t n = 1) noexcept { bump(bad_frames_, n); }
+
+    void snapshot(ReaderStats& st) const noexcept {
+        st.reads = reads_.load(std::memory_order_relaxed);
+        st.bytes = bytes_.load(std::memory_order_relaxed);
+        st.packets = packets_.load(std::memory_order_relaxed);
+        st.wrong_port = wrong_port_.load(std::memory_order_relaxed);
+        st.bad_frames = bad_frames_.load(std::memory_order_relaxed);
+        st.truncated = truncated_.load(std::memory_order_relaxed);
+        st.timeouts = timeouts_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < STATS_HIST_BINS; ++i) {
+            st.read_ns_hist[i] = hist_[i].load(std::memory_order_relaxed);
+        }
+    }
+#else
+public:
+    static constexpr bool enabled = false;
+
+    template<class F>
+    size_t timed_read(const I_STREAM_READER&, F&& read) { return read(); }
+
+    template<class F>
+    ReadResult timed_try_read(const I_STREAM_READER&, F&& read) { return read(); }
+
+    void add_wrong_port(uint64_t = 1) noexcept {}
+    void add_bad_frame(uint64_t = 1) noexcept {}
+    void snapshot(ReaderStats&) const noexcept {}
+#endif
+};
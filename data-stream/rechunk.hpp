@@ -0,0 +1,297 @@
+// rechunk.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+// Ring storage mapped twice back to back: bytes [size, 2 * size) alias
+// [0, size), so any run of up to size() bytes starting inside the ring is
+// contiguous in memory, across the wrap, with no copy. size() is the
+// requested minimum rounded up to the page (Windows: allocation) granularity.
+class MirrorRing {
+private:
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE map_ = nullptr;
+#endif
+
+public:
+    explicit MirrorRing(size_t min_size) {
+#ifdef _WIN32
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        const size_t gran = si.dwAllocationGranularity;
+        size_ = (std::max<size_t>(min_size, 1) + gran - 1) / gran * gran;
+        const unsigned long long sz = size_;
+        map_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(sz >> 32), static_cast<DWORD>(sz), nullptr);
+        if (!map_) {
+            throw std::runtime_error("[MirrorRing] CreateFileMapping failed for " + std::to_string(size_) + " bytes");
+        }
+        // Find a free 2 * size range, release it and map both views into it;
+        // another thread may grab the range in between, so retry a few times
+        for (int attempt = 0; attempt < 16 && !base_; ++attempt) {
+            void* hint = VirtualAlloc(nullptr, 2 * size_, MEM_RESERVE, PAGE_NOACCESS);
+            if (!hint) {
+                break;
+            }
+            VirtualFree(hint, 0, MEM_RELEASE);
+            void* lo = MapViewOfFileEx(map_, FILE_MAP_ALL_ACCESS, 0, 0, size_, hint);
+            void* hi = lo ? MapViewOfFileEx(map_, FILE_MAP_ALL_ACCESS, 0, 0, size_, static_cast<uint8_t*>(hint) + size_)
+                          : nullptr;
+            if (lo && hi) {
+                base_ = static_cast<uint8_t*>(lo);
+            } else if (lo) {
+                UnmapViewOfFile(lo);
+            }
+        }
+        if (!base_) {
+            CloseHandle(map_);
+            throw std::runtime_error("[MirrorRing] Failed to map mirrored views");
+        }
+#else
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_ = (std::max<size_t>(min_size, 1) + page - 1) / page * page;
+    #ifdef MFD_CLOEXEC
+        int fd = memfd_create("datastream-ring", MFD_CLOEXEC);
+    #else
+        int fd = -1;
+    #endif
+        if (fd < 0) {
+            throw std::runtime_error("[MirrorRing] memfd_create failed");
+        }
+        if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+            ::close(fd);
+            throw std::runtime_error("[MirrorRing] ftruncate failed for " + std::to_string(size_) + " bytes");
+        }
+        // Reserve 2 * size, then map the same pages over both halves
+        void* p = mmap(nullptr, 2 * size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("[MirrorRing] mmap reserve failed");
+        }
+        uint8_t* base = static_cast<uint8_t*>(p);
+        if (mmap(base, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(base + size_, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(base, 2 * size_);
+            ::close(fd);
+            throw std::runtime_error("[MirrorRing] mmap of mirrored views failed");
+        }
+        ::close(fd);  // mappings keep the memory alive
+        base_ = base;
+#endif
+    }
+
+    ~MirrorRing() {
+#ifdef _WIN32
+        UnmapViewOfFile(base_ + size_);
+        UnmapViewOfFile(base_);
+        CloseHandle(map_);
+#else
+        munmap(base_, 2 * size_);
+#endif
+    }
+
+    MirrorRing(const MirrorRing&) = delete;
+    MirrorRing& operator=(const MirrorRing&) = delete;
+
+    uint8_t* data() const noexcept { return base_; }
+    size_t size() const noexcept { return size_; }
+};
+
+struct RechunkOpts {
+    size_t block_samples = 4096;  // samples per output block (e.g. FFT size)
+    size_t overlap = 0;           // samples repeated from the previous block (< block_samples)
+    size_t sample_size = 4;       // bytes per sample: int16 IQ pair = 4, cf32 = 8
+    size_t hdr_sz = 8;            // per-datagram header to strip (gen_tst_udp_test_stream.py: 8-byte seq)
+    size_t ring_blocks = 4;       // ring capacity in blocks, on top of one inner chunk
+    bool mirror = true;           // MirrorRing, else (or if unavailable) a compacting linear buffer
+};
+
+// Pipeline stage: slices the wrapped reader's byte stream into fixed-size,
+// optionally overlapping sample blocks, independent of datagram / chunk size.
+// Per-datagram headers are stripped and each payload is trimmed to whole
+// samples, so IQ pairs stay aligned across datagram boundaries; readers
+// without a datagram table (files) form one continuous headerless run.
+// Inner chunks are read straight into the ring and compacted in place;
+// read_block() returns a pointer into the ring (zero copy, contiguous even
+// across the wrap thanks to the mirrored mapping). read_into() copies the
+// block out for plain I_STREAM_READER use. A trailing partial block at end
+// of stream is not returned. Output blocks carry no datagram table.
+// Inner: ReaderRef (RechunkReader) or ReaderValue<R> (static pipelines).
+template<class Inner>
+class BasicRechunkReader : public I_STREAM_READER {
+private:
+    Inner inner_;
+    RechunkOpts opts_;
+    size_t block_bytes_;
+    size_t hop_bytes_;
+    size_t in_chunk_;
+    std::unique_ptr<MirrorRing> mirror_;
+    std::vector<uint8_t> linear_;
+    uint8_t* buf_ = nullptr;
+    size_t cap_ = 0;
+    size_t rd_ = 0;                 // block start; mirror: kept < cap_
+    size_t wr_ = 0;                 // end of buffered payload
+    bool handed_ = false;           // block at rd_ is out with the caller
+    uint64_t block_start_ = 0;      // stream byte offset of the block at rd_
+    uint64_t blocks_ = 0;
+    uint64_t trimmed_ = 0;          // datagram tail bytes dropped (not a whole sample)
+    uint64_t runts_ = 0;            // datagrams not longer than the header
+
+    // Strip headers of the n bytes just read at dst, in place; returns payload bytes kept
+    size_t strip(uint8_t* dst, size_t n) {
+        const ChunkSegment* segs;
+        size_t seg_count = inner_.get_segments(segs);
+        if (seg_count == 0) {
+            return n;
+        }
+        size_t out = 0;
+        for (size_t k = 0; k < seg_count; ++k) {  // segments ascend, so data only moves down
+            if (segs[k].length <= opts_.hdr_sz) {
+                ++runts_;
+                continue;
+            }
+            size_t len = segs[k].length - opts_.hdr_sz;
+            size_t tail = len % opts_.sample_size;
+            trimmed_ += tail;
+            len -= tail;
+            const uint8_t* src = dst + segs[k].offset + opts_.hdr_sz;
+            if (src != dst + out) {
+                std::memmove(dst + out, src, len);
+            }
+            out += len;
+        }
+        return out;
+    }
+
+    // Until a whole block is buffered; false at end of stream
+    bool fill() {
+        while (wr_ - rd_ < block_bytes_) {
+            if (!mirror_ && cap_ - wr_ < in_chunk_) {
+                std::memmove(buf_, buf_ + rd_, wr_ - rd_);
+                wr_ -= rd_;
+                rd_ = 0;
+            }
+            uint8_t* dst = buf_ + wr_;
+            size_t rd = inner_.read_into(dst);
+            if (rd == 0) {
+                return false;
+            }
+            wr_ += strip(dst, rd);
+        }
+        return true;
+    }
+
+public:
+    // Inner built in place from inner_args (ReaderRef: reader pointer [, own])
+    template<class... A>
+    explicit BasicRechunkReader(const RechunkOpts& opts, A&&... inner_args)
+        : inner_(std::forward<A>(inner_args)...)
+        , opts_(opts)
+        , block_bytes_(opts.block_samples * opts.sample_size)
+        , hop_bytes_((opts.block_samples - opts.overlap) * opts.sample_size)
+        , in_chunk_(inner_.get_chunk_size())
+    {
+        if (opts_.block_samples == 0 || opts_.sample_size == 0) {
+            throw std::runtime_error("[RechunkReader] Block and sample size must be > 0");
+        }
+        if (opts_.overlap >= opts_.block_samples) {
+            throw std::runtime_error("[RechunkReader] Overlap must be < block_samples");
+        }
+        // A whole inner chunk must always fit behind a partially filled block
+        const size_t need = std::max<size_t>(opts_.ring_blocks, 1) * block_bytes_ + in_chunk_;
+        if (opts_.mirror) {
+            try {
+                mirror_.reset(new MirrorRing(need));
+                buf_ = mirror_->data();
+                cap_ = mirror_->size();
+            } catch (const std::runtime_error& e) {
+                std::cerr << "Warning: " << e.what() << ", using a compacting buffer\n";
+            }
+        }
+        if (!mirror_) {
+            linear_.resize(need);
+            buf_ = linear_.data();
+            cap_ = need;
+        }
+    }
+
+    template<class I = Inner, std::enable_if_t<std::is_same<I, ReaderRef>::value, int> = 0>
+    BasicRechunkReader(I_STREAM_READER* inner,
+                       const RechunkOpts& opts = RechunkOpts(),
+                       bool own_inner = false)
+        : BasicRechunkReader(opts, inner, own_inner)
+    {
+    }
+
+    BasicRechunkReader(const BasicRechunkReader&) = delete;
+    BasicRechunkReader& operator=(const BasicRechunkReader&) = delete;
+
+    // Next block in place, valid until the next call; returns get_block_size() or 0 at end of stream.
+    // Reader exceptions (ReadTimeout) propagate; buffered data is kept for the retry.
+    size_t read_block(const uint8_t*& block) {
+        if (handed_) {
+            handed_ = false;
+            rd_ += hop_bytes_;
+            block_start_ += hop_bytes_;
+            if (mirror_ && rd_ >= cap_) {
+                rd_ -= cap_;
+                wr_ -= cap_;
+            }
+        }
+        if (!fill()) {
+            return 0;
+        }
+        handed_ = true;
+        ++blocks_;
+        block = buf_ + rd_;
+        return block_bytes_;
+    }
+
+    size_t read_into(uint8_t* buff_ptr) override {
+        const uint8_t* block;
+        size_t n = read_block(block);
+        std::memcpy(buff_ptr, block, n);
+        return n;
+    }
+
+    size_t get_chunk_size() const noexcept override { return block_bytes_; }
+    size_t get_block_size() const noexcept { return block_bytes_; }
+
+    std::string get_type() const noexcept override {
+        return "rechunk[" + std::to_string(opts_.block_samples) + "/" + std::to_string(opts_.overlap) +
+               (mirror_ ? ",mirror" : "") + "](" + inner_.get_type() + ")";
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override { return inner_.get_stats(st); }
+
+    // Stream position of the last block, in samples (headers excluded)
+    uint64_t get_block_sample() const noexcept { return block_start_ / opts_.sample_size; }
+    uint64_t get_block_count() const noexcept { return blocks_; }
+    uint64_t get_trimmed_bytes() const noexcept { return trimmed_; }
+    uint64_t get_runt_count() const noexcept { return runts_; }
+    bool is_mirrored() const noexcept { return mirror_ != nullptr; }
+    const RechunkOpts& get_opts() const noexcept { return opts_; }
+    auto get_inner() noexcept { return inner_.get(); }
+    auto get_inner() const noexcept { return inner_.get(); }
+};
+
+// Runtime stage over any I_STREAM_READER*
+using RechunkReader = BasicRechunkReader<ReaderRef>;
@@ -0,0 +1,374 @@
+// seq_tracker.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include <vector>
+#include <cstring>
+#include <string>
+#include <algorithm>
+
+// Sequence number of width 1..8 bytes at p
+inline uint64_t decode_seq(const uint8_t* p, size_t width, bool big_endian) noexcept {
+    uint64_t v = 0;
+    for (size_t i = 0; i < width; ++i) {
+        size_t k = big_endian ? i : width - 1 - i;
+        v = (v << 8) | p[k];
+    }
+    return v;
+}
+
+// Extend a narrow (wrapping) sequence number to 64 bits around ref
+// (serial number arithmetic: the nearer of the candidates wins)
+inline uint64_t unwrap_seq(uint64_t raw, uint64_t ref, size_t width) noexcept {
+    if (width >= 8) {
+        return raw;
+    }
+    uint64_t mask = (uint64_t(1) << (8 * width)) - 1;
+    uint64_t diff = (raw - ref) & mask;
+    int64_t sdiff = (diff > (mask >> 1)) ? static_cast<int64_t>(diff - mask - 1)
+                                         : static_cast<int64_t>(diff);
+    return ref + static_cast<uint64_t>(sdiff);
+}
+
+// What to do about datagrams that never arrived
+enum class GapPolicy {
+    COUNT,      // account only, pass datagrams through as received
+    ZERO_FILL   // insert zeroed placeholder datagrams so sample alignment is preserved
+};
+
+struct SeqTrackerOpts {
+    size_t seq_offset = 0;         // byte offset of the sequence number in each datagram
+    size_t seq_width = 8;          // 1, 2, 4 or 8 bytes
+    bool big_endian = false;       // gen_tst_udp_test_stream.py sends LE int64
+    bool strip_header = false;     // drop bytes [0, seq_offset + seq_width) from the output
+    GapPolicy policy = GapPolicy::COUNT;
+    size_t fill_size = 0;          // placeholder payload bytes, 0 = size of the last good datagram
+    uint64_t max_fill = 4096;      // never synthesize more than this many datagrams per gap
+    uint64_t resync_gap = 1u << 20;  // forward jump beyond this is a stream restart, not loss
+    bool drop_duplicates = true;
+};
+
+// Loss accounting (all counters in datagrams)
+struct SeqStats {
+    uint64_t received = 0;     // datagrams with a decodable sequence number
+    uint64_t lost = 0;         // currently missing (late arrivals are credited back)
+    uint64_t gaps = 0;         // gap events
+    uint64_t duplicates = 0;
+    uint64_t reordered = 0;    // arrived after a later sequence number
+    uint64_t filled = 0;       // placeholders emitted (ZERO_FILL)
+    uint64_t late_dropped = 0; // late datagrams dropped because their slot was already filled
+    uint64_t resyncs = 0;      // restarts (big jump or jump back out of the window)
+    uint64_t runts = 0;        // datagrams too short to hold the sequence number
+    uint64_t first_seq = 0;
+    uint64_t last_seq = 0;     // highest sequence number seen
+};
+
+// Decorator: decodes a per-datagram sequence number from the wrapped
+// reader's output, tracks gaps, duplicates and reordering, and optionally
+// zero-fills lost datagrams. Datagram boundaries come from get_segments(),
+// a reader without segments is treated as one datagram per chunk.
+// Output chunk size equals the inner one; placeholders that do not fit are
+// carried over to the next read_into(). Output segments are marked with
+// SEG_FILLED / SEG_REORDERED.
+// Inner: ReaderRef (SeqTrackingReader) or ReaderValue<R> (static pipelines).
+template<class Inner>
+class BasicSeqTrackingReader : public I_STREAM_READER {
+private:
+    static constexpr uint64_t WINDOW = 1024;  // duplicate / reorder history (datagrams)
+
+    Inner inner_;
+    SeqTrackerOpts opts_;
+    size_t chunk_size_;
+    size_t hdr_len_;
+    uint64_t seq_mask_;
+
+    // Inner chunk being drained
+    std::vector<uint8_t> stage_;
+    std::vector<ChunkSegment> stage_segs_;
+    std::vector<PacketMeta> stage_meta_;  // empty, or parallel to stage_segs_
+    size_t stage_idx_ = 0;
+    bool cur_checked_ = false;  // stage_segs_[stage_idx_] already went through the tracker
+
+    // Tracker state
+    bool started_ = false;
+    uint64_t expected_ = 0;       // next in-order (unwrapped) sequence number
+    std::vector<uint64_t> seen_;  // WINDOW-bit history, bit = seq % WINDOW
+    uint64_t pending_fill_ = 0;   // placeholders still to emit
+    uint64_t fill_seq_ = 0;       // sequence number of the next placeholder
+    size_t last_len_ = 0;         // last good datagram length (as emitted)
+
+    SeqStats stats_;
+    std::vector<ChunkSegment> segments_;
+    std::vector<PacketMeta> meta_;
+
+    enum class Verdict { PASS, LATE, DROP };
+
+    uint64_t decode(const uint8_t* p) const noexcept {
+        return decode_seq(p + opts_.seq_offset, opts_.seq_width, opts_.big_endian);
+    }
+
+    bool seen(uint64_t s) const noexcept {
+        return (seen_[(s % WINDOW) / 64] >> (s % 64)) & 1u;
+    }
+    void mark(uint64_t s, bool on) noexcept {
+        uint64_t& w = seen_[(s % WINDOW) / 64];
+        uint64_t bit = uint64_t(1) << (s % 64);
+        w = on ? (w | bit) : (w & ~bit);
+    }
+
+    void restart(uint64_t s) noexcept {
+        std::fill(seen_.begin(), seen_.end(), 0);
+        expected_ = s;
+        stats_.first_seq = started_ ? stats_.first_seq : s;
+        started_ = true;
+    }
+
+    // Classify one datagram; may schedule placeholders in front of it
+    Verdict track(uint64_t raw) {
+        ++stats_.received;
+
+        // The first datagram seeds the counter as is; unwrapping it against
+        // expected_ == 0 would send anything above half range negative
+        uint64_t s = raw;
+        if (!started_) {
+            restart(s);
+        } else {
+            s = unwrap_seq(raw, expected_, opts_.seq_width);
+        }
+
+        if (s >= expected_) {
+            uint64_t gap = s - expected_;
+            if (gap > opts_.resync_gap) {
+                ++stats_.resyncs;
+                restart(s);
+                gap = 0;
+            }
+            if (gap > 0) {
+                ++stats_.gaps;
+                stats_.lost += gap;
+                if (opts_.policy == GapPolicy::ZERO_FILL) {
+                    pending_fill_ = std::min(gap, opts_.max_fill);
+                    fill_seq_ = s - pending_fill_;
+                }
+            }
+            // Forget the history the window slides over
+            if (gap >= WINDOW) {
+                std::fill(seen_.begin(), seen_.end(), 0);
+            } else {
+                for (uint64_t k = expected_; k < s; ++k) {
+                    mark(k, false);
+                }
+            }
+            mark(s, true);
+            expected_ = s + 1;
+            stats_.last_seq = s;
+            return Verdict::PASS;
+        }
+
+        if (expected_ - s > WINDOW) {
+            // Far behind: sender restarted
+            ++stats_.resyncs;
+            restart(s);
+            mark(s, true);
+            expected_ = s + 1;
+            stats_.last_seq = s;
+            return Verdict::PASS;
+        }
+
+        if (seen(s)) {
+            ++stats_.duplicates;
+            return opts_.drop_duplicates ? Verdict::DROP : Verdict::PASS;
+        }
+        mark(s, true);
+        ++stats_.reordered;
+        if (stats_.lost) {
+            --stats_.lost;
+        }
+        if (opts_.policy == GapPolicy::ZERO_FILL) {
+            ++stats_.late_dropped;  // its placeholder was already delivered
+            return Verdict::DROP;
+        }
+        return Verdict::LATE;
+    }
+
+    bool refill_stage() {
+        size_t n = inner_.read_into(stage_.data());
+        const ChunkSegment* segs;
+        size_t cnt = inner_.get_segments(segs);
+        stage_segs_.clear();
+        stage_meta_.clear();
+        if (cnt > 0) {
+            stage_segs_.assign(segs, segs + cnt);
+            const PacketMeta* meta;
+            if (inner_.get_packet_meta(meta) == cnt) {
+                stage_meta_.assign(meta, meta + cnt);
+            }
+        } else if (n > 0) {
+            stage_segs_.push_back({0, n, 0});
+        }
+        stage_idx_ = 0;
+        cur_checked_ = false;
+        return n > 0;
+    }
+
+public:
+    // Inner built in place from inner_args (ReaderRef: reader pointer [, own])
+    template<class... A>
+    explicit BasicSeqTrackingReader(const SeqTrackerOpts& opts, A&&... inner_args)
+        : inner_(std::forward<A>(inner_args)...)
+        , opts_(opts)
+        , chunk_size_(inner_.get_chunk_size())
+        , seen_(WINDOW / 64, 0)
+    {
+        if (opts_.seq_width != 1 && opts_.seq_width != 2 && opts_.seq_width != 4 && opts_.seq_width != 8) {
+            throw std::runtime_error("[SeqTrackingReader] Sequence width must be 1, 2, 4 or 8 bytes");
+        }
+        hdr_len_ = opts_.seq_offset + opts_.seq_width;
+        seq_mask_ = (opts_.seq_width == 8) ? ~uint64_t(0) : ((uint64_t(1) << (8 * opts_.seq_width)) - 1);
+        if (opts_.seq_width < 8) {
+            opts_.resync_gap = std::min<uint64_t>(opts_.resync_gap, seq_mask_ >> 2);
+        }
+        stage_.resize(chunk_size_);
+    }
+
+    template<class I = Inner, std::enable_if_t<std::is_same<I, ReaderRef>::value, int> = 0>
+    BasicSeqTrackingReader(I_STREAM_READER* inner,
+                           const SeqTrackerOpts& opts = SeqTrackerOpts(),
+                           bool own_inner = false)
+        : BasicSeqTrackingReader(opts, inner, own_inner)
+    {
+    }
+
+    BasicSeqTrackingReader(const BasicSeqTrackingReader&) = delete;
+    BasicSeqTrackingReader& operator=(const BasicSeqTrackingReader&) = delete;
+
+    // Returns at most one inner chunk worth of datagrams plus placeholders;
+    // 0 only when the inner reader returned 0. Inner exceptions pass through.
+    size_t read_into(uint8_t* buff_ptr) override {
+        segments_.clear();
+        meta_.clear();
+        size_t pos = 0;
+        while (true) {
+            // Placeholders for lost datagrams go first
+            if (pending_fill_ > 0) {
+                size_t len = opts_.fill_size ? opts_.fill_size : last_len_;
+                len = std::min(len, chunk_size_);
+                if (len == 0) {
+                    pending_fill_ = 0;  // nothing to size them by
+                    continue;
+                }
+                if (pos + len > chunk_size_) {
+                    break;  // next chunk
+                }
+                std::memset(buff_ptr + pos, 0, len);
+                if (!opts_.strip_header && len >= hdr_len_) {
+                    // Write the missing sequence number so downstream sees a continuous stream
+                    uint8_t* q = buff_ptr + pos + opts_.seq_offset;
+                    uint64_t v = fill_seq_;
+                    for (size_t i = 0; i < opts_.seq_width; ++i) {
+                        size_t k = opts_.big_endian ? opts_.seq_width - 1 - i : i;
+                        q[k] = static_cast<uint8_t>(v & 0xFF);
+                        v >>= 8;
+                    }
+                }
+                segments_.push_back({pos, len, SEG_FILLED});
+                if (!stage_meta_.empty()) {
+                    PacketMeta m{};  // never received: no timestamp / source
+                    m.flags = SEG_FILLED;
+                    meta_.push_back(m);
+                }
+                pos += len;
+                ++fill_seq_;
+                ++stats_.filled;
+                --pending_fill_;
+                continue;
+            }
+
+            if (stage_idx_ >= stage_segs_.size()) {
+                if (pos > 0) {
+                    break;
+                }
+                if (!refill_stage()) {
+                    return 0;
+                }
+                continue;
+            }
+
+            const ChunkSegment& seg = stage_segs_[stage_idx_];
+            const uint8_t* src = stage_.data() + seg.offset;
+            uint32_t flags = seg.flags;
+
+            if (!cur_checked_) {
+                if (seg.length < hdr_len_) {
+                    ++stats_.runts;
+                    ++stage_idx_;
+                    continue;
+                }
+                Verdict v = track(decode(src));
+                if (v == Verdict::DROP) {
+                    ++stage_idx_;
+                    continue;
+                }
+                cur_checked_ = true;
+                stage_segs_[stage_idx_].flags |= (v == Verdict::LATE) ? SEG_REORDERED : 0;
+                if (pending_fill_ > 0) {
+                    continue;  // emit placeholders in front of this datagram
+                }
+                flags = stage_segs_[stage_idx_].flags;
+            }
+
+            size_t skip = opts_.strip_header ? hdr_len_ : 0;
+            size_t len = seg.length - skip;
+            if (pos + len > chunk_size_) {
+                break;  // only possible after placeholders; datagram leads the next chunk
+            }
+            std::memcpy(buff_ptr + pos, src + skip, len);
+            segments_.push_back({pos, len, flags});
+            if (!stage_meta_.empty()) {
+                PacketMeta m = stage_meta_[stage_idx_];
+                m.flags = flags;
+                meta_.push_back(m);
+            }
+            pos += len;
+            if (!(flags & SEG_TRUNCATED)) {
+                last_len_ = len;
+            }
+            ++stage_idx_;
+            cur_checked_ = false;
+        }
+        return pos;
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_size_; }
+
+    std::string get_type() const noexcept override {
+        return "seq(" + inner_.get_type() + ")";
+    }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = meta_.data();
+        return meta_.size();
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override { return inner_.get_stats(st); }
+
+    const SeqStats& get_seq_stats() const noexcept { return stats_; }
+
+    // Loss ratio over everything expected so far
+    double get_loss_ratio() const noexcept {
+        uint64_t expected = stats_.received - stats_.duplicates + stats_.lost;
+        return expected ? static_cast<double>(stats_.lost) / static_cast<double>(expected) : 0.0;
+    }
+
+    void reset_stats() noexcept { stats_ = SeqStats(); started_ = false; }
+
+    auto get_inner() noexcept { return inner_.get(); }
+    auto get_inner() const noexcept { return inner_.get(); }
+};
+
+// Runtime decorator over any I_STREAM_READER*
+using SeqTrackingReader = BasicSeqTrackingReader<ReaderRef>;
@@ -1,92 +1,11 @@
 // sock_reader.hpp
 #pragma once
 
-#include "stream_reader.hpp"
-#include <string>
-#include <cstring>
-#include <stdexcept>
-#include <iostream>
-
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <ws2tcpip.h>
-    #pragma comment(lib, "ws2_32.lib")
-    typedef int socklen_t;
-#else
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <arpa/inet.h>
-    #include <unistd.h>
-    #include <linux/if_packet.h>
-    #include <linux/if_ether.h>
-    #include <linux/ip.h>
-    #include <linux/udp.h>
-    #include <linux/filter.h>
-    #include <net/if.h>
-    #include <sys/ioctl.h>
-#endif
-
-// Socket receive buffer size
-constexpr int SOCKET_RCVBUF_SIZE = 4 * 1024 * 1024;  // 4 MiB
-
-// Exception types
-class ReadTimeout : public std::runtime_error {
-public:
-    explicit ReadTimeout(const std::string& msg) : std::runtime_error(msg) {}
-};
-
-class SocketError : public std::runtime_error {
-public:
-    explicit SocketError(const std::string& msg) : std::runtime_error(msg) {}
-};
-
-#ifdef _WIN32
-// Windows-specific: WSA initialization helper
-class WSAInitializer {
-public:
-    WSAInitializer() {
-        WSADATA wsa_data;
-        int result = WSAStartup(MAKEWORD(2, 2), &wsa_data);
-        if (result != 0) {
-            throw SocketError("WSAStartup failed: " + std::to_string(result));
-        }
-    }
-    
-    ~WSAInitializer() {
-        WSACleanup();
-    }
-    
-    // Singleton instance
-    static WSAInitializer& instance() {
-        static WSAInitializer inst;
-        return inst;
-    }
-};
-
-inline std::string get_last_socket_error() {
-    int err = WSAGetLastError();
-    return "WSA error " + std::to_string(err);
-}
-
-inline void close_socket(SOCKET sock) {
-    closesocket(sock);
-}
-
-constexpr SOCKET INVALID_SOCKET_FD = INVALID_SOCKET;
-
-#else
-
-inline std::string get_last_socket_error() {
-    return std::string(strerror(errno));
-}
-
-inline void close_socket(int sock) {
-    close(sock);
-}
-
-constexpr int INVALID_SOCKET_FD = -1;
-
-#endif
+#include "socket_common.hpp"
+#include "tpacket_reader.hpp"
+#include "pcap_live_reader.hpp"
+#include "xdp_reader.hpp"
+#include <chrono>
 
 // Template socket reader implementation
 template<bool IS_RAW>
@@ -103,10 +22,38 @@ private:
     std::string dev_;
     int32_t timeout_ms_;
     size_t chunk_size_;
+    int family_;  // UDP: AF_INET / AF_INET6, from ip
     
     // Temporary buffer for frame reading
     static constexpr size_t MAX_FRAME_SIZE = 65536;
     uint8_t frame_buffer_[MAX_FRAME_SIZE];
+
+    // Batched receive state (recvmmsg)
+    SocketReaderOpts opts_;
+    size_t slot_size_ = 0;  // payload bytes per datagram slot
+    std::vector<ChunkSegment> segments_;
+    std::vector<PacketMeta> meta_;  // parallel to segments_ when opts_.wants_meta()
+    uint64_t truncated_count_ = 0;  // datagrams cut to slot/chunk size
+    uint64_t bad_frame_count_ = 0;  // raw: runt / malformed frames skipped
+    ReaderCounters counters_;
+    mutable std::atomic<uint64_t> packet_drops_{0};  // raw: PACKET_STATISTICS accumulated by get_stats
+    std::unique_ptr<MulticastMembership> mcast_;  // raw: group join when ip is multicast
+    // Receive buffer: granted size (read back), and the rcvbuf_auto state
+    std::atomic<size_t> rcvbuf_{0};
+    std::atomic<uint64_t> rcvbuf_raises_{0};
+    size_t rcvbuf_req_ = 0;
+    uint64_t rcvbuf_drops_ = 0;
+    uint32_t rcvbuf_reads_ = 0;
+    bool rcvbuf_stuck_ = false;  // at rcvbuf_max / rmem_max, or no drop counter
+    std::chrono::steady_clock::time_point rcvbuf_checked_{};
+#ifndef _WIN32
+    size_t frame_slot_ = 0;             // raw: captured bytes per frame slot
+    std::vector<uint8_t> batch_frames_; // raw: frame staging for the batch
+    std::vector<struct mmsghdr> msgs_;
+    std::vector<struct iovec> iovs_;
+    std::vector<uint8_t> ctrl_;              // timestamp cmsgs per batch slot
+    std::vector<struct sockaddr_storage> names_;  // UDP source per batch slot
+#endif
     
     void setup_socket() {
 #ifdef _WIN32
@@ -119,16 +66,16 @@ private:
             // Raw sockets not supported on Windows
             throw SocketError("Raw sockets (IS_RAW=true) are not supported on Windows");
 #else
+            if (is_ipv6_address(ip_)) {
+                throw SocketError("Raw capture parses IPv4 only; use the UDP socket reader for " + ip_);
+            }
+            mcast_ = capture_membership(ip_, dev_, opts_);
             // Raw socket (AF_PACKET) - Linux only
             sock_fd_ = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
 #endif
         } else {
-            // Regular UDP socket
-#ifdef _WIN32
-            sock_fd_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-#else
-            sock_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
-#endif
+            // Regular UDP socket (IPv4 or IPv6)
+            sock_fd_ = socket(family_, SOCK_DGRAM, IPPROTO_UDP);
         }
         
         if (sock_fd_ == INVALID_SOCKET_FD) {
@@ -137,58 +84,98 @@ private:
     }
     
     void set_buffer_size() {
-#ifdef _WIN32
-        // Windows: use SO_RCVBUF directly
-        if (setsockopt(sock_fd_, SOL_SOCKET, SO_RCVBUF,
-                       (const char*)&SOCKET_RCVBUF_SIZE, sizeof(SOCKET_RCVBUF_SIZE)) == SOCKET_ERROR) {
-            std::cerr << "Warning: Failed to set socket receive buffer to " 
-                      << SOCKET_RCVBUF_SIZE << " bytes: " << get_last_socket_error() << "\n";
+        const native_handle_t fd = static_cast<native_handle_t>(sock_fd_);
+        if (opts_.rcvbuf == 0) {
+            rcvbuf_req_ = get_socket_rcvbuf(fd);
+            rcvbuf_.store(rcvbuf_req_, std::memory_order_relaxed);
+            return;
         }
-#else
-        // Linux: try SO_RCVBUFFORCE first, fallback to SO_RCVBUF
-        if (setsockopt(sock_fd_, SOL_SOCKET, SO_RCVBUFFORCE, 
-                       &SOCKET_RCVBUF_SIZE, sizeof(SOCKET_RCVBUF_SIZE)) == -1) {
-            if (setsockopt(sock_fd_, SOL_SOCKET, SO_RCVBUF,
-                           &SOCKET_RCVBUF_SIZE, sizeof(SOCKET_RCVBUF_SIZE)) == -1) {
-                std::cerr << "Warning: Failed to set socket receive buffer to " 
-                          << SOCKET_RCVBUF_SIZE << " bytes. "
-                          << "Using system default. Performance may be degraded.\n";
-            } else {
-                std::cerr << "Warning: SO_RCVBUFFORCE failed (CAP_NET_ADMIN required). "
-                          << "Buffer size limited by net.core.rmem_max.\n";
+        size_t granted = 0;
+        rcvbuf_req_ = opts_.rcvbuf;
+        if (!set_socket_rcvbuf(fd, opts_.rcvbuf, granted)) {
+            size_t rmem_max = read_rmem_max();
+            std::cerr << "Warning: Socket receive buffer is " << granted << " bytes, requested "
+                      << opts_.rcvbuf << " bytes"
+                      << (rmem_max ? " (net.core.rmem_max = " + std::to_string(rmem_max) +
+                                     ", SO_RCVBUFFORCE needs CAP_NET_ADMIN)" : std::string())
+                      << ". Bursts may overflow the queue.\n";
+        }
+        rcvbuf_.store(granted, std::memory_order_relaxed);
+    }
+
+    // Kernel drops so far (UDP: sk_drops; raw: PACKET_STATISTICS, accumulated)
+    bool read_kernel_drops(uint64_t& total) const noexcept {
+#ifndef _WIN32
+        uint64_t drops = 0;
+        if constexpr (IS_RAW) {
+            if (read_packet_drops(sock_fd_, drops)) {
+                total = packet_drops_.fetch_add(drops, std::memory_order_relaxed) + drops;
+                return true;
             }
+        } else if (read_socket_drops(sock_fd_, drops)) {
+            total = drops;
+            return true;
         }
 #endif
+        (void)total;
+        return false;
+    }
+
+    // rcvbuf_auto: every RCVBUF_CHECK_READS receives look at the clock; every
+    // RCVBUF_CHECK_MS check the drop counter and double the buffer if it grew
+    static constexpr uint32_t RCVBUF_CHECK_READS = 64;
+    static constexpr int RCVBUF_CHECK_MS = 100;
+
+    void tune_buffer_size() {
+        if (++rcvbuf_reads_ < RCVBUF_CHECK_READS) {
+            return;
+        }
+        rcvbuf_reads_ = 0;
+        auto now = std::chrono::steady_clock::now();
+        if (now - rcvbuf_checked_ < std::chrono::milliseconds(RCVBUF_CHECK_MS)) {
+            return;
+        }
+        rcvbuf_checked_ = now;
+        uint64_t drops = 0;
+        if (!read_kernel_drops(drops)) {
+            rcvbuf_stuck_ = true;  // no drop counter to steer by
+            return;
+        }
+        const bool grew = drops > rcvbuf_drops_;
+        rcvbuf_drops_ = drops;
+        if (!grew) {
+            return;
+        }
+        if (rcvbuf_req_ >= opts_.rcvbuf_max) {
+            rcvbuf_stuck_ = true;
+            return;
+        }
+        const size_t prev = rcvbuf_.load(std::memory_order_relaxed);
+        rcvbuf_req_ = std::min(std::max<size_t>(rcvbuf_req_, 64u << 10) * 2, opts_.rcvbuf_max);
+        size_t granted = 0;
+        set_socket_rcvbuf(static_cast<native_handle_t>(sock_fd_), rcvbuf_req_, granted);
+        if (granted <= prev) {
+            size_t rmem_max = read_rmem_max();
+            std::cerr << "Warning: Kernel drops continue but the socket receive buffer cannot grow past "
+                      << prev << " bytes"
+                      << (rmem_max ? " (net.core.rmem_max = " + std::to_string(rmem_max) +
+                                     ", SO_RCVBUFFORCE needs CAP_NET_ADMIN)" : std::string())
+                      << "\n";
+            rcvbuf_stuck_ = true;
+            return;
+        }
+        rcvbuf_.store(granted, std::memory_order_relaxed);
+        rcvbuf_raises_.store(rcvbuf_raises_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
     }
     
 void setup_bpf_filter() {
     if constexpr (IS_RAW) {
 #ifndef _WIN32
-        // BPF filter: IPv4 + UDP only (port filtering in userspace)
-        struct sock_filter bpf_code[] = {
-            // [0] EtherType == IPv4?
-            BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 12),
-            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0x0800, 0, 3),
-            
-            // [2] IP protocol == UDP?
-            BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 23),
-            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 0, 1),
-            
-            // [4] Accept
-            BPF_STMT(BPF_RET | BPF_K, 65535),
-            
-            // [5] Reject
-            BPF_STMT(BPF_RET | BPF_K, 0),
-        };
-        
-        struct sock_fprog bpf = {
-            .len = sizeof(bpf_code) / sizeof(bpf_code[0]),
-            .filter = bpf_code,
-        };
-        
-        if (setsockopt(sock_fd_, SOL_SOCKET, SO_ATTACH_FILTER, &bpf, sizeof(bpf)) == -1) {
+        try {
+            attach_udp_filter(sock_fd_, ip_, port_);
+        } catch (const SocketError&) {
             close_socket(sock_fd_);
-            throw SocketError("Failed to attach BPF filter: " + get_last_socket_error());
+            throw;
         }
 #endif
     }
@@ -230,26 +217,195 @@ void setup_bpf_filter() {
             }
 #endif
         } else {
-            // Bind by IP for regular socket (Windows + Linux)
-            struct sockaddr_in addr;
-            std::memset(&addr, 0, sizeof(addr));
-            addr.sin_family = AF_INET;
-            addr.sin_port = htons(port_);
-            
-            if (inet_pton(AF_INET, ip_.c_str(), &addr.sin_addr) != 1) {
+            // Bind by IP for regular socket (Windows + Linux).
+            // Multicast: Linux binds the group itself (only its datagrams on
+            // this port); Windows cannot bind a group address and takes any.
+            const bool mcast = is_multicast_address(ip_);
+#ifdef _WIN32
+            const std::string bind_ip = !mcast ? ip_ : family_ == AF_INET6 ? "::" : "0.0.0.0";
+#else
+            const std::string& bind_ip = ip_;
+#endif
+            struct sockaddr_storage addr;
+            socklen_t addr_len;
+            try {
+                addr_len = make_sockaddr(bind_ip, port_, addr);
+                if (mcast && family_ == AF_INET6) {
+                    // Link/site-scoped groups (ff02::, ff12::, ...) bind with a scope
+                    reinterpret_cast<struct sockaddr_in6&>(addr).sin6_scope_id = interface_index(dev_);
+                }
+            } catch (const SocketError&) {
+                close_socket(sock_fd_);
+                throw;
+            }
+            if (mcast) {
+                // Several receivers (processes) may share the group
+                int one = 1;
+                setsockopt(sock_fd_, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+            }
+            if (family_ == AF_INET6 && bind_ip == "::") {
+                // Dual stack: IPv4 senders arrive as ::ffff:a.b.c.d
+                int zero = 0;
+                setsockopt(sock_fd_, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<const char*>(&zero), sizeof(zero));
+            }
+
+            if (opts_.reuseport) {
+#ifdef _WIN32
                 close_socket(sock_fd_);
-                throw SocketError("Invalid IP address: " + ip_);
+                throw SocketError("SO_REUSEPORT groups are not supported on Windows");
+#else
+                try {
+                    enable_reuseport(sock_fd_);
+                } catch (const SocketError&) {
+                    close_socket(sock_fd_);
+                    throw;
+                }
+#endif
             }
             
-            if (bind(sock_fd_, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+            if (bind(sock_fd_, (struct sockaddr*)&addr, addr_len) == -1) {
                 close_socket(sock_fd_);
                 throw SocketError("Failed to bind socket to " + ip_ + ":" + 
                                   std::to_string(port_) + ": " + get_last_socket_error());
             }
+
+            if (mcast) {
+                try {
+                    join_multicast_group(static_cast<native_handle_t>(sock_fd_), ip_, dev_, opts_.mcast_sources);
+                } catch (const SocketError&) {
+                    close_socket(sock_fd_);
+                    throw;
+                }
+            }
         }
     }
     
+    // Socket group membership that needs a bound socket
+    void join_group() {
+#ifndef _WIN32
+        try {
+            if constexpr (IS_RAW) {
+                if (opts_.fanout_group) {
+                    join_fanout_group(sock_fd_, opts_);
+                }
+            } else {
+                enable_busy_poll(sock_fd_, opts_.busy_poll_us);  // AF_PACKET has no busy poll: busy_wait
+                if (opts_.reuseport) {
+                    attach_reuseport_balance(sock_fd_, opts_);
+                }
+            }
+        } catch (const SocketError&) {
+            close_socket(sock_fd_);
+            throw;
+        }
+#else
+        if (opts_.fanout_group) {
+            close_socket(sock_fd_);
+            throw SocketError("PACKET_FANOUT groups are not supported on Windows");
+        }
+#endif
+    }
+
+    void setup_meta() {
+        if (!opts_.wants_meta()) {
+            return;
+        }
+        meta_.reserve(opts_.batch > 1 ? opts_.batch : 1);
+#ifndef _WIN32
+        try {
+            enable_rx_timestamps(sock_fd_, opts_.timestamps, dev_);
+        } catch (const SocketError&) {
+            close_socket(sock_fd_);
+            throw;
+        }
+#endif
+    }
+
+    void setup_batch() {
+        segments_.reserve(opts_.batch > 1 ? opts_.batch : 1);
+#ifndef _WIN32
+        if (opts_.batch <= 1) {
+            return;
+        }
+        slot_size_ = opts_.max_dgram_size ? opts_.max_dgram_size : chunk_size_ / opts_.batch;
+        if (slot_size_ == 0 || slot_size_ > chunk_size_) {
+            slot_size_ = chunk_size_;
+        }
+        size_t n_slots = std::min(opts_.batch, chunk_size_ / slot_size_);
+
+        msgs_.assign(n_slots, {});
+        iovs_.assign(n_slots, {});
+        if (opts_.wants_meta()) {
+            ctrl_.assign(n_slots * RX_CMSG_SPACE, 0);
+            names_.assign(n_slots, {});
+        }
+        if constexpr (IS_RAW) {
+            // Room for Ethernet + max IPv4 + UDP headers in front of each payload
+            frame_slot_ = std::min(MAX_FRAME_SIZE, slot_size_ + ETH_HDR_LEN + 60 + 8);
+            batch_frames_.resize(n_slots * frame_slot_);
+        }
+        for (size_t i = 0; i < n_slots; ++i) {
+            if constexpr (IS_RAW) {
+                iovs_[i].iov_base = batch_frames_.data() + i * frame_slot_;
+                iovs_[i].iov_len = frame_slot_;
+            } else {
+                iovs_[i].iov_len = slot_size_;  // base set per call (caller's buffer)
+            }
+            msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+            if (!ctrl_.empty()) {
+                msgs_[i].msg_hdr.msg_control = ctrl_.data() + i * RX_CMSG_SPACE;
+                if constexpr (!IS_RAW) {
+                    msgs_[i].msg_hdr.msg_name = &names_[i];
+                }
+            }
+        }
+#endif
+    }
+
+#ifndef _WIN32
+    // One datagram; recvmsg (timestamp cmsg + source) only when metadata is wanted
+    ssize_t recv_one(void* buf, size_t len, int flags, PacketMeta& m) {
+        if (!opts_.wants_meta()) {
+            return recv(sock_fd_, buf, len, flags);
+        }
+        uint8_t ctrl[RX_CMSG_SPACE];
+        struct sockaddr_storage from;
+        struct iovec iov;
+        iov.iov_base = buf;
+        iov.iov_len = len;
+        struct msghdr mh;
+        std::memset(&mh, 0, sizeof(mh));
+        mh.msg_iov = &iov;
+        mh.msg_iovlen = 1;
+        mh.msg_control = ctrl;
+        mh.msg_controllen = sizeof(ctrl);
+        if constexpr (!IS_RAW) {
+            mh.msg_name = &from;
+            mh.msg_namelen = sizeof(from);
+        }
+        ssize_t rv = recvmsg(sock_fd_, &mh, flags);
+        if (rv >= 0) {
+            read_rx_timestamp(&mh, m);
+            if constexpr (!IS_RAW) {
+                sockaddr_source(from, m);
+            }
+        }
+        return rv;
+    }
+#endif
+
     void set_timeout() {
+        if (opts_.nonblocking || opts_.busy_wait) {
+            // read_into() waits in poll() / spins; no SO_RCVTIMEO needed
+            try {
+                set_socket_nonblocking(sock_fd_);
+            } catch (const SocketError&) {
+                close_socket(sock_fd_);
+                throw;
+            }
+            return;
+        }
         if (timeout_ms_ > 0) {
 #ifdef _WIN32
             // Windows uses milliseconds directly
@@ -278,19 +434,25 @@ public:
                      uint16_t port,
                      const std::string& dev,
                      int32_t timeout_ms,
-                     size_t chunk_size)
+                     size_t chunk_size,
+                     const SocketReaderOpts& opts = SocketReaderOpts())
         : sock_fd_(INVALID_SOCKET_FD)
         , ip_(ip)
         , port_(port)
         , dev_(dev)
         , timeout_ms_(timeout_ms)
         , chunk_size_(chunk_size)
+        , family_(is_ipv6_address(ip) ? AF_INET6 : AF_INET)
+        , opts_(opts)
     {
         setup_socket();
         set_buffer_size();
         setup_bpf_filter();
         bind_socket();
+        join_group();
         set_timeout();
+        setup_meta();
+        setup_batch();
     }
     
     ~SocketReaderImpl() {
@@ -316,79 +478,338 @@ public:
             return "SocketReader<UDP>";
         }
     }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = meta_.data();
+        return meta_.size();
+    }
+
+    // Datagrams delivered cut short (larger than chunk_size / batch slot)
+    uint64_t get_truncated_count() const noexcept {
+        return truncated_count_;
+    }
+
+    uint64_t get_bad_frame_count() const noexcept {
+        return bad_frame_count_;
+    }
+
+    // Receive buffer the kernel granted (SO_RCVBUF read back; Linux: twice the
+    // payload bytes it holds), current after rcvbuf_auto raises
+    size_t get_rcvbuf_size() const noexcept {
+        return rcvbuf_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t get_rcvbuf_raises() const noexcept {
+        return rcvbuf_raises_.load(std::memory_order_relaxed);
+    }
+
+    // CPU that processed the last received packet (SO_INCOMING_CPU), -1 if unknown;
+    // pin the consuming thread there or next to it
+    int get_incoming_cpu() const noexcept {
+        return socket_incoming_cpu(static_cast<native_handle_t>(sock_fd_));
+    }
+
+    // Datagrams pulled by one recvmmsg call (1 = batching disabled)
+    size_t get_batch_size() const noexcept {
+#ifndef _WIN32
+        return msgs_.empty() ? 1 : msgs_.size();
+#else
+        return 1;
+#endif
+    }
     
-    size_t read_into(uint8_t* buff) override {
+#ifndef _WIN32
+    // Fill buff with back-to-back payloads of up to msgs_.size() datagrams.
+    // UDP: datagrams land directly in caller's buffer slots, short ones are compacted.
+    // RAW: frames are staged per slot, payloads copied out after parsing.
+    ReadStatus read_batch(uint8_t* buff, size_t& rd) {
+        const size_t n_slots = msgs_.size();
+        while (true) {
+            if constexpr (!IS_RAW) {
+                for (size_t i = 0; i < n_slots; ++i) {
+                    iovs_[i].iov_base = buff + i * slot_size_;
+                }
+            }
+            const bool want_meta = !ctrl_.empty();
+            if (want_meta) {
+                // recvmmsg overwrites the lengths with what it returned
+                for (size_t i = 0; i < n_slots; ++i) {
+                    msgs_[i].msg_hdr.msg_controllen = RX_CMSG_SPACE;
+                    msgs_[i].msg_hdr.msg_namelen = IS_RAW ? 0 : sizeof(struct sockaddr_storage);
+                }
+            }
+
+            int n = recvmmsg(sock_fd_, msgs_.data(), static_cast<unsigned int>(n_slots),
+                             MSG_WAITFORONE, nullptr);
+            if (n == -1) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return idle(rd);
+                } else if (errno == EINTR) {
+                    return interrupted(rd);
+                } else {
+                    throw SocketError("recvmmsg() failed: " + get_last_socket_error());
+                }
+            }
+
+            segments_.clear();
+            meta_.clear();
+            size_t pos = 0;
+            for (int i = 0; i < n; ++i) {
+                size_t len = msgs_[i].msg_len;
+                uint32_t flags = (msgs_[i].msg_hdr.msg_flags & MSG_TRUNC) ? SEG_TRUNCATED : 0;
+                PacketMeta m{};
+
+                if constexpr (IS_RAW) {
+                    const uint8_t* payload;
+                    size_t payload_len;
+                    FrameStatus st = parse_udp_frame(batch_frames_.data() + i * frame_slot_, len, port_,
+                                                     payload, payload_len);
+                    if (st != FrameStatus::OK) {
+                        bad_frame_count_ += st != FrameStatus::WRONG_PORT;
+                        count_rejected_frame(counters_, st);
+                        continue;  // runt or foreign frame: drop within the batch
+                    }
+                    if (payload_len > slot_size_) {
+                        payload_len = slot_size_;
+                        flags |= SEG_TRUNCATED;
+                    }
+                    std::memcpy(buff + pos, payload, payload_len);
+                    len = payload_len;
+                    if (want_meta) {
+                        udp_frame_source(batch_frames_.data() + i * frame_slot_, payload, m);
+                    }
+                } else {
+                    uint8_t* slot = buff + i * slot_size_;
+                    if (slot != buff + pos) {
+                        std::memmove(buff + pos, slot, len);
+                    }
+                    if (want_meta) {
+                        sockaddr_source(names_[i], m);
+                    }
+                }
+                if (flags & SEG_TRUNCATED) {
+                    ++truncated_count_;
+                }
+                segments_.push_back({pos, len, flags});
+                if (want_meta) {
+                    read_rx_timestamp(&msgs_[i].msg_hdr, m);
+                    m.flags = flags;
+                    meta_.push_back(m);
+                }
+                pos += len;
+            }
+
+            if (!segments_.empty()) {
+                rd = pos;
+                return ReadStatus::OK;
+            }
+            // Whole batch filtered out - receive again
+        }
+    }
+#endif
+
+private:
+    // No datagram queued: WOULD_BLOCK (non-blocking) or TIMEOUT (SO_RCVTIMEO)
+    ReadStatus idle(size_t& rd) noexcept {
+        segments_.clear();
+        meta_.clear();
+        rd = 0;
+        return opts_.nonblocking || opts_.busy_wait ? ReadStatus::WOULD_BLOCK : ReadStatus::TIMEOUT;
+    }
+
+    ReadStatus interrupted(size_t& rd) noexcept {
+        segments_.clear();
+        meta_.clear();
+        rd = 0;
+        return ReadStatus::INTERRUPTED;  // Ctrl+C
+    }
+
+    ReadStatus receive(uint8_t* buff, size_t& rd) {
+#ifndef _WIN32
+        if (!msgs_.empty()) {
+            return read_batch(buff, rd);
+        }
+#endif
         while (true) {  // ← Loop until correct port packet
             ssize_t recv_bytes;
+            PacketMeta m{};
             
             if constexpr (IS_RAW) {
     #ifndef _WIN32
                 // Raw socket: receive full Ethernet frame
-                recv_bytes = recvfrom(sock_fd_, frame_buffer_, MAX_FRAME_SIZE, 0, nullptr, nullptr);
+                recv_bytes = recv_one(frame_buffer_, MAX_FRAME_SIZE, 0, m);
                 
                 if (recv_bytes == -1) {
                     if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                        throw ReadTimeout("Socket receive timeout expired");
+                        return idle(rd);
                     } else if (errno == EINTR) {
-                        return 0;  // Interrupted (Ctrl+C)
+                        return interrupted(rd);
                     } else {
                         throw SocketError("recvfrom() failed: " + get_last_socket_error());
                     }
                 }
                 
                 // Parse Ethernet frame
-                if (static_cast<size_t>(recv_bytes) < 14 + 20 + 8) {
-                    throw SocketError("Received frame too small for UDP packet");
-                }
-                
-                // Skip Ethernet header (14 bytes)
-                uint8_t* ip_header = frame_buffer_ + 14;
-                
-                // Get IP header length (IHL field)
-                uint8_t ip_header_len = (ip_header[0] & 0x0F) * 4;
-                
-                if (ip_header_len < 20) {
-                    throw SocketError("Invalid IP header length: " + std::to_string(ip_header_len));
-                }
-                
-                // UDP header at: ip_header + ip_header_len
-                uint8_t* udp_header = ip_header + ip_header_len;
-                
-                // ====== USERSPACE PORT CHECK ======
-                // UDP header: [0-1] src port, [2-3] dest port
-                uint16_t udp_dest_port = (udp_header[2] << 8) | udp_header[3];  // Big-endian
-                
-                if (udp_dest_port != port_) {
-                    // Wrong port - skip this packet and read next
+                const uint8_t* udp_payload;
+                size_t payload_len;
+                FrameStatus st = parse_udp_frame(frame_buffer_, static_cast<size_t>(recv_bytes),
+                                                 port_, udp_payload, payload_len);
+                if (st != FrameStatus::OK) {
+                    // Runt / bad IHL / wrong port - skip this frame and read next
+                    bad_frame_count_ += st != FrameStatus::WRONG_PORT;
+                    count_rejected_frame(counters_, st);
                     continue;  // ← Loop back to recvfrom
                 }
-                // ==================================
-                
-                // Skip UDP header (8 bytes)
-                uint8_t* udp_payload = udp_header + 8;
-                
-                // Calculate payload size
-                size_t total_headers = 14 + ip_header_len + 8;
-                if (static_cast<size_t>(recv_bytes) < total_headers) {
-                    throw SocketError("Frame size mismatch in header parsing");
+
+                // Copy UDP payload to caller's buffer (never beyond chunk_size_)
+                uint32_t flags = 0;
+                if (payload_len > chunk_size_) {
+                    payload_len = chunk_size_;
+                    flags = SEG_TRUNCATED;
+                    ++truncated_count_;
                 }
-                
-                size_t payload_len = recv_bytes - total_headers;
-                
-                // Copy UDP payload to caller's buffer
                 std::memcpy(buff, udp_payload, payload_len);
-                return payload_len;  // ← Exit loop with correct packet
+                segments_.assign(1, {0, payload_len, flags});
+                if (opts_.wants_meta()) {
+                    udp_frame_source(frame_buffer_, udp_payload, m);
+                    m.flags = flags;
+                    meta_.assign(1, m);
+                }
+                rd = payload_len;
+                return ReadStatus::OK;  // ← Exit loop with correct packet
     #else
                 throw SocketError("Raw socket not supported on Windows");
     #endif
                 
             } else {
-                // Regular UDP socket branch (unchanged)
-                // ...
+                // Regular UDP socket: datagram lands directly in caller's buffer
+                uint32_t flags = 0;
+#ifdef _WIN32
+                struct sockaddr_storage from;
+                int from_len = sizeof(from);
+                int rv = opts_.wants_meta()
+                    ? recvfrom(sock_fd_, reinterpret_cast<char*>(buff), static_cast<int>(chunk_size_), 0,
+                               reinterpret_cast<struct sockaddr*>(&from), &from_len)
+                    : recv(sock_fd_, reinterpret_cast<char*>(buff), static_cast<int>(chunk_size_), 0);
+                if (rv == SOCKET_ERROR) {
+                    int err = WSAGetLastError();
+                    if (err == WSAEMSGSIZE) {
+                        rv = static_cast<int>(chunk_size_);  // buffer filled, tail discarded
+                        flags = SEG_TRUNCATED;
+                    } else if (err == WSAETIMEDOUT || err == WSAEWOULDBLOCK) {
+                        return idle(rd);
+                    } else if (err == WSAEINTR) {
+                        return interrupted(rd);
+                    } else {
+                        throw SocketError("recv() failed: " + get_last_socket_error());
+                    }
+                }
+                size_t len = static_cast<size_t>(rv);
+                if (opts_.wants_meta()) {
+                    sockaddr_source(from, m);  // no receive timestamps on Windows
+                }
+#else
+                // MSG_TRUNC: returns real datagram length even if it did not fit
+                recv_bytes = recv_one(buff, chunk_size_, MSG_TRUNC, m);
+
+                if (recv_bytes == -1) {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        return idle(rd);
+                    } else if (errno == EINTR) {
+                        return interrupted(rd);
+                    } else {
+                        throw SocketError("recv() failed: " + get_last_socket_error());
+                    }
+                }
+
+                size_t len = static_cast<size_t>(recv_bytes);
+                if (len > chunk_size_) {
+                    len = chunk_size_;
+                    flags = SEG_TRUNCATED;
+                }
+#endif
+                if (flags & SEG_TRUNCATED) {
+                    ++truncated_count_;
+                }
+                segments_.assign(1, {0, len, flags});
+                if (opts_.wants_meta()) {
+                    m.flags = flags;
+                    meta_.assign(1, m);
+                }
+                rd = len;
+                return ReadStatus::OK;
             }
         }  // ← End of while(true) loop
     }
 
+public:
+    size_t read_into(uint8_t* buff) override {
+        return counters_.timed_read(*this, [&]() {
+            size_t rd;
+            std::chrono::steady_clock::time_point deadline{};
+            while (true) {
+                ReadStatus st = receive(buff, rd);
+                if (st == ReadStatus::OK && opts_.rcvbuf_auto && !rcvbuf_stuck_) {
+                    tune_buffer_size();
+                }
+                if (st == ReadStatus::OK || st == ReadStatus::INTERRUPTED) {
+                    return rd;  // 0: Interrupted (Ctrl+C)
+                }
+                if (st == ReadStatus::WOULD_BLOCK && opts_.busy_wait) {
+                    // Busy wait: poll the queue again instead of sleeping
+                    auto now = std::chrono::steady_clock::now();
+                    if (deadline == std::chrono::steady_clock::time_point{}) {
+                        deadline = now + std::chrono::milliseconds(timeout_ms_);
+                    }
+                    if (timeout_ms_ <= 0 || now < deadline) {
+                        spin_pause();
+                        continue;
+                    }
+                } else if (st == ReadStatus::WOULD_BLOCK) {
+                    // Non-blocking socket: wait here with the reader's timeout
+                    int rc = wait_socket_readable(sock_fd_, timeout_ms_);
+                    if (rc > 0) {
+                        continue;
+                    }
+                    if (rc < 0) {
+                        return size_t(0);  // Interrupted (Ctrl+C)
+                    }
+                }
+                throw ReadTimeout("Socket receive timeout expired");
+            }
+        });
+    }
+
+    ReadResult try_read_into(uint8_t* buff) override {
+        return counters_.timed_try_read(*this, [&]() {
+            size_t rd = 0;
+            ReadStatus st = receive(buff, rd);
+            if (st == ReadStatus::OK && opts_.rcvbuf_auto && !rcvbuf_stuck_) {
+                tune_buffer_size();
+            }
+            return ReadResult{st, rd};
+        });
+    }
+
+    native_handle_t get_native_handle() const noexcept override {
+        return static_cast<native_handle_t>(sock_fd_);
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override {
+        if (!ReaderCounters::enabled) {
+            return false;
+        }
+        counters_.snapshot(st);
+        st.kernel_drops_valid = read_kernel_drops(st.kernel_drops);
+        st.rcvbuf_bytes = rcvbuf_.load(std::memory_order_relaxed);
+        st.rcvbuf_raises = rcvbuf_raises_.load(std::memory_order_relaxed);
+        return true;
+    }
 };
 
 // Wrapper function for factory
@@ -398,11 +819,51 @@ inline I_STREAM_READER* create_socket_reader(
     const std::string& dev,
     int32_t timeout_ms,
     size_t chunk_size,
-    bool is_raw)
+    bool is_raw,
+    const SocketReaderOpts& opts = SocketReaderOpts())
 {
+    if (is_raw && is_ipv6_address(ip)) {
+        throw SocketError("Capture engines parse IPv4 only; use the UDP socket reader (is_raw=false) for " + ip);
+    }
+#if defined(_WIN32) && defined(DATASTREAM_HAS_PCAP)
+    // No raw sockets on Windows: raw capture goes through Npcap
+    if (is_raw && opts.engine == SocketEngine::RECV) {
+        return new PcapLiveReader(ip, port, dev, timeout_ms, chunk_size, opts);
+    }
+#endif
+    if (opts.engine == SocketEngine::PCAP) {
+        if (!is_raw) {
+            throw SocketError("PCAP engine requires a raw socket reader (is_raw=true)");
+        }
+#ifdef DATASTREAM_HAS_PCAP
+        return new PcapLiveReader(ip, port, dev, timeout_ms, chunk_size, opts);
+#else
+        throw SocketError("PCAP engine not available: built without libpcap / Npcap (DATASTREAM_HAS_PCAP)");
+#endif
+    }
+    if (opts.engine == SocketEngine::TPACKET) {
+        if (!is_raw) {
+            throw SocketError("TPACKET engine requires a raw socket reader (is_raw=true)");
+        }
+#ifdef _WIN32
+        throw SocketError("TPACKET engine is not supported on Windows");
+#else
+        return new TpacketReader(ip, port, dev, timeout_ms, chunk_size, opts);
+#endif
+    }
+    if (opts.engine == SocketEngine::XDP) {
+        if (!is_raw) {
+            throw SocketError("XDP engine requires a raw socket reader (is_raw=true)");
+        }
+#ifdef _WIN32
+        throw SocketError("XDP engine is not supported on Windows");
+#else
+        return new XdpReader(ip, port, dev, timeout_ms, chunk_size, opts);
+#endif
+    }
     if (is_raw) {
-        return new SocketReaderImpl<true>(ip, port, dev, timeout_ms, chunk_size);
+        return new SocketReaderImpl<true>(ip, port, dev, timeout_ms, chunk_size, opts);
     } else {
-        return new SocketReaderImpl<false>(ip, port, dev, timeout_ms, chunk_size);
+        return new SocketReaderImpl<false>(ip, port, dev, timeout_ms, chunk_size, opts);
     }
 }
\ No newline at end of file
@@ -0,0 +1,764 @@
+// socket_common.hpp
+#pragma once
+
+#include "stream_reader.hpp"
+#include "reader_stats.hpp"
+#include "cpu_placement.hpp"
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+    typedef int socklen_t;
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+    #include <linux/if_packet.h>
+    #include <linux/if_ether.h>
+    #include <linux/ip.h>
+    #include <linux/udp.h>
+    #include <linux/filter.h>
+    #include <net/if.h>
+    #include <sys/ioctl.h>
+    #include <linux/net_tstamp.h>
+    #include <linux/sockios.h>
+    #include <linux/sock_diag.h>
+    #include <poll.h>
+    #include <fcntl.h>
+    #include <time.h>
+#endif
+
+// Socket receive buffer size (SocketReaderOpts::rcvbuf default)
+constexpr int SOCKET_RCVBUF_SIZE = 4 * 1024 * 1024;  // 4 MiB
+
+// Receive engine behind create_socket_reader()
+enum class SocketEngine {
+    RECV,     // recv/recvmmsg syscalls (regular or raw socket)
+    TPACKET,  // PACKET_MMAP TPACKET_V3 RX ring (raw only, Linux)
+    PCAP,     // libpcap / Npcap live capture (raw only, needs DATASTREAM_HAS_PCAP)
+    XDP,      // AF_XDP socket + XDP redirect program, UMEM from a ChunkPool (Linux)
+};
+
+// AF_XDP attach / copy mode
+enum class XdpMode {
+    AUTO,      // driver mode + zero-copy, falling back to copy, then generic (SKB) mode
+    ZEROCOPY,  // driver mode, zero-copy only (fails if unsupported)
+    COPY,      // driver mode, kernel copies into UMEM
+    GENERIC,   // SKB mode, works on any device (lo, veth), slowest
+};
+
+// How a multi-socket group spreads datagrams (Linux)
+enum class QueueBalance {
+    HASH,         // kernel flow hash (one flow -> one socket)
+    ROUND_ROBIN,  // fanout: PACKET_FANOUT_LB; reuseport: random pick
+    CPU,          // socket of the CPU that received the packet (follows RSS/RPS)
+    SEQ,          // payload byte balance_byte (low byte of the sequence number) mod queue_count
+};
+
+// Receive timestamp collection (Linux; Windows readers leave ts_source NONE)
+enum class TimestampMode {
+    NONE,
+    SOFTWARE,  // kernel timestamp at receive (SO_TIMESTAMPNS / ring default)
+    HARDWARE,  // NIC timestamp (SO_TIMESTAMPING / PACKET_TIMESTAMP), software as fallback
+};
+
+// Optional socket reader tuning
+struct SocketReaderOpts {
+    size_t batch = 1;           // datagrams per syscall (recvmmsg, Linux), 1 = single recv
+    size_t max_dgram_size = 0;  // batch slot size in bytes, 0 = chunk_size / batch
+
+    SocketEngine engine = SocketEngine::RECV;
+    // TPACKET_V3 ring geometry
+    uint32_t ring_block_size = 1u << 20;  // bytes per block (multiple of page size)
+    uint32_t ring_block_count = 32;
+    uint32_t ring_frame_size = 2048;      // nominal frame size (V3 packs variable frames)
+    uint32_t ring_block_tov_ms = 4;       // block retire timeout
+    // libpcap / Npcap handle
+    size_t pcap_buffer_size = 64u << 20;  // capture buffer (kernel ring / driver buffer)
+    size_t pcap_snaplen = 65535;
+    bool pcap_promisc = false;
+    // AF_XDP socket and UMEM
+    uint32_t xdp_queue = 0;               // NIC RX queue the socket binds to (steer the flow there)
+    uint32_t xdp_frame_size = 4096;       // UMEM frame (2048 or 4096), one datagram per frame
+    uint32_t xdp_frame_count = 8192;      // UMEM frames
+    uint32_t xdp_ring_size = 4096;        // fill / RX ring entries (power of two)
+    XdpMode xdp_mode = XdpMode::AUTO;
+
+    // Socket groups (Linux, see multi_queue_reader.hpp)
+    bool reuseport = false;         // UDP: join the SO_REUSEPORT group on ip:port
+    uint16_t fanout_group = 0;      // raw: PACKET_FANOUT group id, 0 = no fanout
+    QueueBalance balance = QueueBalance::HASH;
+    uint32_t queue_count = 1;       // sockets in the group (CPU / SEQ balance)
+    uint32_t balance_byte = 0;      // SEQ: payload byte offset
+
+    // Per-datagram metadata (get_packet_meta), gathered in the receive call itself
+    bool packet_meta = false;       // source address + flags; implied by timestamps != NONE
+    TimestampMode timestamps = TimestampMode::NONE;
+
+    // O_NONBLOCK socket: try_read_into() returns WOULD_BLOCK instead of
+    // waiting, get_native_handle() goes into epoll / ReaderEventLoop;
+    // read_into() still waits up to timeout_ms (poll)
+    bool nonblocking = false;
+
+    // Latency and memory placement (Linux, see cpu_placement.hpp)
+    uint32_t busy_poll_us = 0;      // SO_BUSY_POLL: receive spins in the driver this long before sleeping
+                                    // (above net.core.busy_read needs CAP_NET_ADMIN)
+    bool busy_wait = false;         // read_into() never sleeps: spins on non-blocking receive / ring
+                                    // checks until data or timeout_ms (one core per reader)
+    int numa_node = -1;             // TPACKET ring, XDP UMEM and rings on this node, NUMA_NIC_NODE = dev's
+
+    // Kernel receive queue of the UDP / raw recv socket (TPACKET and XDP
+    // queue in their rings, pcap in pcap_buffer_size). Without CAP_NET_ADMIN
+    // the kernel caps it at net.core.rmem_max; the granted size is read back
+    // (get_rcvbuf_size, ReaderStats::rcvbuf_bytes).
+    size_t rcvbuf = SOCKET_RCVBUF_SIZE;  // requested bytes, 0 = system default
+    bool rcvbuf_auto = false;            // double it while the kernel drop counter grows (checked every ~100 ms)
+    size_t rcvbuf_max = 256u << 20;      // rcvbuf_auto ceiling
+
+    // Multicast: a group address (224.0.0.0/4, ff00::/8) as ip is joined on
+    // dev (interface name or index, "" = routing table's choice).
+    // Source-specific join (SSM) per entry; empty = any-source join.
+    std::vector<std::string> mcast_sources;
+
+    bool wants_meta() const noexcept { return packet_meta || timestamps != TimestampMode::NONE; }
+};
+
+// Exception types (ReadTimeout: stream_reader.hpp)
+class SocketError : public std::runtime_error {
+public:
+    explicit SocketError(const std::string& msg) : std::runtime_error(msg) {}
+};
+
+#ifdef _WIN32
+// Windows-specific: WSA initialization helper
+class WSAInitializer {
+public:
+    WSAInitializer() {
+        WSADATA wsa_data;
+        int result = WSAStartup(MAKEWORD(2, 2), &wsa_data);
+        if (result != 0) {
+            throw SocketError("WSAStartup failed: " + std::to_string(result));
+        }
+    }
+    
+    ~WSAInitializer() {
+        WSACleanup();
+    }
+    
+    // Singleton instance
+    static WSAInitializer& instance() {
+        static WSAInitializer inst;
+        return inst;
+    }
+};
+
+inline std::string get_last_socket_error() {
+    int err = WSAGetLastError();
+    return "WSA error " + std::to_string(err);
+}
+
+inline void close_socket(SOCKET sock) {
+    closesocket(sock);
+}
+
+constexpr SOCKET INVALID_SOCKET_FD = INVALID_SOCKET;
+
+inline void set_socket_nonblocking(SOCKET sock) {
+    u_long on = 1;
+    if (ioctlsocket(sock, FIONBIO, &on) == SOCKET_ERROR) {
+        throw SocketError("Failed to set non-blocking mode: " + get_last_socket_error());
+    }
+}
+
+// 1 - readable, 0 - timeout, -1 - interrupted; timeout_ms <= 0 waits forever
+inline int wait_socket_readable(SOCKET sock, int32_t timeout_ms) {
+    WSAPOLLFD pfd;
+    pfd.fd = sock;
+    pfd.events = POLLRDNORM;
+    pfd.revents = 0;
+    int rc = WSAPoll(&pfd, 1, timeout_ms > 0 ? timeout_ms : -1);
+    if (rc == SOCKET_ERROR) {
+        if (WSAGetLastError() == WSAEINTR) {
+            return -1;
+        }
+        throw SocketError("WSAPoll() failed: " + get_last_socket_error());
+    }
+    return rc > 0 ? 1 : 0;
+}
+
+#else
+
+inline std::string get_last_socket_error() {
+    return std::string(strerror(errno));
+}
+
+inline void close_socket(int sock) {
+    close(sock);
+}
+
+constexpr int INVALID_SOCKET_FD = -1;
+
+inline void set_socket_nonblocking(int fd) {
+    int fl = fcntl(fd, F_GETFL, 0);
+    if (fl == -1 || fcntl(fd, F_SETFL, fl | O_NONBLOCK) == -1) {
+        throw SocketError("Failed to set non-blocking mode: " + get_last_socket_error());
+    }
+}
+
+// 1 - readable, 0 - timeout, -1 - interrupted; timeout_ms <= 0 waits forever
+inline int wait_socket_readable(int fd, int32_t timeout_ms) {
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int rc = poll(&pfd, 1, timeout_ms > 0 ? timeout_ms : -1);
+    if (rc == -1) {
+        if (errno == EINTR) {
+            return -1;
+        }
+        throw SocketError("poll() failed: " + get_last_socket_error());
+    }
+    return rc > 0 ? 1 : 0;
+}
+
+// Datagrams the kernel dropped on a full receive queue (sk_drops, the
+// counter SO_RXQ_OVFL reports per message), read without any cmsg cost
+inline bool read_socket_drops(int fd, uint64_t& drops) noexcept {
+    uint32_t mem[SK_MEMINFO_VARS] = {};
+    socklen_t len = sizeof(mem);
+    if (getsockopt(fd, SOL_SOCKET, SO_MEMINFO, mem, &len) != 0 || len <= SK_MEMINFO_DROPS * sizeof(uint32_t)) {
+        return false;
+    }
+    drops = mem[SK_MEMINFO_DROPS];
+    return true;
+}
+
+// AF_PACKET drops since the previous call (PACKET_STATISTICS resets on read)
+inline bool read_packet_drops(int fd, uint64_t& delta) noexcept {
+    struct tpacket_stats_v3 st;
+    std::memset(&st, 0, sizeof(st));
+    socklen_t len = sizeof(st);
+    if (getsockopt(fd, SOL_PACKET, PACKET_STATISTICS, &st, &len) != 0) {
+        return false;
+    }
+    delta = st.tp_drops;
+    return true;
+}
+
+#endif
+
+// Receive buffer the kernel granted (SO_RCVBUF read back), 0 if unknown.
+// Linux reports twice the requested bytes: the skb bookkeeping share.
+inline size_t get_socket_rcvbuf(native_handle_t fd) noexcept {
+    int v = 0;
+    socklen_t len = sizeof(v);
+    if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<char*>(&v), &len) != 0 || v < 0) {
+        return 0;
+    }
+    return static_cast<size_t>(v);
+}
+
+// net.core.rmem_max, the SO_RCVBUF ceiling without CAP_NET_ADMIN; 0 if unknown
+inline size_t read_rmem_max() {
+#ifdef _WIN32
+    return 0;
+#else
+    std::string s = cpu_detail::read_sysfs("/proc/sys/net/core/rmem_max");
+    return s.empty() ? 0 : static_cast<size_t>(std::strtoull(s.c_str(), nullptr, 10));
+#endif
+}
+
+// Ask for bytes of receive buffer; granted is what the kernel actually set.
+// Linux: SO_RCVBUFFORCE (CAP_NET_ADMIN) goes past rmem_max, else SO_RCVBUF
+// is capped there. Returns false if less than requested was granted.
+inline bool set_socket_rcvbuf(native_handle_t fd, size_t bytes, size_t& granted) noexcept {
+    const int v = static_cast<int>(std::min<size_t>(bytes, 1u << 30));
+#ifdef _WIN32
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&v), sizeof(v));
+    granted = get_socket_rcvbuf(fd);
+    return granted >= static_cast<size_t>(v);
+#else
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &v, sizeof(v)) != 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &v, sizeof(v));
+    }
+    granted = get_socket_rcvbuf(fd);
+    return granted >= 2 * static_cast<size_t>(v);
+#endif
+}
+
+// IPv6 literal ("ff02::1", "::"); anything else is taken as IPv4
+inline bool is_ipv6_address(const std::string& ip) noexcept {
+    return ip.find(':') != std::string::npos;
+}
+
+inline bool is_multicast_address(const std::string& ip) noexcept {
+    if (is_ipv6_address(ip)) {
+        struct in6_addr a;
+        return inet_pton(AF_INET6, ip.c_str(), &a) == 1 && a.s6_addr[0] == 0xFF;
+    }
+    struct in_addr a;
+    return inet_pton(AF_INET, ip.c_str(), &a) == 1 && (ntohl(a.s_addr) >> 28) == 0xE;
+}
+
+// ip:port as a socket address of the matching family; returns its length
+inline socklen_t make_sockaddr(const std::string& ip, uint16_t port, struct sockaddr_storage& ss) {
+    std::memset(&ss, 0, sizeof(ss));
+    if (is_ipv6_address(ip)) {
+        struct sockaddr_in6* a = reinterpret_cast<struct sockaddr_in6*>(&ss);
+        a->sin6_family = AF_INET6;
+        a->sin6_port = htons(port);
+        if (inet_pton(AF_INET6, ip.c_str(), &a->sin6_addr) != 1) {
+            throw SocketError("Invalid IP address: " + ip);
+        }
+        return static_cast<socklen_t>(sizeof(*a));
+    }
+    struct sockaddr_in* a = reinterpret_cast<struct sockaddr_in*>(&ss);
+    a->sin_family = AF_INET;
+    a->sin_port = htons(port);
+    if (inet_pton(AF_INET, ip.c_str(), &a->sin_addr) != 1) {
+        throw SocketError("Invalid IP address: " + ip);
+    }
+    return static_cast<socklen_t>(sizeof(*a));
+}
+
+// Sender of a received datagram into meta; IPv4-mapped IPv6 sources
+// (dual-stack socket) are reported as IPv4
+inline void sockaddr_source(const struct sockaddr_storage& ss, PacketMeta& meta) noexcept {
+    if (ss.ss_family == AF_INET6) {
+        const struct sockaddr_in6* a = reinterpret_cast<const struct sockaddr_in6*>(&ss);
+        const uint8_t* b = a->sin6_addr.s6_addr;
+        static const uint8_t V4_MAPPED[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+        meta.src_port = ntohs(a->sin6_port);
+        if (std::memcmp(b, V4_MAPPED, sizeof(V4_MAPPED)) == 0) {
+            meta.src_ip = (uint32_t(b[12]) << 24) | (uint32_t(b[13]) << 16) | (uint32_t(b[14]) << 8) | b[15];
+        } else {
+            meta.src_ip = 0;
+            std::memcpy(meta.src_ip6, b, 16);
+        }
+    } else if (ss.ss_family == AF_INET) {
+        const struct sockaddr_in* a = reinterpret_cast<const struct sockaddr_in*>(&ss);
+        meta.src_ip = ntohl(a->sin_addr.s_addr);
+        meta.src_port = ntohs(a->sin_port);
+    }
+}
+
+// Interface index for multicast joins: name (Linux) or number, "" = 0 (any)
+inline uint32_t interface_index(const std::string& dev) {
+    if (dev.empty()) {
+        return 0;
+    }
+    char* end = nullptr;
+    unsigned long n = std::strtoul(dev.c_str(), &end, 10);
+    if (*end == '\0') {
+        return static_cast<uint32_t>(n);
+    }
+#ifdef _WIN32
+    throw SocketError("Multicast interface must be given by index on Windows, got '" + dev + "'");
+#else
+    unsigned idx = if_nametoindex(dev.c_str());
+    if (idx == 0) {
+        throw SocketError("Unknown interface " + dev + ": " + get_last_socket_error());
+    }
+    return idx;
+#endif
+}
+
+// Join group on interface dev: any-source (MCAST_JOIN_GROUP), or one
+// source-specific join (MCAST_JOIN_SOURCE_GROUP) per entry of sources
+inline void join_multicast_group(native_handle_t fd, const std::string& group, const std::string& dev,
+                                 const std::vector<std::string>& sources) {
+    struct sockaddr_storage g;
+    make_sockaddr(group, 0, g);
+    const int level = g.ss_family == AF_INET6 ? IPPROTO_IPV6 : IPPROTO_IP;
+    const uint32_t ifindex = interface_index(dev);
+    const std::string where = group + (dev.empty() ? "" : " on " + dev);
+
+    if (sources.empty()) {
+        struct group_req req;
+        std::memset(&req, 0, sizeof(req));
+        req.gr_interface = ifindex;
+        std::memcpy(&req.gr_group, &g, sizeof(g));
+        if (setsockopt(fd, level, MCAST_JOIN_GROUP, reinterpret_cast<const char*>(&req), sizeof(req)) != 0) {
+            throw SocketError("Failed to join multicast group " + where + ": " + get_last_socket_error());
+        }
+    }
+    for (const std::string& src : sources) {
+        struct group_source_req req;
+        std::memset(&req, 0, sizeof(req));
+        req.gsr_interface = ifindex;
+        std::memcpy(&req.gsr_group, &g, sizeof(g));
+        make_sockaddr(src, 0, req.gsr_source);
+        if (req.gsr_source.ss_family != g.ss_family) {
+            throw SocketError("Multicast source " + src + " and group " + group + " differ in address family");
+        }
+        if (setsockopt(fd, level, MCAST_JOIN_SOURCE_GROUP, reinterpret_cast<const char*>(&req), sizeof(req)) != 0) {
+            throw SocketError("Failed to join multicast group " + where + " for source " + src + ": " +
+                              get_last_socket_error());
+        }
+    }
+#ifndef _WIN32
+    // Linux hands a socket every joined group on its port unless told otherwise
+    int zero = 0;
+    if (g.ss_family == AF_INET) {
+    #ifdef IP_MULTICAST_ALL
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &zero, sizeof(zero));
+    #endif
+    } else {
+    #ifdef IPV6_MULTICAST_ALL
+        setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_ALL, &zero, sizeof(zero));
+    #endif
+    }
+#endif
+}
+
+// Group membership for the capture engines (raw, TPACKET, AF_XDP, pcap):
+// an unbound UDP socket joins, so the kernel sends the IGMP / MLD report
+// and opens the NIC's multicast filter. Nothing is ever queued on it.
+// The capture filter still matches on the group address only: SSM
+// sources are enforced by the network, not by the filter.
+class MulticastMembership {
+private:
+    native_handle_t fd_;
+
+public:
+    MulticastMembership(const std::string& group, const std::string& dev,
+                        const std::vector<std::string>& sources)
+    {
+#ifdef _WIN32
+        WSAInitializer::instance();
+#endif
+        fd_ = static_cast<native_handle_t>(
+            socket(is_ipv6_address(group) ? AF_INET6 : AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+        if (fd_ == static_cast<native_handle_t>(INVALID_SOCKET_FD)) {
+            throw SocketError("Failed to create multicast membership socket: " + get_last_socket_error());
+        }
+        try {
+            join_multicast_group(fd_, group, dev, sources);
+        } catch (const SocketError&) {
+            close_socket(fd_);
+            throw;
+        }
+    }
+
+    ~MulticastMembership() { close_socket(fd_); }
+
+    MulticastMembership(const MulticastMembership&) = delete;
+    MulticastMembership& operator=(const MulticastMembership&) = delete;
+};
+
+// Membership for a capture engine bound to ip; nullptr for unicast
+inline std::unique_ptr<MulticastMembership> capture_membership(const std::string& ip, const std::string& dev,
+                                                              const SocketReaderOpts& opts) {
+    if (!is_multicast_address(ip)) {
+        return nullptr;
+    }
+    return std::unique_ptr<MulticastMembership>(new MulticastMembership(ip, dev, opts.mcast_sources));
+}
+
+// Ethernet/IPv4/UDP frame parsing (raw capture paths)
+constexpr size_t ETH_HDR_LEN = 14;
+constexpr size_t MIN_UDP_FRAME_LEN = ETH_HDR_LEN + 20 + 8;
+
+enum class FrameStatus {
+    OK,
+    TOO_SMALL,   // shorter than Ethernet + IPv4 + UDP headers
+    BAD_IHL,     // IPv4 header length < 20 or beyond captured bytes
+    WRONG_PORT,  // UDP destination port mismatch
+};
+
+// Locate UDP payload in an IPv4 packet (no link layer); payload length is
+// taken from the UDP header and clamped to captured bytes.
+// Does not check version / protocol / fragments (the capture filter does).
+inline FrameStatus parse_udp_ipv4(const uint8_t* ip_header, size_t len, uint16_t port,
+                                  const uint8_t*& payload, size_t& payload_len) noexcept
+{
+    if (len < 20 + 8) {
+        return FrameStatus::TOO_SMALL;
+    }
+    size_t ip_header_len = (ip_header[0] & 0x0F) * 4;
+    if (ip_header_len < 20 || ip_header_len + 8 > len) {
+        return FrameStatus::BAD_IHL;
+    }
+    const uint8_t* udp_header = ip_header + ip_header_len;
+    uint16_t udp_dest_port = (udp_header[2] << 8) | udp_header[3];  // Big-endian
+    if (udp_dest_port != port) {
+        return FrameStatus::WRONG_PORT;
+    }
+    size_t captured = len - (ip_header_len + 8);
+    size_t udp_len = (udp_header[4] << 8) | udp_header[5];
+    payload = udp_header + 8;
+    payload_len = (udp_len >= 8 && udp_len - 8 < captured) ? udp_len - 8 : captured;
+    return FrameStatus::OK;
+}
+
+// Discard accounting for a frame the parsers rejected
+inline void count_rejected_frame(ReaderCounters& c, FrameStatus st) noexcept {
+    if (st == FrameStatus::WRONG_PORT) {
+        c.add_wrong_port();
+    } else {
+        c.add_bad_frame();
+    }
+}
+
+// Locate UDP payload in an Ethernet frame; payload length is taken from
+// the UDP header (Ethernet padding excluded) and clamped to captured bytes
+inline FrameStatus parse_udp_frame(const uint8_t* frame, size_t frame_len, uint16_t port,
+                                   const uint8_t*& payload, size_t& payload_len) noexcept
+{
+    if (frame_len < MIN_UDP_FRAME_LEN) {
+        return FrameStatus::TOO_SMALL;
+    }
+    return parse_udp_ipv4(frame + ETH_HDR_LEN, frame_len - ETH_HDR_LEN, port, payload, payload_len);
+}
+
+// Source address of a packet accepted by parse_udp_ipv4()
+inline void udp_ipv4_source(const uint8_t* ip_header, const uint8_t* payload, PacketMeta& meta) noexcept {
+    const uint8_t* src = ip_header + 12;
+    meta.src_ip = (uint32_t(src[0]) << 24) | (uint32_t(src[1]) << 16) | (uint32_t(src[2]) << 8) | src[3];
+    meta.src_port = static_cast<uint16_t>((payload[-8] << 8) | payload[-7]);
+}
+#ifndef _WIN32
+// Classic BPF program for one IPv4/UDP flow: dst port == port and,
+// unless dst_ip is empty or "0.0.0.0", dst address == dst_ip.
+// Non-first fragments carry no UDP header and are rejected; the UDP
+// header is located via the variable IHL (BPF_MSH).
+inline std::vector<struct sock_filter> build_udp_filter(const std::string& dst_ip, uint16_t port) {
+    bool match_ip = !dst_ip.empty() && dst_ip != "0.0.0.0";
+    struct in_addr addr;
+    if (match_ip && inet_pton(AF_INET, dst_ip.c_str(), &addr) != 1) {
+        throw SocketError("Invalid IP address: " + dst_ip);
+    }
+
+    // Jump targets are relative; accept/reject are the last two instructions
+    const uint8_t n_checks = match_ip ? 11 : 9;  // instructions before accept
+    std::vector<struct sock_filter> prog;
+    prog.reserve(n_checks + 2);
+    auto to_reject = [&]() { return static_cast<uint8_t>(n_checks - prog.size()); };
+    auto to_accept = [&]() { return static_cast<uint8_t>(n_checks - 1 - prog.size()); };
+
+    // EtherType == IPv4?
+    prog.push_back(BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 12));
+    prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_IP, 0, to_reject()));
+    // IP protocol == UDP?
+    prog.push_back(BPF_STMT(BPF_LD | BPF_B | BPF_ABS, ETH_HDR_LEN + 9));
+    prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 0, to_reject()));
+    // Fragment offset == 0?
+    prog.push_back(BPF_STMT(BPF_LD | BPF_H | BPF_ABS, ETH_HDR_LEN + 6));
+    prog.push_back(BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x1FFF, to_reject(), 0));
+    if (match_ip) {
+        // Destination address
+        prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, ETH_HDR_LEN + 16));
+        prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ntohl(addr.s_addr), 0, to_reject()));
+    }
+    // X = IHL * 4, then UDP destination port at X + 14 + 2
+    prog.push_back(BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, ETH_HDR_LEN));
+    prog.push_back(BPF_STMT(BPF_LD | BPF_H | BPF_IND, ETH_HDR_LEN + 2));
+    prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, port, to_accept(), to_reject()));
+
+    // Accept
+    prog.push_back(BPF_STMT(BPF_RET | BPF_K, 65535));
+    // Reject
+    prog.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+    return prog;
+}
+
+// Attach the flow filter to an AF_PACKET socket, so only the target
+// flow is queued to user space
+inline void attach_udp_filter(int fd, const std::string& dst_ip, uint16_t port) {
+    std::vector<struct sock_filter> bpf_code = build_udp_filter(dst_ip, port);
+
+    struct sock_fprog bpf;
+    bpf.len = static_cast<unsigned short>(bpf_code.size());
+    bpf.filter = bpf_code.data();
+
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &bpf, sizeof(bpf)) == -1) {
+        throw SocketError("Failed to attach BPF filter: " + get_last_socket_error());
+    }
+}
+
+// Source address of a frame accepted by parse_udp_frame()
+inline void udp_frame_source(const uint8_t* frame, const uint8_t* payload, PacketMeta& meta) noexcept {
+    udp_ipv4_source(frame + ETH_HDR_LEN, payload, meta);
+}
+
+// Control buffer per message for timestamp cmsgs
+constexpr size_t RX_CMSG_SPACE = 128;
+
+// Ask the NIC driver to timestamp all received packets (needs CAP_NET_ADMIN);
+// returns false when the device / driver refuses
+inline bool enable_nic_rx_timestamps(int fd, const std::string& dev) noexcept {
+    if (dev.empty()) {
+        return false;
+    }
+    struct hwtstamp_config cfg;
+    std::memset(&cfg, 0, sizeof(cfg));
+    cfg.tx_type = HWTSTAMP_TX_OFF;
+    cfg.rx_filter = HWTSTAMP_FILTER_ALL;
+    struct ifreq ifr;
+    std::memset(&ifr, 0, sizeof(ifr));
+    std::strncpy(ifr.ifr_name, dev.c_str(), IFNAMSIZ - 1);
+    ifr.ifr_data = reinterpret_cast<char*>(&cfg);
+    return ioctl(fd, SIOCSHWTSTAMP, &ifr) == 0;
+}
+
+// Enable receive timestamps delivered as cmsgs (recvmsg / recvmmsg)
+inline void enable_rx_timestamps(int fd, TimestampMode mode, const std::string& dev) {
+    if (mode == TimestampMode::SOFTWARE) {
+        int one = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) == -1) {
+            throw SocketError("Failed to enable SO_TIMESTAMPNS: " + get_last_socket_error());
+        }
+    } else if (mode == TimestampMode::HARDWARE) {
+        if (!enable_nic_rx_timestamps(fd, dev)) {
+            std::cerr << "Warning: NIC receive timestamping not enabled on " << dev
+                      << " (" << get_last_socket_error() << "). Falling back to software timestamps.\n";
+        }
+        int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                    SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == -1) {
+            throw SocketError("Failed to enable SO_TIMESTAMPING: " + get_last_socket_error());
+        }
+    }
+}
+
+// Pick the receive timestamp out of a received message's cmsgs
+inline void read_rx_timestamp(struct msghdr* mh, PacketMeta& meta) noexcept {
+    meta.ts_ns = 0;
+    meta.ts_source = TsSource::NONE;
+    if (!mh->msg_control || mh->msg_controllen == 0) {
+        return;
+    }
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(mh); c; c = CMSG_NXTHDR(mh, c)) {
+        if (c->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (c->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            meta.ts_ns = uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+            meta.ts_source = TsSource::SOFTWARE;
+        } else if (c->cmsg_type == SCM_TIMESTAMPING) {
+            struct timespec ts[3];  // [0] software, [2] raw hardware
+            std::memcpy(ts, CMSG_DATA(c), sizeof(ts));
+            if (ts[2].tv_sec || ts[2].tv_nsec) {
+                meta.ts_ns = uint64_t(ts[2].tv_sec) * 1000000000ull + uint64_t(ts[2].tv_nsec);
+                meta.ts_source = TsSource::HARDWARE;
+            } else if (ts[0].tv_sec || ts[0].tv_nsec) {
+                meta.ts_ns = uint64_t(ts[0].tv_sec) * 1000000000ull + uint64_t(ts[0].tv_nsec);
+                meta.ts_source = TsSource::SOFTWARE;
+            }
+        }
+    }
+}
+
+// Classic BPF socket selector returning a queue index for CPU / SEQ /
+// ROUND_ROBIN balance. l2 == true: program sees Ethernet frames (fanout),
+// else it starts at the UDP payload (reuseport).
+inline std::vector<struct sock_filter> build_balance_filter(QueueBalance balance, uint32_t queues,
+                                                            uint32_t payload_byte, bool l2) {
+    std::vector<struct sock_filter> prog;
+    switch (balance) {
+        case QueueBalance::CPU:
+            prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+            break;
+        case QueueBalance::ROUND_ROBIN:
+            prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_RANDOM)));
+            break;
+        case QueueBalance::SEQ:
+            if (l2) {
+                // Fanout runs before the MAC header is pushed back on ingress:
+                // address relative to the network header
+                prog.push_back(BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, static_cast<uint32_t>(SKF_NET_OFF)));
+                prog.push_back(BPF_STMT(BPF_LD | BPF_B | BPF_IND, static_cast<uint32_t>(SKF_NET_OFF + 8 + payload_byte)));
+            } else {
+                prog.push_back(BPF_STMT(BPF_LD | BPF_B | BPF_ABS, payload_byte));
+            }
+            break;
+        case QueueBalance::HASH:
+            throw SocketError("HASH balance needs no selector program");
+    }
+    prog.push_back(BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, queues ? queues : 1));
+    prog.push_back(BPF_STMT(BPF_RET | BPF_A, 0));
+    return prog;
+}
+
+// UDP: allow several sockets on one ip:port (call before bind)
+inline void enable_reuseport(int fd) {
+    int one = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == -1) {
+        throw SocketError("Failed to set SO_REUSEPORT: " + get_last_socket_error());
+    }
+}
+
+// UDP: install the group's socket selector (call after bind)
+inline void attach_reuseport_balance(int fd, const SocketReaderOpts& opts) {
+    if (opts.balance == QueueBalance::HASH) {
+        return;  // kernel default
+    }
+    std::vector<struct sock_filter> code =
+        build_balance_filter(opts.balance, opts.queue_count, opts.balance_byte, false);
+    struct sock_fprog bpf;
+    bpf.len = static_cast<unsigned short>(code.size());
+    bpf.filter = code.data();
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &bpf, sizeof(bpf)) == -1) {
+        throw SocketError("Failed to attach reuseport selector: " + get_last_socket_error());
+    }
+}
+
+// SO_BUSY_POLL (+ SO_PREFER_BUSY_POLL where known); a refusal only warns
+inline void enable_busy_poll(int fd, uint32_t usec) {
+    if (usec == 0) {
+        return;
+    }
+#ifdef SO_BUSY_POLL
+    int v = static_cast<int>(usec);
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &v, sizeof(v)) == -1) {
+        std::cerr << "Warning: Failed to set SO_BUSY_POLL " << usec << " us (" << get_last_socket_error() << ")\n";
+        return;
+    }
+    #ifdef SO_PREFER_BUSY_POLL
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &one, sizeof(one));
+    #endif
+#else
+    (void)fd;
+    std::cerr << "Warning: SO_BUSY_POLL not available in this build\n";
+#endif
+}
+
+// Raw: join PACKET_FANOUT group opts.fanout_group (call after bind)
+inline void join_fanout_group(int fd, const SocketReaderOpts& opts) {
+    int mode = PACKET_FANOUT_HASH;
+    switch (opts.balance) {
+        case QueueBalance::HASH:        mode = PACKET_FANOUT_HASH; break;
+        case QueueBalance::ROUND_ROBIN: mode = PACKET_FANOUT_LB; break;
+        case QueueBalance::CPU:         mode = PACKET_FANOUT_CPU; break;
+        case QueueBalance::SEQ:         mode = PACKET_FANOUT_CBPF; break;
+    }
+    int arg = opts.fanout_group | (mode << 16);
+    if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)) == -1) {
+        throw SocketError("Failed to join PACKET_FANOUT group " + std::to_string(opts.fanout_group) +
+                          ": " + get_last_socket_error());
+    }
+    if (mode == PACKET_FANOUT_CBPF) {
+        std::vector<struct sock_filter> code =
+            build_balance_filter(opts.balance, opts.queue_count, opts.balance_byte, true);
+        struct sock_fprog bpf;
+        bpf.len = static_cast<unsigned short>(code.size());
+        bpf.filter = code.data();
+        if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT_DATA, &bpf, sizeof(bpf)) == -1) {
+            throw SocketError("Failed to attach fanout selector: " + get_last_socket_error());
+        }
+    }
+}
+#endif
@@ -0,0 +1,426 @@
+// source_demux.hpp
+#pragma once
+#include "socket_common.hpp"
+#include "threaded_reader.hpp"  // CACHE_LINE_SIZE, cpu_placement.hpp
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cstring>
+
+// Sender of a datagram: IPv4 or IPv6 address plus UDP port
+struct SourceKey {
+    uint32_t ip = 0;        // IPv4, host byte order (0 for IPv6)
+    uint8_t ip6[16] = {};   // IPv6, all zero for IPv4
+    uint16_t port = 0;      // 0 as a filter: any port
+
+    static SourceKey from_meta(const PacketMeta& m) noexcept {
+        SourceKey k;
+        k.ip = m.src_ip;
+        std::memcpy(k.ip6, m.src_ip6, sizeof(k.ip6));
+        k.port = m.src_port;
+        return k;
+    }
+
+    // As a filter: same address and port (unless port == 0)
+    bool matches(const SourceKey& pkt) const noexcept {
+        return ip == pkt.ip && (port == 0 || port == pkt.port) && std::memcmp(ip6, pkt.ip6, sizeof(ip6)) == 0;
+    }
+
+    std::string to_string() const {
+        char addr[INET6_ADDRSTRLEN] = "?";
+        bool v6 = false;
+        for (uint8_t b : ip6) {
+            v6 |= b != 0;
+        }
+        if (v6) {
+            inet_ntop(AF_INET6, ip6, addr, sizeof(addr));
+        } else {
+            struct in_addr a;
+            a.s_addr = htonl(ip);
+            inet_ntop(AF_INET, &a, addr, sizeof(addr));
+        }
+        std::string s = v6 ? "[" + std::string(addr) + "]" : std::string(addr);
+        return port ? s + ":" + std::to_string(port) : s;
+    }
+};
+
+// "ip", "ip:port", "ip6" or "[ip6]:port"
+inline SourceKey parse_source_key(const std::string& s) {
+    std::string host = s;
+    uint16_t port = 0;
+    size_t c = s.rfind(':');
+    if (!s.empty() && s[0] == '[') {
+        size_t close = s.find(']');
+        if (close == std::string::npos) {
+            throw SocketError("Invalid source address: " + s);
+        }
+        host = s.substr(1, close - 1);
+        if (close + 1 < s.size()) {
+            if (s[close + 1] != ':') {
+                throw SocketError("Invalid source address: " + s);
+            }
+            port = static_cast<uint16_t>(std::atoi(s.c_str() + close + 2));
+        }
+    } else if (c != std::string::npos && s.find(':') == c) {
+        host = s.substr(0, c);
+        port = static_cast<uint16_t>(std::atoi(s.c_str() + c + 1));
+    }
+    struct sockaddr_storage ss;
+    make_sockaddr(host, port, ss);
+    PacketMeta m{};
+    sockaddr_source(ss, m);
+    return SourceKey::from_meta(m);
+}
+
+struct SourceDemuxOpts {
+    std::vector<std::string> sources;  // fixed senders "ip[:port]", queue i = sources[i];
+                                       // empty = a queue per sender as it first appears
+    size_t max_sources = 16;           // learned queues; datagrams of further senders are dropped
+    bool match_port = true;            // learned senders keyed by address + port, else address only
+    size_t depth = 1024;               // datagrams buffered per source
+    size_t slot_size = 9216;           // max datagram bytes kept (jumbo frame); longer ones are SEG_TRUNCATED
+    size_t chunk_size = 0;             // per-source read_into() chunk, 0 = inner chunk size
+    int32_t timeout_ms = 1000;         // per-source read_into() wait before ReadTimeout, <= 0 = forever
+    int cpu = -1;                      // pin the receive thread, -1 = no pinning
+    int rt_priority = 0;               // > 0: receive thread SCHED_FIFO priority
+};
+
+namespace demux_detail {
+
+// Wakeup shared by the receive thread and all parked consumers
+struct Doorbell {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic<bool> finished{false};  // receive thread stopped (end of stream or error)
+    std::exception_ptr error;           // set before finished
+
+    void ring() {
+        { std::lock_guard<std::mutex> lk(mtx); }
+        cv.notify_all();
+    }
+};
+
+} // namespace demux_detail
+
+// One sender's datagrams out of a SourceDemux: whole datagrams, as many
+// as fit in a chunk, with datagram table and metadata. Fed through a
+// lock-free single-producer/single-consumer ring; one consumer thread
+// per stream. read_into() returns 0 once the demux stopped and the ring
+// is drained; a receive error is rethrown after the data before it.
+class SourceStream : public I_STREAM_READER {
+private:
+    friend class SourceDemux;
+
+    demux_detail::Doorbell& bell_;
+    SourceKey key_;
+    size_t depth_;
+    size_t slot_size_;
+    size_t chunk_size_;
+    int32_t timeout_ms_;
+    std::vector<uint8_t> arena_;        // depth_ slots of slot_size_ bytes
+    std::vector<size_t> lens_;
+    std::vector<PacketMeta> slot_meta_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};  // published by the receive thread
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};  // released by the consumer
+    std::atomic<bool> parked_{false};
+    std::atomic<uint64_t> datagrams_{0};
+    std::atomic<uint64_t> dropped_{0};  // ring full: consumer too slow
+
+    std::vector<ChunkSegment> segments_;
+    std::vector<PacketMeta> meta_;
+
+    // Receive thread: false when the ring is full (datagram dropped)
+    bool push(const uint8_t* p, size_t len, const PacketMeta& m) noexcept {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= depth_) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        size_t slot = head % depth_;
+        uint32_t flags = m.flags;
+        if (len > slot_size_) {
+            len = slot_size_;
+            flags |= SEG_TRUNCATED;
+        }
+        std::memcpy(arena_.data() + slot * slot_size_, p, len);
+        lens_[slot] = len;
+        slot_meta_[slot] = m;
+        slot_meta_[slot].flags = flags;
+        head_.store(head + 1, std::memory_order_release);
+        datagrams_.store(datagrams_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Until the ring holds data (true) or the demux finished (false)
+    bool wait(size_t tail) {
+        auto ready = [&]() {
+            return head_.load(std::memory_order_acquire) != tail || bell_.finished.load(std::memory_order_acquire);
+        };
+        if (!ready()) {
+            std::unique_lock<std::mutex> lk(bell_.mtx);
+            parked_.store(true, std::memory_order_seq_cst);  // pairs with the receive thread's fence
+            bool ok = true;
+            if (timeout_ms_ > 0) {
+                ok = bell_.cv.wait_for(lk, std::chrono::milliseconds(timeout_ms_), ready);
+            } else {
+                bell_.cv.wait(lk, ready);
+            }
+            parked_.store(false, std::memory_order_relaxed);
+            if (!ok) {
+                throw ReadTimeout("[SourceDemux] No datagrams from " + key_.to_string() + " within " +
+                                  std::to_string(timeout_ms_) + " ms");
+            }
+        }
+        if (head_.load(std::memory_order_acquire) != tail) {
+            return true;
+        }
+        if (bell_.error) {
+            std::rethrow_exception(bell_.error);
+        }
+        return false;
+    }
+
+public:
+    SourceStream(demux_detail::Doorbell& bell, const SourceKey& key, const SourceDemuxOpts& opts, size_t chunk_size)
+        : bell_(bell)
+        , key_(key)
+        , depth_(opts.depth ? opts.depth : 1)
+        , slot_size_(std::min(opts.slot_size, chunk_size))
+        , chunk_size_(chunk_size)
+        , timeout_ms_(opts.timeout_ms)
+        , arena_(depth_ * slot_size_)
+        , lens_(depth_, 0)
+        , slot_meta_(depth_)
+    {
+        segments_.reserve(depth_);
+        meta_.reserve(depth_);
+    }
+
+    SourceStream(const SourceStream&) = delete;
+    SourceStream& operator=(const SourceStream&) = delete;
+
+    size_t read_into(uint8_t* buff_ptr) override {
+        segments_.clear();
+        meta_.clear();
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (!wait(tail)) {
+            return 0;
+        }
+        const size_t head = head_.load(std::memory_order_acquire);
+        size_t pos = 0;
+        while (tail != head) {
+            size_t slot = tail % depth_;
+            size_t len = lens_[slot];
+            if (pos + len > chunk_size_) {
+                break;  // leads the next chunk
+            }
+            std::memcpy(buff_ptr + pos, arena_.data() + slot * slot_size_, len);
+            segments_.push_back({pos, len, slot_meta_[slot].flags});
+            meta_.push_back(slot_meta_[slot]);
+            pos += len;
+            ++tail;
+        }
+        tail_.store(tail, std::memory_order_release);
+        return pos;
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_size_; }
+    std::string get_type() const noexcept override { return "demux[" + key_.to_string() + "]"; }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = meta_.data();
+        return meta_.size();
+    }
+
+    const SourceKey& get_source() const noexcept { return key_; }
+    uint64_t get_datagram_count() const noexcept { return datagrams_.load(std::memory_order_relaxed); }
+    uint64_t get_dropped_count() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+};
+
+// Source demultiplexer: one receive thread drains the wrapped reader
+// (unicast or multicast group, any engine) and fans datagrams out by
+// sender address to per-source SourceStream queues, so one socket serves
+// several digitizer streams. Each stream is an I_STREAM_READER of its own
+// (wrap it in a SeqTrackingReader for per-source loss accounting).
+// The inner reader must collect packet metadata (SocketReaderOpts::packet_meta)
+// and should have a finite timeout so ~SourceDemux() can join.
+// A full queue drops that source's datagrams; the others keep flowing.
+class SourceDemux {
+private:
+    I_STREAM_READER* inner_;
+    bool own_inner_;
+    SourceDemuxOpts opts_;
+    size_t chunk_size_;
+    bool fixed_;
+    demux_detail::Doorbell bell_;
+    std::vector<std::unique_ptr<SourceStream>> queues_;  // capacity fixed at construction
+    std::atomic<size_t> count_{0};                       // queues published so far
+    size_t last_hit_ = 0;
+    std::atomic<uint64_t> unmatched_{0};
+    std::vector<uint8_t> buf_;
+    std::atomic<bool> stop_{false};
+    std::thread worker_;
+
+    // Queue for a sender, learning a new one if allowed; nullptr = drop
+    SourceStream* route(const SourceKey& k) {
+        size_t n = count_.load(std::memory_order_relaxed);  // only this thread adds
+        if (last_hit_ < n && queues_[last_hit_]->key_.matches(k)) {
+            return queues_[last_hit_].get();
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (queues_[i]->key_.matches(k)) {
+                last_hit_ = i;
+                return queues_[i].get();
+            }
+        }
+        if (fixed_ || n == queues_.size()) {
+            return nullptr;
+        }
+        SourceKey key = k;
+        if (!opts_.match_port) {
+            key.port = 0;
+        }
+        queues_[n].reset(new SourceStream(bell_, key, opts_, chunk_size_));
+        count_.store(n + 1, std::memory_order_release);
+        bell_.ring();  // wait_for_source()
+        last_hit_ = n;
+        return queues_[n].get();
+    }
+
+    void dispatch(size_t rd) {
+        const ChunkSegment* segs;
+        size_t seg_count = inner_->get_segments(segs);
+        const PacketMeta* meta;
+        size_t meta_count = inner_->get_packet_meta(meta);
+        if (meta_count == 0 || meta_count != (seg_count ? seg_count : 1)) {
+            throw std::runtime_error("[SourceDemux] Inner reader delivers no per-datagram source "
+                                     "(enable SocketReaderOpts::packet_meta)");
+        }
+        bool pushed = false;
+        for (size_t i = 0; i < meta_count; ++i) {
+            const uint8_t* p = buf_.data() + (seg_count ? segs[i].offset : 0);
+            size_t len = seg_count ? segs[i].length : rd;
+            if (len == 0) {
+                continue;
+            }
+            SourceStream* q = route(SourceKey::from_meta(meta[i]));
+            if (!q) {
+                unmatched_.store(unmatched_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                continue;
+            }
+            pushed |= q->push(p, len, meta[i]);
+        }
+        if (pushed) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);  // pairs with SourceStream::wait()
+            size_t n = count_.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < n; ++i) {
+                if (queues_[i]->parked_.load(std::memory_order_seq_cst)) {
+                    bell_.ring();
+                    break;
+                }
+            }
+        }
+    }
+
+    void loop() {
+        try {
+            while (!stop_.load(std::memory_order_relaxed)) {
+                size_t rd;
+                try {
+                    rd = inner_->read_into(buf_.data());
+                } catch (const ReadTimeout&) {
+                    continue;
+                }
+                if (rd == 0) {
+                    break;  // end of stream / interrupted
+                }
+                dispatch(rd);
+            }
+        } catch (...) {
+            bell_.error = std::current_exception();
+        }
+        bell_.finished.store(true, std::memory_order_release);
+        bell_.ring();
+    }
+
+public:
+    SourceDemux(I_STREAM_READER* inner,
+                const SourceDemuxOpts& opts = SourceDemuxOpts(),
+                bool own_inner = false)
+        : inner_(inner)
+        , own_inner_(own_inner)
+        , opts_(opts)
+        , chunk_size_(opts.chunk_size ? opts.chunk_size : inner->get_chunk_size())
+        , fixed_(!opts.sources.empty())
+        , buf_(inner->get_chunk_size())
+    {
+        if (chunk_size_ == 0) {
+            throw std::runtime_error("[SourceDemux] Chunk size must be > 0");
+        }
+        queues_.resize(fixed_ ? opts_.sources.size() : opts_.max_sources);
+        for (size_t i = 0; fixed_ && i < opts_.sources.size(); ++i) {
+            queues_[i].reset(new SourceStream(bell_, parse_source_key(opts_.sources[i]), opts_, chunk_size_));
+        }
+        count_.store(fixed_ ? opts_.sources.size() : 0, std::memory_order_release);
+
+        worker_ = std::thread(&SourceDemux::loop, this);
+        if (opts_.cpu >= 0 && !pin_thread_to_cpu(worker_, opts_.cpu)) {
+            std::cerr << "Warning: Failed to pin demux receive thread to CPU " << opts_.cpu << "\n";
+        }
+        if (opts_.rt_priority > 0 && !set_thread_rt_priority(worker_, opts_.rt_priority)) {
+            std::cerr << "Warning: Failed to set SCHED_FIFO priority " << opts_.rt_priority
+                      << " for demux receive thread\n";
+        }
+    }
+
+    ~SourceDemux() {
+        stop_ = true;
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        queues_.clear();
+        if (own_inner_) {
+            delete inner_;
+        }
+    }
+
+    SourceDemux(const SourceDemux&) = delete;
+    SourceDemux& operator=(const SourceDemux&) = delete;
+
+    // Queues known so far (fixed list: all of them from the start)
+    size_t get_source_count() const noexcept { return count_.load(std::memory_order_acquire); }
+
+    SourceStream* get_source(size_t i) const noexcept {
+        return i < get_source_count() ? queues_[i].get() : nullptr;
+    }
+
+    // Queue i once its sender appeared; nullptr on timeout (<= 0: forever)
+    // or when the demux finished first
+    SourceStream* wait_for_source(size_t i, int32_t timeout_ms = -1) {
+        auto ready = [&]() { return get_source_count() > i || bell_.finished.load(std::memory_order_acquire); };
+        std::unique_lock<std::mutex> lk(bell_.mtx);
+        if (timeout_ms > 0) {
+            bell_.cv.wait_for(lk, std::chrono::milliseconds(timeout_ms), ready);
+        } else {
+            bell_.cv.wait(lk, ready);
+        }
+        return get_source(i);
+    }
+
+    // Datagrams of senders without a queue (not listed / beyond max_sources)
+    uint64_t get_unmatched_count() const noexcept { return unmatched_.load(std::memory_order_relaxed); }
+    bool is_finished() const noexcept { return bell_.finished.load(std::memory_order_acquire); }
+    I_STREAM_READER* get_inner() const noexcept { return inner_; }
+};
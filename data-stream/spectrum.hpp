@@ -0,0 +1,471 @@
+// spectrum.hpp
+#pragma once
+#include "iq_convert.hpp"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+// Complex power normalization of scripts/fft_opt.py: full-scale I and Q -> 0 dBFS
+constexpr float COMPLEX_SCALING_FACTOR = 2.0f;
+
+namespace fft_detail {
+
+constexpr double PI = 3.14159265358979323846;
+
+inline bool is_pow2(size_t n) noexcept { return n >= 2 && (n & (n - 1)) == 0; }
+
+// One radix-2 stage: blocks of 2 * half, twiddles tw[0..half)
+inline void stage_scalar(cf32* x, size_t n, size_t half, const cf32* tw) noexcept {
+    for (size_t b = 0; b < n; b += 2 * half) {
+        cf32* lo = x + b;
+        cf32* hi = lo + half;
+        for (size_t j = 0; j < half; ++j) {
+            float br = hi[j].real(), bi = hi[j].imag();
+            float wr = tw[j].real(), wi = tw[j].imag();
+            cf32 t(br * wr - bi * wi, br * wi + bi * wr);
+            hi[j] = lo[j] - t;
+            lo[j] += t;
+        }
+    }
+}
+
+#ifdef DATASTREAM_IQ_X86
+// 4 butterflies per step; half must be a multiple of 4
+DATASTREAM_IQ_TARGET("avx2")
+inline void stage_avx2(cf32* x, size_t n, size_t half, const cf32* tw) noexcept {
+    for (size_t b = 0; b < n; b += 2 * half) {
+        float* lo = reinterpret_cast<float*>(x + b);
+        float* hi = reinterpret_cast<float*>(x + b + half);
+        const float* w = reinterpret_cast<const float*>(tw);
+        for (size_t j = 0; j < 2 * half; j += 8) {
+            __m256 a = _mm256_loadu_ps(lo + j);
+            __m256 v = _mm256_loadu_ps(hi + j);
+            __m256 ww = _mm256_loadu_ps(w + j);
+            __m256 wr = _mm256_moveldup_ps(ww);
+            __m256 wi = _mm256_movehdup_ps(ww);
+            __m256 vs = _mm256_permute_ps(v, 0xB1);  // (im, re)
+            __m256 t = _mm256_addsub_ps(_mm256_mul_ps(v, wr), _mm256_mul_ps(vs, wi));
+            _mm256_storeu_ps(hi + j, _mm256_sub_ps(a, t));
+            _mm256_storeu_ps(lo + j, _mm256_add_ps(a, t));
+        }
+    }
+}
+
+// acc[k] += |x[k]|^2
+DATASTREAM_IQ_TARGET("avx2")
+inline void accumulate_power_avx2(const cf32* x, float* acc, size_t n) noexcept {
+    const float* f = reinterpret_cast<const float*>(x);
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m256 a = _mm256_loadu_ps(f + 2 * k);       // r0 i0 r1 i1 r2 i2 r3 i3
+        __m256 b = _mm256_loadu_ps(f + 2 * k + 8);   // r4 i4 ... r7 i7
+        __m256 p = _mm256_hadd_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b));  // p0 p1 p4 p5 | p2 p3 p6 p7
+        p = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(p), 0xD8));
+        _mm256_storeu_ps(acc + k, _mm256_add_ps(_mm256_loadu_ps(acc + k), p));
+    }
+    for (; k < n; ++k) {
+        acc[k] += std::norm(x[k]);
+    }
+}
+
+// dst[k] = src[k] * w[k] (real window)
+DATASTREAM_IQ_TARGET("avx2")
+inline void apply_window_avx2(const cf32* src, const float* w, cf32* dst, size_t n) noexcept {
+    const float* s = reinterpret_cast<const float*>(src);
+    float* d = reinterpret_cast<float*>(dst);
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m128 w4 = _mm_loadu_ps(w + k);
+        __m256 ww = _mm256_set_m128(_mm_unpackhi_ps(w4, w4), _mm_unpacklo_ps(w4, w4));
+        _mm256_storeu_ps(d + 2 * k, _mm256_mul_ps(_mm256_loadu_ps(s + 2 * k), ww));
+    }
+    for (; k < n; ++k) {
+        dst[k] = src[k] * w[k];
+    }
+}
+#endif
+
+inline void accumulate_power_scalar(const cf32* x, float* acc, size_t n) noexcept {
+    for (size_t k = 0; k < n; ++k) {
+        acc[k] += x[k].real() * x[k].real() + x[k].imag() * x[k].imag();
+    }
+}
+
+inline void apply_window_scalar(const cf32* src, const float* w, cf32* dst, size_t n) noexcept {
+    for (size_t k = 0; k < n; ++k) {
+        dst[k] = src[k] * w[k];
+    }
+}
+
+} // namespace fft_detail
+
+// In-place radix-2 complex FFT of one power-of-two length.
+// Twiddles and the bit-reversal table are precomputed; the butterfly
+// kernel is chosen once (AVX2 when available). Immutable after
+// construction, so one plan can be shared between threads.
+class FftPlan {
+private:
+    size_t n_;
+    std::vector<uint32_t> rev_;   // bit-reversal permutation
+    std::vector<cf32> tw_;        // per-stage twiddles, stage with half h at [h - 1, 2h - 1)
+    bool avx2_ = false;
+
+public:
+    explicit FftPlan(size_t n)
+        : n_(n)
+    {
+        if (!fft_detail::is_pow2(n) || n > (size_t(1) << 30)) {
+            throw std::runtime_error("[FftPlan] Length must be a power of two >= 2, got " + std::to_string(n));
+        }
+        size_t bits = 0;
+        while ((size_t(1) << bits) < n) {
+            ++bits;
+        }
+        rev_.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            size_t r = 0;
+            for (size_t b = 0; b < bits; ++b) {
+                r |= ((k >> b) & 1) << (bits - 1 - b);
+            }
+            rev_[k] = static_cast<uint32_t>(r);
+        }
+        tw_.resize(n - 1);
+        for (size_t half = 1; half < n; half *= 2) {
+            for (size_t j = 0; j < half; ++j) {
+                double a = -fft_detail::PI * double(j) / double(half);
+                tw_[half - 1 + j] = cf32(float(std::cos(a)), float(std::sin(a)));
+            }
+        }
+#ifdef DATASTREAM_IQ_X86
+        avx2_ = iq_kernel_supported(IqKernel::AVX2);
+#endif
+    }
+
+    // Forward transform (e^-j), unnormalized
+    void execute(cf32* x) const noexcept {
+        for (size_t k = 0; k < n_; ++k) {
+            size_t r = rev_[k];
+            if (r > k) {
+                std::swap(x[k], x[r]);
+            }
+        }
+        for (size_t half = 1; half < n_; half *= 2) {
+            const cf32* tw = tw_.data() + half - 1;
+#ifdef DATASTREAM_IQ_X86
+            if (avx2_ && half >= 4) {
+                fft_detail::stage_avx2(x, n_, half, tw);
+                continue;
+            }
+#endif
+            fft_detail::stage_scalar(x, n_, half, tw);
+        }
+    }
+
+    size_t size() const noexcept { return n_; }
+    bool is_simd() const noexcept { return avx2_; }
+};
+
+// Shared plan per length; built on first use
+inline std::shared_ptr<const FftPlan> get_fft_plan(size_t n) {
+    static std::mutex mtx;
+    static std::map<size_t, std::shared_ptr<const FftPlan>> cache;
+    std::lock_guard<std::mutex> lk(mtx);
+    auto it = cache.find(n);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    auto plan = std::make_shared<const FftPlan>(n);
+    cache.emplace(n, plan);
+    return plan;
+}
+
+enum class WindowType {
+    RECT,
+    HANN,
+    HAMMING,
+    BLACKMAN_HARRIS,  // 4-term, -92 dB sidelobes
+    GAUSS,            // exp(-0.5 * (alpha * t)^2), t in [-1, 1]
+};
+
+inline std::vector<float> make_window(WindowType type, size_t n, double alpha = 2.5) {
+    std::vector<float> w(n, 1.0f);
+    const double m = n > 1 ? double(n - 1) : 1.0;
+    for (size_t k = 0; k < n; ++k) {
+        double x = 2.0 * fft_detail::PI * double(k) / m;
+        switch (type) {
+            case WindowType::RECT:
+                break;
+            case WindowType::HANN:
+                w[k] = float(0.5 - 0.5 * std::cos(x));
+                break;
+            case WindowType::HAMMING:
+                w[k] = float(0.54 - 0.46 * std::cos(x));
+                break;
+            case WindowType::BLACKMAN_HARRIS:
+                w[k] = float(0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2 * x) - 0.01168 * std::cos(3 * x));
+                break;
+            case WindowType::GAUSS: {
+                double t = 2.0 * double(k) / m - 1.0;
+                w[k] = float(std::exp(-0.5 * (alpha * t) * (alpha * t)));
+                break;
+            }
+        }
+    }
+    return w;
+}
+
+struct SpectrumOpts {
+    size_t fft_n = 1024;                  // power of two
+    size_t overlap = 0;                   // samples shared by consecutive windows (< fft_n)
+    size_t averages = 8;                  // windows per frame (fft_opt.py: fft_batch)
+    WindowType window = WindowType::HANN;
+    double gauss_alpha = 2.5;
+    float ema_alpha = 0.0f;               // > 0: exponential average across frames
+    bool dbfs = true;                     // 10 * log10(P / ref_power), else linear power
+    bool shift = true;                    // DC in the middle (fftshift)
+    float ref_power = COMPLEX_SCALING_FACTOR;  // 0 dBFS for samples normalized to [-1, 1)
+    size_t publish_every = 1;             // hand one frame in N to the display
+};
+
+// One averaged spectrum
+struct SpectrumFrame {
+    std::vector<float> bins;   // fft_n values, dBFS or linear
+    uint64_t index = 0;        // frame number (all frames, published or not)
+    uint64_t windows = 0;      // FFT windows processed up to this frame
+};
+
+// Streaming Welch-style spectrum: windowed, overlapped FFTs whose power is
+// averaged over `averages` windows per frame. Power is normalized by the
+// window's coherent gain, so a full-scale tone reads 0 dBFS with any window.
+// Every publish_every-th frame is handed over through a latest-frame mailbox
+// (get_latest, safe from another thread) and the optional callback.
+class SpectrumEngine {
+public:
+    using FrameCallback = std::function<void(const SpectrumFrame&)>;
+
+private:
+    SpectrumOpts opts_;
+    std::shared_ptr<const FftPlan> plan_;
+    std::vector<float> window_;
+    float norm_;                   // 1 / ((sum w)^2 * ref_power * averages)
+    size_t hop_;
+    bool avx2_ = false;
+
+    std::vector<cf32> pending_;    // window being filled
+    size_t fill_ = 0;
+    std::vector<cf32> work_;
+    std::vector<float> acc_;       // power sum of the current frame
+    std::vector<float> ema_;
+    size_t acc_windows_ = 0;
+
+    SpectrumFrame frame_;
+    uint64_t windows_ = 0;
+    uint64_t frames_ = 0;
+    std::atomic<uint64_t> published_{0};
+
+    std::mutex mbox_mtx_;
+    SpectrumFrame latest_;
+    bool fresh_ = false;
+    FrameCallback on_frame_;
+
+    void process_window() {
+#ifdef DATASTREAM_IQ_X86
+        if (avx2_) {
+            fft_detail::apply_window_avx2(pending_.data(), window_.data(), work_.data(), opts_.fft_n);
+            plan_->execute(work_.data());
+            fft_detail::accumulate_power_avx2(work_.data(), acc_.data(), opts_.fft_n);
+        } else
+#endif
+        {
+            fft_detail::apply_window_scalar(pending_.data(), window_.data(), work_.data(), opts_.fft_n);
+            plan_->execute(work_.data());
+            fft_detail::accumulate_power_scalar(work_.data(), acc_.data(), opts_.fft_n);
+        }
+        ++windows_;
+        if (++acc_windows_ == opts_.averages) {
+            finish_frame();
+        }
+    }
+
+    void finish_frame() {
+        const size_t n = opts_.fft_n;
+        const size_t half = opts_.shift ? n / 2 : 0;
+        const bool ema = opts_.ema_alpha > 0.0f && frames_ > 0;
+        const float a = opts_.ema_alpha;
+        for (size_t k = 0; k < n; ++k) {
+            float p = acc_[k] * norm_;
+            if (opts_.ema_alpha > 0.0f) {
+                ema_[k] = ema ? ema_[k] + a * (p - ema_[k]) : p;
+                p = ema_[k];
+            }
+            frame_.bins[(k + half) % n] = opts_.dbfs ? 10.0f * std::log10(std::max(p, 1e-30f)) : p;
+        }
+        std::fill(acc_.begin(), acc_.end(), 0.0f);
+        acc_windows_ = 0;
+        frame_.index = frames_++;
+        frame_.windows = windows_;
+
+        if (frame_.index % opts_.publish_every == 0) {
+            {
+                std::lock_guard<std::mutex> lk(mbox_mtx_);
+                latest_.bins.swap(frame_.bins);
+                latest_.index = frame_.index;
+                latest_.windows = frame_.windows;
+                fresh_ = true;
+                if (on_frame_) {
+                    on_frame_(latest_);
+                }
+            }
+            frame_.bins.resize(n);
+            published_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    explicit SpectrumEngine(const SpectrumOpts& opts = SpectrumOpts())
+        : opts_(opts)
+        , plan_(get_fft_plan(opts.fft_n))
+        , window_(make_window(opts.window, opts.fft_n, opts.gauss_alpha))
+    {
+        if (opts_.overlap >= opts_.fft_n) {
+            throw std::runtime_error("[SpectrumEngine] Overlap must be < fft_n");
+        }
+        if (opts_.averages == 0) {
+            opts_.averages = 1;
+        }
+        if (opts_.publish_every == 0) {
+            opts_.publish_every = 1;
+        }
+        double sum = 0.0;
+        for (float w : window_) {
+            sum += w;
+        }
+        norm_ = float(1.0 / (sum * sum * double(opts_.ref_power) * double(opts_.averages)));
+        hop_ = opts_.fft_n - opts_.overlap;
+#ifdef DATASTREAM_IQ_X86
+        avx2_ = plan_->is_simd();
+#endif
+        pending_.resize(opts_.fft_n);
+        work_.resize(opts_.fft_n);
+        acc_.assign(opts_.fft_n, 0.0f);
+        if (opts_.ema_alpha > 0.0f) {
+            ema_.assign(opts_.fft_n, 0.0f);
+        }
+        frame_.bins.resize(opts_.fft_n);
+    }
+
+    SpectrumEngine(const SpectrumEngine&) = delete;
+    SpectrumEngine& operator=(const SpectrumEngine&) = delete;
+
+    // Feed samples; returns frames completed during this call
+    size_t push(const cf32* samples, size_t count) {
+        const uint64_t before = frames_;
+        const size_t n = opts_.fft_n;
+        while (count > 0) {
+            size_t take = std::min(count, n - fill_);
+            std::memcpy(pending_.data() + fill_, samples, take * sizeof(cf32));
+            fill_ += take;
+            samples += take;
+            count -= take;
+            if (fill_ == n) {
+                process_window();
+                std::memmove(pending_.data(), pending_.data() + hop_, opts_.overlap * sizeof(cf32));
+                fill_ = opts_.overlap;
+            }
+        }
+        return static_cast<size_t>(frames_ - before);
+    }
+
+    // Drop the partially filled window (e.g. after a stream discontinuity)
+    void restart_window() noexcept { fill_ = 0; }
+
+    // Latest published frame, if newer than the last call; swaps into out
+    bool get_latest(SpectrumFrame& out) {
+        std::lock_guard<std::mutex> lk(mbox_mtx_);
+        if (!fresh_) {
+            return false;
+        }
+        out.bins.swap(latest_.bins);
+        out.index = latest_.index;
+        out.windows = latest_.windows;
+        latest_.bins.resize(opts_.fft_n);
+        fresh_ = false;
+        return true;
+    }
+
+    // Called on the processing thread for every published frame (under the mailbox lock)
+    void set_callback(FrameCallback cb) {
+        std::lock_guard<std::mutex> lk(mbox_mtx_);
+        on_frame_ = std::move(cb);
+    }
+
+    // Bin center frequencies in output order
+    std::vector<double> get_freqs(double fs, double fc = 0.0) const {
+        const size_t n = opts_.fft_n;
+        std::vector<double> f(n);
+        for (size_t k = 0; k < n; ++k) {
+            double bin = opts_.shift ? double(k) - double(n / 2)
+                                     : (k < n / 2 ? double(k) : double(k) - double(n));
+            f[k] = bin * fs / double(n) + fc;
+        }
+        return f;
+    }
+
+    const SpectrumOpts& get_opts() const noexcept { return opts_; }
+    const FftPlan& get_plan() const noexcept { return *plan_; }
+    uint64_t get_window_count() const noexcept { return windows_; }
+    uint64_t get_frame_count() const noexcept { return frames_; }
+    uint64_t get_published_count() const noexcept { return published_.load(std::memory_order_relaxed); }
+};
+
+// Reader-to-spectrum stage: int16 IQ chunks from any I_STREAM_READER are
+// converted (IqConvertReader) and fed to a SpectrumEngine. Zero-filled
+// placeholders (SeqTrackingReader ZERO_FILL) keep the time base intact;
+// with COUNT policy gaps are simply skipped.
+class SpectrumStage {
+private:
+    IqConvertReader conv_;
+    SpectrumEngine engine_;
+    uint64_t samples_ = 0;
+
+public:
+    SpectrumStage(I_STREAM_READER* inner,
+                  const SpectrumOpts& opts = SpectrumOpts(),
+                  const IqStageOpts& iq = IqStageOpts(),
+                  bool own_inner = false)
+        : conv_(inner, iq, own_inner)
+        , engine_(opts)
+    {
+    }
+
+    // Read and process one chunk. Returns false at end of stream.
+    // Reader exceptions (ReadTimeout, SocketError) propagate.
+    bool step() {
+        const cf32* s;
+        size_t n = conv_.read_iq(s);
+        engine_.push(s, n);
+        samples_ += n;
+        return conv_.get_last_raw_size() > 0;
+    }
+
+    // Process until end of stream or stop; receive timeouts are waited out
+    uint64_t run(const std::atomic<bool>& stop) {
+        while (!stop.load(std::memory_order_relaxed)) {
+            try {
+                if (!step()) {
+                    break;
+                }
+            } catch (const ReadTimeout&) {
+                continue;
+            }
+        }
+        return samples_;
+    }
+
+    SpectrumEngine& get_engine() noexcept { return engine_; }
+    IqConvertReader& get_converter() noexcept { return conv_; }
+    uint64_t get_sample_count() const noexcept { return samples_; }
+};
@@ -2,8 +2,77 @@
 #pragma once
 #include "stream_reader.hpp"
 #include <cstdio>
+#include <cstdint>
 #include <string>
 #include <filesystem>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+
+// No data within the reader's timeout (sockets, pipeline stages)
+class ReadTimeout : public std::runtime_error {
+public:
+    explicit ReadTimeout(const std::string& msg) : std::runtime_error(msg) {}
+};
+
+// Segment flags
+constexpr uint32_t SEG_TRUNCATED = 1u << 0;  // datagram was larger than its slot
+constexpr uint32_t SEG_FILLED    = 1u << 1;  // zeroed placeholder for a lost datagram
+constexpr uint32_t SEG_REORDERED = 1u << 2;  // arrived after a later sequence number
+
+// Boundary of one datagram inside a chunk returned by read_into()
+struct ChunkSegment {
+    size_t offset;   // byte offset in caller's buffer
+    size_t length;   // payload bytes
+    uint32_t flags;  // SEG_* bits
+};
+
+// Origin of a receive timestamp
+enum class TsSource : uint8_t {
+    NONE,      // not collected / not available
+    SOFTWARE,  // kernel receive time (CLOCK_REALTIME)
+    HARDWARE,  // NIC clock (raw PHC time)
+};
+
+// Receive metadata of one datagram; entry i belongs to segment i
+struct PacketMeta {
+    uint64_t ts_ns;       // receive timestamp, ns since epoch of ts_source's clock, 0 = none
+    TsSource ts_source;
+    uint32_t src_ip;      // IPv4 source address, host byte order, 0 = unknown
+    uint16_t src_port;    // host byte order
+    uint32_t flags;       // SEG_* bits of the matching segment
+    uint8_t src_ip6[16];  // IPv6 source (src_ip = 0 then), all zero for IPv4
+};
+
+// Read-only view into reader-owned memory (zero-copy APIs)
+struct ByteView {
+    const uint8_t* data;
+    size_t size;
+};
+
+// Outcome of try_read_into()
+enum class ReadStatus : uint8_t {
+    OK,           // size bytes delivered
+    WOULD_BLOCK,  // non-blocking reader, nothing queued: wait for get_native_handle()
+    TIMEOUT,      // nothing within the reader's timeout
+    END,          // end of stream (file EOF, pipeline drained)
+    INTERRUPTED,  // receive interrupted by a signal (Ctrl+C), nothing read
+};
+
+struct ReadResult {
+    ReadStatus status;
+    size_t size;
+};
+
+// OS handle a reader can be waited on (epoll / poll / WSAPoll)
+#ifdef _WIN32
+using native_handle_t = uintptr_t;  // SOCKET, or an event HANDLE for Npcap
+#else
+using native_handle_t = int;
+#endif
+constexpr native_handle_t INVALID_NATIVE_HANDLE = static_cast<native_handle_t>(-1);
+
+struct ReaderStats;  // reader_stats.hpp
 
 class I_STREAM_READER {
 public:
@@ -22,4 +91,116 @@ public:
     {
         return "<UNK>";
     };
-};
\ No newline at end of file
+
+    // Datagram boundaries of the last read_into() result
+    // Returns: segment count, 0 if the reader does not track boundaries
+    virtual size_t get_segments(const ChunkSegment*& segs) const noexcept
+    {
+        segs = nullptr;
+        return 0;
+    }
+
+    // Per-datagram metadata of the last read_into() result, parallel to get_segments()
+    // Returns: entry count, 0 if the reader does not collect metadata
+    virtual size_t get_packet_meta(const PacketMeta*& meta) const noexcept
+    {
+        meta = nullptr;
+        return 0;
+    }
+
+    // Snapshot of the hot-path counters (builds with DATASTREAM_STATS);
+    // safe to call from a monitoring thread while another thread reads.
+    // Returns: false if the reader is not instrumented
+    virtual bool get_stats(ReaderStats& st) const noexcept
+    {
+        (void)st;
+        return false;
+    }
+
+    // Non-throwing read_into() for the hot path: idle intervals, end of
+    // stream and signals come back as a status; malformed frames are
+    // counted and skipped. Throws only on fatal errors (socket / disk I/O).
+    // Non-blocking socket readers (SocketReaderOpts::nonblocking) return
+    // WOULD_BLOCK right away instead of waiting.
+    // Default: wraps read_into(), a 0-byte read is END.
+    virtual ReadResult try_read_into(uint8_t* buff_ptr)
+    {
+        try {
+            size_t rd = read_into(buff_ptr);
+            return ReadResult{rd ? ReadStatus::OK : ReadStatus::END, rd};
+        } catch (const ReadTimeout&) {
+            return ReadResult{ReadStatus::TIMEOUT, 0};
+        }
+    }
+
+    // Handle that turns readable when try_read_into() may return data.
+    // Readers can hold data the handle no longer signals, so after a wakeup
+    // read until WOULD_BLOCK. INVALID_NATIVE_HANDLE: not pollable.
+    virtual native_handle_t get_native_handle() const noexcept
+    {
+        return INVALID_NATIVE_HANDLE;
+    }
+
+    // read_into() plus the metadata gathered in the same receive pass
+    size_t read_with_meta(uint8_t* buff_ptr, const PacketMeta*& meta, size_t& meta_count)
+    {
+        size_t rd = read_into(buff_ptr);
+        meta_count = get_packet_meta(meta);
+        return rd;
+    }
+};
+
+// Inner reader of a decorator stage (SeqTrackingReader, IqConvertReader).
+// ReaderRef: any I_STREAM_READER behind a pointer, optionally owned;
+// every call goes through the vtable (stages composed at run time).
+class ReaderRef {
+private:
+    I_STREAM_READER* r_;
+    bool own_;
+
+public:
+    explicit ReaderRef(I_STREAM_READER* r, bool own = false) noexcept : r_(r), own_(own) {}
+
+    ~ReaderRef() {
+        if (own_) {
+            delete r_;
+        }
+    }
+
+    ReaderRef(const ReaderRef&) = delete;
+    ReaderRef& operator=(const ReaderRef&) = delete;
+
+    I_STREAM_READER* get() const noexcept { return r_; }
+
+    size_t read_into(uint8_t* buff_ptr) { return r_->read_into(buff_ptr); }
+    size_t get_chunk_size() const noexcept { return r_->get_chunk_size(); }
+    std::string get_type() const noexcept { return r_->get_type(); }
+    size_t get_segments(const ChunkSegment*& segs) const noexcept { return r_->get_segments(segs); }
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept { return r_->get_packet_meta(meta); }
+    bool get_stats(ReaderStats& st) const noexcept { return r_->get_stats(st); }
+};
+
+// ReaderValue<R>: the inner reader held by value, built in place from the
+// stage's constructor arguments. Calls are qualified (R::read_into), so they
+// bind statically and can be inlined into the stage (see pipeline.hpp).
+template<class R>
+class ReaderValue {
+    static_assert(std::is_base_of<I_STREAM_READER, R>::value, "ReaderValue: R must be an I_STREAM_READER");
+
+private:
+    R r_;
+
+public:
+    template<class... A>
+    explicit ReaderValue(A&&... args) : r_(std::forward<A>(args)...) {}
+
+    R* get() noexcept { return &r_; }
+    const R* get() const noexcept { return &r_; }
+
+    size_t read_into(uint8_t* buff_ptr) { return r_.R::read_into(buff_ptr); }
+    size_t get_chunk_size() const noexcept { return r_.R::get_chunk_size(); }
+    std::string get_type() const noexcept { return r_.R::get_type(); }
+    size_t get_segments(const ChunkSegment*& segs) const noexcept { return r_.R::get_segments(segs); }
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept { return r_.R::get_packet_meta(meta); }
+    bool get_stats(ReaderStats& st) const noexcept { return r_.R::get_stats(st); }
+};
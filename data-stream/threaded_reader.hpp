@@ -0,0 +1,372 @@
+// threaded_reader.hpp
+#pragma once
+#include "stream_reader.hpp"
+#include "chunk_pool.hpp"
+#include "cpu_placement.hpp"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <string>
+#include <iostream>
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+struct ThreadedReaderOpts {
+    size_t depth = 8;           // preallocated chunk buffers in the ring
+    int cpu = -1;               // pin capture thread to this CPU, -1 = no pinning,
+                                // CPU_FOLLOW_RX = where the inner socket's packets arrive
+    int rt_priority = 0;        // > 0: capture thread SCHED_FIFO priority (see set_thread_rt_priority)
+    int numa_node = -1;         // own pool memory on this node, -1 = OS default
+    bool eof_on_empty = true;   // stop capturing after a 0-byte read (file EOF)
+    ChunkPool* pool = nullptr;  // shared pool (chunk size >= inner's); nullptr = own pool of 2 * depth
+};
+
+// Chunk lent by ThreadedStreamReader::acquire(), valid until release()
+struct BorrowedChunk {
+    const uint8_t* data;
+    size_t size;
+    const ChunkSegment* segs;
+    size_t seg_count;
+    const PacketMeta* meta;  // parallel to segs when the inner reader collects metadata
+    size_t meta_count;
+};
+
+// Decorator: runs the wrapped reader's blocking read_into() on a dedicated
+// (optionally pinned) capture thread and publishes filled chunks through a
+// lock-free single-producer/single-consumer ring of preallocated buffers.
+// The consumer borrows buffers (acquire/release), takes ownership of pool
+// chunks (acquire_chunk) or copies (read_into). Chunks taken from an own
+// pool must be dropped before the reader is destroyed.
+// Inner ReadTimeout is forwarded in order; other exceptions are rethrown
+// on the consumer side after the chunks captured before them.
+// The inner reader should have a finite timeout so ~ThreadedStreamReader() can join.
+class ThreadedStreamReader : public I_STREAM_READER {
+private:
+    enum class SlotKind : uint8_t { DATA, TIMEOUT };
+
+    struct Slot {
+        ChunkPool::Chunk chunk;
+        SlotKind kind = SlotKind::DATA;
+        std::vector<ChunkSegment> segs;
+        std::vector<PacketMeta> meta;
+        bool released = false;  // consumer side: done with, waiting for the older ones
+    };
+
+    I_STREAM_READER* inner_;
+    bool own_inner_;
+    ThreadedReaderOpts opts_;
+    size_t chunk_size_;
+    std::unique_ptr<ChunkPool> own_pool_;  // declared before slots_: outlives their chunks
+    ChunkPool* pool_;
+    std::vector<Slot> slots_;
+
+    // Ring indices (monotonic counters, slot = index % depth)
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};  // published by producer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};  // released by consumer
+    alignas(CACHE_LINE_SIZE) size_t acquired_ = 0;          // consumer cursor (head_ >= acquired_ >= tail_)
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> finished_{false};
+    std::exception_ptr error_;
+    std::atomic<uint64_t> ring_full_count_{0};
+    std::atomic<uint64_t> pool_empty_count_{0};
+
+    // Slow-path doorbell: only touched when a side has to park
+    std::mutex park_mtx_;
+    std::condition_variable park_cv_;
+    std::atomic<int> parked_{0};
+
+    std::vector<ChunkSegment> last_segs_;  // segments of the last read_into()
+    std::vector<PacketMeta> last_meta_;
+    std::thread worker_;
+
+    void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // pairs with wait_for()
+        if (parked_.load(std::memory_order_seq_cst) != 0) {
+            std::lock_guard<std::mutex> lk(park_mtx_);
+            park_cv_.notify_all();
+        }
+    }
+
+    // Spin briefly, then park until pred() holds
+    template<class Pred>
+    void wait_for(Pred pred) {
+        for (int i = 0; i < 256; ++i) {
+            if (pred()) {
+                return;
+            }
+            if (i >= 64) {
+                std::this_thread::yield();
+            }
+        }
+        std::unique_lock<std::mutex> lk(park_mtx_);
+        parked_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // publish before re-checking pred
+        park_cv_.wait(lk, pred);
+        parked_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // Move onto the CPU that received the inner socket's last packet; true once known
+    bool follow_rx_cpu() {
+        int cpu = socket_incoming_cpu(inner_->get_native_handle());
+        if (cpu < 0) {
+            return false;
+        }
+        if (!pin_this_thread_to_cpu(cpu)) {
+            std::cerr << "Warning: Failed to pin capture thread to receive CPU " << cpu << "\n";
+        }
+        return true;
+    }
+
+    void capture_loop() {
+        const size_t depth = slots_.size();
+        // CPU_FOLLOW_RX: reads left to learn the receive CPU (raw sockets may never report one)
+        unsigned follow_rx = opts_.cpu == CPU_FOLLOW_RX && inner_->get_native_handle() != INVALID_NATIVE_HANDLE ? 64 : 0;
+        try {
+            while (!stop_.load(std::memory_order_relaxed)) {
+                size_t h = head_.load(std::memory_order_relaxed);
+                if (h - tail_.load(std::memory_order_acquire) >= depth) {
+                    ring_full_count_.fetch_add(1, std::memory_order_relaxed);
+                    wait_for([&] {
+                        return h - tail_.load(std::memory_order_acquire) < depth ||
+                               stop_.load(std::memory_order_relaxed);
+                    });
+                    continue;
+                }
+
+                Slot& s = slots_[h % depth];
+                if (!s.chunk) {
+                    // Slot's chunk was taken by acquire_chunk(): get a fresh one
+                    s.chunk = pool_->acquire(50);
+                    if (!s.chunk) {
+                        pool_empty_count_.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+                }
+                try {
+                    s.chunk.set_size(inner_->read_into(s.chunk.data()));
+                    s.kind = SlotKind::DATA;
+                    if (follow_rx && s.chunk.size() > 0) {
+                        follow_rx = follow_rx_cpu() ? 0 : follow_rx - 1;
+                    }
+                } catch (const ReadTimeout&) {
+                    s.chunk.set_size(0);
+                    s.kind = SlotKind::TIMEOUT;
+                }
+                const ChunkSegment* segs;
+                size_t n = inner_->get_segments(segs);
+                s.segs.assign(segs, segs + n);
+                const PacketMeta* meta;
+                size_t m = inner_->get_packet_meta(meta);
+                s.meta.assign(meta, meta + m);
+
+                head_.store(h + 1, std::memory_order_release);
+                wake();
+
+                if (s.kind == SlotKind::DATA && s.chunk.size() == 0 && opts_.eof_on_empty) {
+                    break;
+                }
+            }
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+        finished_.store(true, std::memory_order_release);
+        wake();
+    }
+
+    // Consumer: mark slot idx done, then hand back the contiguous run of done
+    // slots from the oldest outstanding one. A slot is never recycled while
+    // an older borrow is still held.
+    void retire(size_t idx) {
+        slots_[idx % slots_.size()].released = true;
+        size_t t = tail_.load(std::memory_order_relaxed);
+        const size_t t0 = t;
+        while (t != acquired_ && slots_[t % slots_.size()].released) {
+            slots_[t % slots_.size()].released = false;
+            ++t;
+        }
+        if (t != t0) {
+            tail_.store(t, std::memory_order_release);
+            wake();
+        }
+    }
+
+public:
+    ThreadedStreamReader(I_STREAM_READER* inner,
+                         const ThreadedReaderOpts& opts = ThreadedReaderOpts(),
+                         bool own_inner = false)
+        : inner_(inner)
+        , own_inner_(own_inner)
+        , opts_(opts)
+        , chunk_size_(inner->get_chunk_size())
+        , pool_(opts.pool)
+    {
+        size_t depth = opts_.depth ? opts_.depth : 1;
+        if (!pool_) {
+            ChunkPoolOpts po;
+            po.numa_node = opts_.numa_node;
+            own_pool_.reset(new ChunkPool(chunk_size_, 2 * depth, po));
+            pool_ = own_pool_.get();
+        } else if (pool_->chunk_size() < chunk_size_) {
+            throw std::runtime_error("[ThreadedStreamReader] Pool chunk size " +
+                                     std::to_string(pool_->chunk_size()) + " < reader chunk size " +
+                                     std::to_string(chunk_size_));
+        }
+        slots_.resize(depth);
+        worker_ = std::thread(&ThreadedStreamReader::capture_loop, this);
+        if (opts_.cpu >= 0 && !pin_thread_to_cpu(worker_, opts_.cpu)) {
+            std::cerr << "Warning: Failed to pin capture thread to CPU " << opts_.cpu << "\n";
+        }
+        if (opts_.rt_priority > 0 && !set_thread_rt_priority(worker_, opts_.rt_priority)) {
+            std::cerr << "Warning: Failed to set SCHED_FIFO priority " << opts_.rt_priority
+                      << " for capture thread (needs CAP_SYS_NICE / rtprio limit)\n";
+        }
+    }
+
+    ~ThreadedStreamReader() override {
+        stop();
+        if (own_inner_) {
+            delete inner_;
+        }
+    }
+
+    ThreadedStreamReader(const ThreadedStreamReader&) = delete;
+    ThreadedStreamReader& operator=(const ThreadedStreamReader&) = delete;
+
+    // Stop capturing and join (waits for the inner read in progress)
+    void stop() {
+        stop_.store(true, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lk(park_mtx_);
+            park_cv_.notify_all();
+        }
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    // Borrow the next filled chunk (blocks). Returns false at end of stream.
+    // Throws ReadTimeout / the capture thread's exception in stream order.
+    bool acquire(BorrowedChunk& out) {
+        wait_for([&] {
+            return head_.load(std::memory_order_acquire) != acquired_ ||
+                   finished_.load(std::memory_order_acquire);
+        });
+        if (head_.load(std::memory_order_acquire) == acquired_) {
+            if (error_) {
+                std::rethrow_exception(error_);
+            }
+            return false;
+        }
+        Slot& s = slots_[acquired_ % slots_.size()];
+        ++acquired_;
+        if (s.kind == SlotKind::TIMEOUT) {
+            retire(acquired_ - 1);
+            throw ReadTimeout("Capture thread: receive timeout expired");
+        }
+        out.data = s.chunk.data();
+        out.size = s.chunk.size();
+        out.segs = s.segs.data();
+        out.seg_count = s.segs.size();
+        out.meta = s.meta.data();
+        out.meta_count = s.meta.size();
+        return true;
+    }
+
+    // Take ownership of the next filled pool chunk (no copy); the chunk
+    // returns to the pool when the handle is dropped. Same blocking and
+    // exception semantics as acquire(). segs / meta: optional datagram tables.
+    // Not to be mixed with outstanding acquire() borrows.
+    bool acquire_chunk(ChunkPool::Chunk& out, std::vector<ChunkSegment>* segs = nullptr,
+                       std::vector<PacketMeta>* meta = nullptr) {
+        if (tail_.load(std::memory_order_relaxed) != acquired_) {
+            throw std::logic_error("[ThreadedStreamReader] acquire_chunk() with borrowed chunks outstanding");
+        }
+        BorrowedChunk c;
+        if (!acquire(c)) {
+            return false;
+        }
+        Slot& s = slots_[(acquired_ - 1) % slots_.size()];
+        out = std::move(s.chunk);
+        if (segs) {
+            segs->swap(s.segs);
+        }
+        if (meta) {
+            meta->swap(s.meta);
+        }
+        release();
+        return true;
+    }
+
+    // Return the oldest borrowed chunk to the capture thread
+    void release() {
+        for (size_t i = tail_.load(std::memory_order_relaxed); i != acquired_; ++i) {
+            if (!slots_[i % slots_.size()].released) {
+                retire(i);
+                return;
+            }
+        }
+        // nothing borrowed
+    }
+
+    size_t read_into(uint8_t* buff_ptr) override {
+        BorrowedChunk c;
+        if (!acquire(c)) {
+            last_segs_.clear();
+            last_meta_.clear();
+            return 0;
+        }
+        std::memcpy(buff_ptr, c.data, c.size);
+        last_segs_.assign(c.segs, c.segs + c.seg_count);
+        last_meta_.assign(c.meta, c.meta + c.meta_count);
+        release();
+        return c.size;
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_size_; }
+
+    std::string get_type() const noexcept override {
+        return "threaded(" + inner_->get_type() + ")";
+    }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = last_segs_.data();
+        return last_segs_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = last_meta_.data();
+        return last_meta_.size();
+    }
+
+    bool get_stats(ReaderStats& st) const noexcept override { return inner_->get_stats(st); }
+
+    // Chunks waiting for the consumer
+    size_t get_backlog() const noexcept {
+        return head_.load(std::memory_order_acquire) - acquired_;
+    }
+
+    // acquire() would return without blocking
+    bool is_ready() const noexcept {
+        return head_.load(std::memory_order_acquire) != acquired_ ||
+               finished_.load(std::memory_order_acquire);
+    }
+
+    // Times the capture thread found the ring full (consumer too slow)
+    uint64_t get_ring_full_count() const noexcept {
+        return ring_full_count_.load(std::memory_order_relaxed);
+    }
+
+    // Times the capture thread waited for a free pool chunk
+    uint64_t get_pool_empty_count() const noexcept {
+        return pool_empty_count_.load(std::memory_order_relaxed);
+    }
+
+    ChunkPool* get_pool() const noexcept { return pool_; }
+    I_STREAM_READER* get_inner() const noexcept { return inner_; }
+};
@@ -0,0 +1,414 @@
+// tpacket_reader.hpp
+#pragma once
+
+#include "socket_common.hpp"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <poll.h>
+#include <chrono>
+
+// Raw capture engine on a PACKET_MMAP TPACKET_V3 RX ring (Linux only).
+// Frames are parsed in place inside ring blocks; a block is handed back
+// to the kernel once every frame in it has been consumed.
+class TpacketReader : public I_STREAM_READER {
+private:
+    int sock_fd_;
+    std::string ip_;
+    uint16_t port_;
+    std::string dev_;
+    int32_t timeout_ms_;
+    size_t chunk_size_;
+    SocketReaderOpts opts_;
+    std::unique_ptr<MulticastMembership> mcast_;  // group join when ip is multicast
+
+    // Mapped RX ring
+    uint8_t* ring_ = nullptr;
+    size_t ring_size_ = 0;
+    struct tpacket_req3 req_;
+
+    // Ring walk state
+    uint32_t block_idx_ = 0;
+    struct tpacket_block_desc* cur_block_ = nullptr;  // block owned by user space
+    struct tpacket3_hdr* next_pkt_ = nullptr;
+    uint32_t pkts_left_ = 0;
+    bool retire_pending_ = false;  // last frame of cur_block_ handed out
+
+    // Payload that did not fit into the previous chunk
+    bool have_held_ = false;
+    ByteView held_;
+    uint32_t held_flags_ = 0;
+    PacketMeta held_meta_{};
+
+    std::vector<ChunkSegment> segments_;
+    std::vector<PacketMeta> meta_;  // parallel to segments_ when opts_.wants_meta()
+    uint64_t truncated_count_ = 0;
+    uint64_t bad_frame_count_ = 0;   // runt / malformed frames skipped
+    ReaderCounters counters_;
+    mutable std::atomic<uint64_t> packet_drops_{0};  // PACKET_STATISTICS accumulated by get_stats
+
+    [[noreturn]] void fail(const std::string& msg) {
+        std::string err = get_last_socket_error();
+        release();
+        throw SocketError(msg + ": " + err);
+    }
+
+    void release() noexcept {
+        if (ring_) {
+            munmap(ring_, ring_size_);
+            ring_ = nullptr;
+        }
+        if (sock_fd_ != INVALID_SOCKET_FD) {
+            close_socket(sock_fd_);
+            sock_fd_ = INVALID_SOCKET_FD;
+        }
+    }
+
+    void setup_ring() {
+        sock_fd_ = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+        if (sock_fd_ == INVALID_SOCKET_FD) {
+            throw SocketError("Failed to create socket: " + get_last_socket_error());
+        }
+
+        int version = TPACKET_V3;
+        if (setsockopt(sock_fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) == -1) {
+            fail("Failed to select TPACKET_V3");
+        }
+
+        try {
+            attach_udp_filter(sock_fd_, ip_, port_);
+        } catch (const SocketError&) {
+            release();
+            throw;
+        }
+
+        // Ring frames always carry a software timestamp; ask for the NIC clock instead
+        if (opts_.timestamps == TimestampMode::HARDWARE) {
+            if (!enable_nic_rx_timestamps(sock_fd_, dev_)) {
+                std::cerr << "Warning: NIC receive timestamping not enabled on " << dev_
+                          << " (" << get_last_socket_error() << "). Falling back to software timestamps.\n";
+            }
+            int ts_flags = SOF_TIMESTAMPING_RAW_HARDWARE;
+            if (setsockopt(sock_fd_, SOL_PACKET, PACKET_TIMESTAMP, &ts_flags, sizeof(ts_flags)) == -1) {
+                fail("Failed to set PACKET_TIMESTAMP");
+            }
+        }
+
+        std::memset(&req_, 0, sizeof(req_));
+        req_.tp_block_size = opts_.ring_block_size;
+        req_.tp_block_nr = opts_.ring_block_count;
+        req_.tp_frame_size = opts_.ring_frame_size;
+        req_.tp_frame_nr = (opts_.ring_block_size / opts_.ring_frame_size) * opts_.ring_block_count;
+        req_.tp_retire_blk_tov = opts_.ring_block_tov_ms;
+        if (setsockopt(sock_fd_, SOL_PACKET, PACKET_RX_RING, &req_, sizeof(req_)) == -1) {
+            fail("Failed to set up PACKET_RX_RING (" + std::to_string(req_.tp_block_nr) + " x " +
+                 std::to_string(req_.tp_block_size) + " B)");
+        }
+
+        ring_size_ = static_cast<size_t>(req_.tp_block_size) * req_.tp_block_nr;
+        void* ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, sock_fd_, 0);
+        if (ring == MAP_FAILED) {
+            fail("Failed to mmap RX ring");
+        }
+        ring_ = static_cast<uint8_t*>(ring);
+
+        // Bind to interface (after ring setup, so the ring sees the first frame)
+        unsigned int ifindex = if_nametoindex(dev_.c_str());
+        if (ifindex == 0) {
+            fail("Failed to get interface index for " + dev_);
+        }
+        struct sockaddr_ll sll;
+        std::memset(&sll, 0, sizeof(sll));
+        sll.sll_family = AF_PACKET;
+        sll.sll_ifindex = static_cast<int>(ifindex);
+        sll.sll_protocol = htons(ETH_P_ALL);
+        if (bind(sock_fd_, (struct sockaddr*)&sll, sizeof(sll)) == -1) {
+            fail("Failed to bind raw socket");
+        }
+
+        if (opts_.fanout_group) {
+            try {
+                join_fanout_group(sock_fd_, opts_);
+            } catch (const SocketError&) {
+                release();
+                throw;
+            }
+        }
+    }
+
+    struct tpacket_block_desc* block_at(uint32_t idx) const noexcept {
+        return reinterpret_cast<struct tpacket_block_desc*>(
+            ring_ + static_cast<size_t>(idx) * req_.tp_block_size);
+    }
+
+    void retire_block() noexcept {
+        __atomic_store_n(&cur_block_->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        cur_block_ = nullptr;
+        block_idx_ = (block_idx_ + 1) % req_.tp_block_nr;
+    }
+
+    // Next frame in place. Returns 1 - frame ready, 0 - ring empty (wait == false),
+    // -1 - interrupted, -2 - nothing within timeout_ms_.
+    int next_frame(bool wait, const struct tpacket3_hdr*& hdr) {
+        if (retire_pending_) {
+            retire_block();
+            retire_pending_ = false;
+        }
+        std::chrono::steady_clock::time_point deadline{};
+        while (cur_block_ == nullptr) {
+            struct tpacket_block_desc* bd = block_at(block_idx_);
+            if (__atomic_load_n(&bd->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) {
+                cur_block_ = bd;
+                pkts_left_ = bd->hdr.bh1.num_pkts;
+                next_pkt_ = reinterpret_cast<struct tpacket3_hdr*>(
+                    reinterpret_cast<uint8_t*>(bd) + bd->hdr.bh1.offset_to_first_pkt);
+                if (pkts_left_ == 0) {
+                    retire_block();
+                }
+                continue;
+            }
+            if (!wait) {
+                return 0;
+            }
+            if (opts_.busy_wait) {
+                // Watch the block status word instead of sleeping in poll()
+                // (latency is still bounded below by ring_block_tov_ms)
+                auto now = std::chrono::steady_clock::now();
+                if (deadline == std::chrono::steady_clock::time_point{}) {
+                    deadline = now + std::chrono::milliseconds(timeout_ms_);
+                }
+                if (timeout_ms_ > 0 && now >= deadline) {
+                    return -2;
+                }
+                spin_pause();
+                continue;
+            }
+            struct pollfd pfd;
+            pfd.fd = sock_fd_;
+            pfd.events = POLLIN | POLLERR;
+            pfd.revents = 0;
+            int rc = poll(&pfd, 1, timeout_ms_ > 0 ? timeout_ms_ : -1);
+            if (rc == 0) {
+                return -2;
+            }
+            if (rc == -1) {
+                if (errno == EINTR) {
+                    return -1;  // Interrupted (Ctrl+C)
+                }
+                throw SocketError("poll() failed: " + get_last_socket_error());
+            }
+        }
+
+        hdr = next_pkt_;
+        if (--pkts_left_ == 0) {
+            retire_pending_ = true;  // keep block mapped for the caller's view
+        } else {
+            next_pkt_ = reinterpret_cast<struct tpacket3_hdr*>(
+                reinterpret_cast<uint8_t*>(next_pkt_) + next_pkt_->tp_next_offset);
+        }
+        return 1;
+    }
+
+    // Next UDP payload for port_, same return codes as next_frame()
+    // meta: optional, filled from the frame header (timestamp) and IP/UDP headers
+    int next_udp(bool wait, ByteView& out, uint32_t& flags, PacketMeta* meta = nullptr) {
+        if (have_held_) {
+            have_held_ = false;
+            out = held_;
+            flags = held_flags_;
+            if (meta) {
+                *meta = held_meta_;
+            }
+            return 1;
+        }
+        while (true) {
+            const struct tpacket3_hdr* hdr;
+            int rc = next_frame(wait, hdr);
+            if (rc != 1) {
+                return rc;
+            }
+            const uint8_t* frame = reinterpret_cast<const uint8_t*>(hdr) + hdr->tp_mac;
+            const uint8_t* payload;
+            size_t payload_len;
+            FrameStatus st = parse_udp_frame(frame, hdr->tp_snaplen, port_, payload, payload_len);
+            if (st != FrameStatus::OK) {
+                bad_frame_count_ += st != FrameStatus::WRONG_PORT;
+                count_rejected_frame(counters_, st);
+                continue;  // runt or foreign frame
+            }
+            out.data = payload;
+            out.size = payload_len;
+            flags = (hdr->tp_snaplen < hdr->tp_len) ? SEG_TRUNCATED : 0;
+            if (meta) {
+                meta->ts_ns = uint64_t(hdr->tp_sec) * 1000000000ull + hdr->tp_nsec;
+                meta->ts_source = (hdr->tp_status & TP_STATUS_TS_RAW_HARDWARE) ? TsSource::HARDWARE
+                                : (hdr->tp_status & TP_STATUS_TS_SOFTWARE)     ? TsSource::SOFTWARE
+                                : (meta->ts_ns ? TsSource::SOFTWARE : TsSource::NONE);
+                udp_frame_source(frame, payload, *meta);
+                meta->flags = flags;
+            }
+            return 1;
+        }
+    }
+
+public:
+    TpacketReader(const std::string& ip,
+                  uint16_t port,
+                  const std::string& dev,
+                  int32_t timeout_ms,
+                  size_t chunk_size,
+                  const SocketReaderOpts& opts = SocketReaderOpts())
+        : sock_fd_(INVALID_SOCKET_FD)
+        , ip_(ip)
+        , port_(port)
+        , dev_(dev)
+        , timeout_ms_(timeout_ms)
+        , chunk_size_(chunk_size)
+        , opts_(opts)
+        , mcast_(capture_membership(ip, dev, opts))
+    {
+        {
+            // Ring pages are allocated by the kernel under the calling thread's policy
+            const int node = resolve_numa_node(opts_.numa_node, dev_);
+            ScopedNumaPolicy numa(node);
+            if (node >= 0 && !numa.active()) {
+                std::cerr << "Warning: Failed to place TPACKET ring on NUMA node " << node << "\n";
+            }
+            setup_ring();
+        }
+        segments_.reserve(opts_.batch > 1 ? opts_.batch : 1);
+        if (opts_.wants_meta()) {
+            meta_.reserve(segments_.capacity());
+        }
+    }
+
+    ~TpacketReader() override { release(); }
+
+    // Delete copy/move (socket + ring ownership)
+    TpacketReader(const TpacketReader&) = delete;
+    TpacketReader& operator=(const TpacketReader&) = delete;
+    TpacketReader(TpacketReader&&) = delete;
+    TpacketReader& operator=(TpacketReader&&) = delete;
+
+    size_t get_chunk_size() const noexcept override { return chunk_size_; }
+    std::string get_type() const noexcept override { return "SocketReader<TPACKET>"; }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = meta_.data();
+        return meta_.size();
+    }
+
+    uint64_t get_truncated_count() const noexcept { return truncated_count_; }
+    uint64_t get_bad_frame_count() const noexcept { return bad_frame_count_; }
+    size_t get_ring_size() const noexcept { return ring_size_; }
+
+    // Zero-copy: next payload in place inside the ring.
+    // The view stays valid until the next next_payload()/read_into() call.
+    // Returns false if interrupted; throws ReadTimeout on idle timeout.
+    // meta: optional receive metadata of the payload (timestamp from the ring header).
+    bool next_payload(ByteView& out, PacketMeta* meta = nullptr) {
+        uint32_t flags;
+        int rc = next_udp(true, out, flags, meta);
+        if (rc == -2) {
+            throw ReadTimeout("Socket receive timeout expired");
+        }
+        if (rc != 1) {
+            return false;
+        }
+        if (flags & SEG_TRUNCATED) {
+            ++truncated_count_;
+        }
+        return true;
+    }
+
+private:
+    // Copies one payload (batch <= 1) or as many ready payloads as fit,
+    // up to opts.batch, back-to-back into buff. wait: block for the first one.
+    size_t read_chunk(uint8_t* buff, bool wait, ReadStatus& st) {
+        segments_.clear();
+        meta_.clear();
+        const bool want_meta = opts_.wants_meta();
+        const size_t max_segs = opts_.batch > 1 ? opts_.batch : 1;
+        size_t pos = 0;
+        st = ReadStatus::OK;
+        while (segments_.size() < max_segs) {
+            ByteView v;
+            uint32_t flags;
+            PacketMeta m{};
+            int rc = next_udp(wait && segments_.empty(), v, flags, want_meta ? &m : nullptr);
+            if (rc != 1) {
+                if (segments_.empty()) {
+                    st = rc == 0 ? ReadStatus::WOULD_BLOCK : rc == -2 ? ReadStatus::TIMEOUT : ReadStatus::INTERRUPTED;
+                }
+                break;  // ring drained (or interrupted before the first payload)
+            }
+            size_t len = v.size;
+            if (pos + len > chunk_size_) {
+                if (pos > 0) {
+                    // Keep it for the next chunk (block stays owned until then)
+                    have_held_ = true;
+                    held_ = v;
+                    held_flags_ = flags;
+                    held_meta_ = m;
+                    break;
+                }
+                len = chunk_size_;
+                flags |= SEG_TRUNCATED;
+            }
+            if (flags & SEG_TRUNCATED) {
+                ++truncated_count_;
+            }
+            std::memcpy(buff + pos, v.data, len);
+            segments_.push_back({pos, len, flags});
+            if (want_meta) {
+                m.flags = flags;
+                meta_.push_back(m);
+            }
+            pos += len;
+        }
+        return pos;
+    }
+
+public:
+    size_t read_into(uint8_t* buff) override {
+        return counters_.timed_read(*this, [&]() {
+            ReadStatus st;
+            size_t rd = read_chunk(buff, true, st);
+            if (st == ReadStatus::TIMEOUT) {
+                throw ReadTimeout("Socket receive timeout expired");
+            }
+            return rd;
+        });
+    }
+
+    ReadResult try_read_into(uint8_t* buff) override {
+        return counters_.timed_try_read(*this, [&]() {
+            ReadStatus st;
+            size_t rd = read_chunk(buff, !opts_.nonblocking, st);
+            return ReadResult{st, rd};
+        });
+    }
+
+    // Readable (POLLIN) once the kernel hands a block to user space
+    native_handle_t get_native_handle() const noexcept override { return sock_fd_; }
+
+    bool get_stats(ReaderStats& st) const noexcept override {
+        if (!ReaderCounters::enabled) {
+            return false;
+        }
+        counters_.snapshot(st);
+        uint64_t drops = 0;
+        if (read_packet_drops(sock_fd_, drops)) {
+            st.kernel_drops = packet_drops_.fetch_add(drops, std::memory_order_relaxed) + drops;
+            st.kernel_drops_valid = true;
+        }
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,609 @@
+// xdp_reader.hpp
+#pragma once
+
+#include "socket_common.hpp"
+#include "chunk_pool.hpp"
+
+#ifndef _WIN32
+#include <linux/if_xdp.h>
+#include <linux/if_link.h>
+#include <linux/bpf.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <time.h>
+#include <memory>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+namespace xdp_detail {
+
+inline long sys_bpf(int cmd, union bpf_attr& attr) noexcept {
+    return syscall(__NR_bpf, cmd, &attr, sizeof(attr));
+}
+
+inline struct bpf_insn insn(uint8_t code, uint8_t dst, uint8_t src, int16_t off, int32_t imm) noexcept {
+    struct bpf_insn i;
+    std::memset(&i, 0, sizeof(i));
+    i.code = code;
+    i.dst_reg = dst & 0x0F;
+    i.src_reg = src & 0x0F;
+    i.off = off;
+    i.imm = imm;
+    return i;
+}
+
+// XDP program: IPv4/UDP to dst port (and dst address unless 0.0.0.0),
+// first fragments only -> bpf_redirect_map(xsks, rx_queue_index), else XDP_PASS.
+// Packet fields are compared in network byte order as loaded from memory.
+inline std::vector<struct bpf_insn> build_redirect_prog(int map_fd, const std::string& dst_ip, uint16_t port) {
+    bool match_ip = !dst_ip.empty() && dst_ip != "0.0.0.0";
+    struct in_addr addr;
+    addr.s_addr = 0;
+    if (match_ip && inet_pton(AF_INET, dst_ip.c_str(), &addr) != 1) {
+        throw SocketError("Invalid IP address: " + dst_ip);
+    }
+
+    std::vector<struct bpf_insn> p;
+    std::vector<size_t> to_pass;  // jumps patched to the XDP_PASS tail
+    auto jmp_pass = [&](uint8_t code, uint8_t dst, uint8_t src, int32_t imm) {
+        to_pass.push_back(p.size());
+        p.push_back(insn(code, dst, src, 0, imm));
+    };
+    const uint8_t R0 = 0, R1 = 1, R2 = 2, R3 = 3, R4 = 4, R5 = 5, R6 = 6;
+
+    p.push_back(insn(BPF_ALU64 | BPF_MOV | BPF_X, R6, R1, 0, 0));          // r6 = ctx
+    p.push_back(insn(BPF_LDX | BPF_MEM | BPF_W, R2, R1, 0, 0));            // r2 = data
+    p.push_back(insn(BPF_LDX | BPF_MEM | BPF_W, R3, R1, 4, 0));            // r3 = data_end
+    p.push_back(insn(BPF_ALU64 | BPF_MOV | BPF_X, R4, R2, 0, 0));
+    p.push_back(insn(BPF_ALU64 | BPF_ADD | BPF_K, R4, 0, 0, 14 + 20));
+    jmp_pass(BPF_JMP | BPF_JGT | BPF_X, R4, R3, 0);                        // Ethernet + IPv4 present
+    p.push_back(insn(BPF_LDX | BPF_MEM | BPF_H, R5, R2, 12, 0));
+    jmp_pass(BPF_JMP | BPF_JNE | BPF_K, R5, 0, htons(ETH_P_IP));
+    p.push_back(insn(BPF_LDX | BPF_MEM | BPF_B, R5, R2, 14 + 9, 0));
+    jmp_pass(BPF_JMP | BPF_JNE | BPF_K, R5, 0, IPPROTO_UDP);
+    p.push_back(insn(BPF_LDX | BPF_MEM | BPF_H, R5, R2, 14 + 6, 0));
+    p.push_back(insn(BPF_ALU64 | BPF_AND | BPF_K, R5, 0, 0, htons(0x1FFF)));
+    jmp_pass(BPF_JMP | BPF_JNE | BPF_K, R5, 0, 0);                         // fragment offset == 0
+    if (match_ip) {
+        p.push_back(insn(BPF_LDX | BPF_MEM | BPF_W, R5, R2, 14 + 16, 0));
+        jmp_pass(BPF_JMP32 | BPF_JNE | BPF_K, R5, 0, static_cast<int32_t>(addr.s_addr));
+    }
+    p.push_back(insn(BPF_LDX | BPF_MEM | BPF_B, R5, R2, 14, 0));           // IHL
+    p.push_back(insn(BPF_ALU64 | BPF_AND | BPF_K, R5, 0, 0, 0x0F));
+    p.push_back(insn(BPF_ALU64 | BPF_LSH | BPF_K, R5, 0, 0, 2));
+    jmp_pass(BPF_JMP | BPF_JLT | BPF_K, R5, 0, 20);
+    p.push_back(insn(BPF_ALU64 | BPF_ADD | BPF_X, R2, R5, 0, 0));          // r2 = data + IHL
+    p.push_back(insn(BPF_ALU64 | BPF_MOV | BPF_X, R4, R2, 0, 0));
+    p.push_back(insn(BPF_ALU64 | BPF_ADD | BPF_K, R4, 0, 0, 14 + 8));
+    jmp_pass(BPF_JMP | BPF_JGT | BPF_X, R4, R3, 0);                        // UDP header present
+    p.push_back(insn(BPF_LDX | BPF_MEM | BPF_H, R5, R2, 14 + 2, 0));
+    jmp_pass(BPF_JMP | BPF_JNE | BPF_K, R5, 0, htons(port));
+
+    p.push_back(insn(BPF_LDX | BPF_MEM | BPF_W, R2, R6, 16, 0));           // rx_queue_index
+    p.push_back(insn(BPF_LD | BPF_DW | BPF_IMM, R1, BPF_PSEUDO_MAP_FD, 0, map_fd));
+    p.push_back(insn(0, 0, 0, 0, 0));
+    p.push_back(insn(BPF_ALU64 | BPF_MOV | BPF_K, R3, 0, 0, XDP_PASS));    // no socket on this queue
+    p.push_back(insn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map));
+    p.push_back(insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+
+    const size_t pass = p.size();
+    p.push_back(insn(BPF_ALU64 | BPF_MOV | BPF_K, R0, 0, 0, XDP_PASS));
+    p.push_back(insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+    for (size_t j : to_pass) {
+        p[j].off = static_cast<int16_t>(pass - j - 1);
+    }
+    return p;
+}
+
+// Producer / consumer ring shared with the kernel
+struct XskRing {
+    uint32_t* producer = nullptr;
+    uint32_t* consumer = nullptr;
+    uint32_t* flags = nullptr;
+    uint8_t* desc = nullptr;
+    uint32_t mask = 0;
+    void* map = MAP_FAILED;
+    size_t map_len = 0;
+
+    void unmap() noexcept {
+        if (map != MAP_FAILED) {
+            munmap(map, map_len);
+            map = MAP_FAILED;
+        }
+    }
+};
+
+} // namespace xdp_detail
+
+// One datagram lent out by XdpReader::receive(); payload points into the
+// UMEM frame, which goes back to the fill ring once the handle is dropped
+struct XdpDatagram {
+    ChunkPool::Chunk frame;
+    ByteView payload;
+    PacketMeta meta;
+};
+
+// AF_XDP receive engine: the NIC (or the generic XDP hook) writes frames
+// straight into a UMEM carved from a ChunkPool; a small XDP program
+// redirects only the target IPv4/UDP flow of one RX queue to the socket,
+// everything else continues up the normal stack.
+// receive() hands out datagrams as pool chunks without any copy;
+// read_into() is the I_STREAM_READER path and copies payloads into the
+// caller's chunk (up to opts.batch per call). Frames held by the consumer
+// are not available to the NIC: drop them quickly, and before the reader.
+// Needs CAP_NET_ADMIN + CAP_BPF (root) and kernel >= 5.9 (XDP bpf_link).
+class XdpReader : public I_STREAM_READER {
+private:
+    std::string ip_;
+    uint16_t port_;
+    std::string dev_;
+    int32_t timeout_ms_;
+    size_t chunk_size_;
+    SocketReaderOpts opts_;
+    std::unique_ptr<MulticastMembership> mcast_;  // group join when ip is multicast
+    unsigned int ifindex_ = 0;
+
+    std::unique_ptr<ChunkPool> pool_;         // UMEM; declared before frames_: outlives their chunks
+    std::vector<ChunkPool::Chunk> frames_;    // frames currently owned by the kernel, by index
+    int xsk_fd_ = -1;
+    int map_fd_ = -1;
+    int prog_fd_ = -1;
+    int link_fd_ = -1;
+    xdp_detail::XskRing rx_, fill_, comp_;
+    uint32_t ring_size_;
+    std::string mode_name_;
+
+    std::vector<XdpDatagram> pending_;        // received, not yet delivered
+    size_t pending_head_ = 0;
+
+    std::vector<ChunkSegment> segments_;
+    std::vector<PacketMeta> meta_;            // parallel to segments_ when opts_.wants_meta()
+    uint64_t rejected_count_ = 0;
+    ReaderCounters counters_;
+    uint64_t fill_empty_count_ = 0;           // refills that found no free frame in the pool
+
+    [[noreturn]] void fail(const std::string& msg) {
+        std::string err = get_last_socket_error();
+        release();
+        throw SocketError(msg + ": " + err);
+    }
+
+    void release() noexcept {
+        if (link_fd_ != -1) {
+            ::close(link_fd_);  // detaches the XDP program
+            link_fd_ = -1;
+        }
+        if (prog_fd_ != -1) {
+            ::close(prog_fd_);
+            prog_fd_ = -1;
+        }
+        if (map_fd_ != -1) {
+            ::close(map_fd_);
+            map_fd_ = -1;
+        }
+        rx_.unmap();
+        fill_.unmap();
+        comp_.unmap();
+        if (xsk_fd_ != -1) {
+            ::close(xsk_fd_);
+            xsk_fd_ = -1;
+        }
+        pending_.clear();
+        frames_.clear();
+    }
+
+    void map_ring(xdp_detail::XskRing& r, const struct xdp_ring_offset& off, size_t desc_size, off_t pgoff) {
+        r.map_len = off.desc + static_cast<size_t>(ring_size_) * desc_size;
+        r.map = mmap(nullptr, r.map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, xsk_fd_, pgoff);
+        if (r.map == MAP_FAILED) {
+            fail("Failed to mmap AF_XDP ring");
+        }
+        uint8_t* base = static_cast<uint8_t*>(r.map);
+        r.producer = reinterpret_cast<uint32_t*>(base + off.producer);
+        r.consumer = reinterpret_cast<uint32_t*>(base + off.consumer);
+        r.flags = reinterpret_cast<uint32_t*>(base + off.flags);
+        r.desc = base + off.desc;
+        r.mask = ring_size_ - 1;
+    }
+
+    void setup_socket() {
+        ifindex_ = if_nametoindex(dev_.c_str());
+        if (ifindex_ == 0) {
+            throw SocketError("Failed to get interface index for " + dev_ + ": " + get_last_socket_error());
+        }
+        uint32_t fsz = opts_.xdp_frame_size;
+        if (fsz != 2048 && fsz != 4096) {
+            throw SocketError("AF_XDP frame size must be 2048 or 4096, got " + std::to_string(fsz));
+        }
+        ring_size_ = opts_.xdp_ring_size;
+        if (ring_size_ == 0 || (ring_size_ & (ring_size_ - 1)) != 0) {
+            throw SocketError("AF_XDP ring size must be a power of two, got " + std::to_string(ring_size_));
+        }
+        ChunkPoolOpts po;
+        po.align = fsz;
+        po.numa_node = resolve_numa_node(opts_.numa_node, dev_);
+        pool_.reset(new ChunkPool(fsz, opts_.xdp_frame_count, po));
+        frames_.resize(pool_->count());
+
+        xsk_fd_ = socket(AF_XDP, SOCK_RAW, 0);
+        if (xsk_fd_ == -1) {
+            fail("Failed to create AF_XDP socket");
+        }
+        enable_busy_poll(xsk_fd_, opts_.busy_poll_us);
+        struct xdp_umem_reg reg;
+        std::memset(&reg, 0, sizeof(reg));
+        reg.addr = reinterpret_cast<uint64_t>(pool_->slab());
+        reg.len = static_cast<uint64_t>(pool_->stride()) * pool_->count();
+        reg.chunk_size = static_cast<uint32_t>(pool_->stride());
+        reg.headroom = 0;
+        if (setsockopt(xsk_fd_, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) == -1) {
+            fail("Failed to register UMEM (" + std::to_string(reg.len) + " B)");
+        }
+        int n = static_cast<int>(ring_size_);
+        if (setsockopt(xsk_fd_, SOL_XDP, XDP_UMEM_FILL_RING, &n, sizeof(n)) == -1 ||
+            setsockopt(xsk_fd_, SOL_XDP, XDP_UMEM_COMPLETION_RING, &n, sizeof(n)) == -1 ||
+            setsockopt(xsk_fd_, SOL_XDP, XDP_RX_RING, &n, sizeof(n)) == -1) {
+            fail("Failed to size AF_XDP rings (" + std::to_string(n) + ")");
+        }
+        struct xdp_mmap_offsets off;
+        socklen_t optlen = sizeof(off);
+        if (getsockopt(xsk_fd_, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) == -1) {
+            fail("Failed to query AF_XDP ring offsets");
+        }
+        map_ring(rx_, off.rx, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING);
+        map_ring(fill_, off.fr, sizeof(uint64_t), static_cast<off_t>(XDP_UMEM_PGOFF_FILL_RING));
+        map_ring(comp_, off.cr, sizeof(uint64_t), static_cast<off_t>(XDP_UMEM_PGOFF_COMPLETION_RING));
+        refill();
+    }
+
+    bool try_bind(uint16_t flags) noexcept {
+        struct sockaddr_xdp sxdp;
+        std::memset(&sxdp, 0, sizeof(sxdp));
+        sxdp.sxdp_family = AF_XDP;
+        sxdp.sxdp_ifindex = ifindex_;
+        sxdp.sxdp_queue_id = opts_.xdp_queue;
+        sxdp.sxdp_flags = static_cast<uint16_t>(flags | XDP_USE_NEED_WAKEUP);
+        return bind(xsk_fd_, reinterpret_cast<struct sockaddr*>(&sxdp), sizeof(sxdp)) == 0;
+    }
+
+    bool try_attach(uint32_t xdp_flags) noexcept {
+        union bpf_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.link_create.prog_fd = static_cast<uint32_t>(prog_fd_);
+        attr.link_create.target_ifindex = ifindex_;
+        attr.link_create.attach_type = BPF_XDP;
+        attr.link_create.flags = xdp_flags;
+        link_fd_ = static_cast<int>(xdp_detail::sys_bpf(BPF_LINK_CREATE, attr));
+        return link_fd_ >= 0;
+    }
+
+    void load_program() {
+        union bpf_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.map_type = BPF_MAP_TYPE_XSKMAP;
+        attr.key_size = sizeof(uint32_t);
+        attr.value_size = sizeof(uint32_t);
+        attr.max_entries = opts_.xdp_queue + 1;
+        map_fd_ = static_cast<int>(xdp_detail::sys_bpf(BPF_MAP_CREATE, attr));
+        if (map_fd_ < 0) {
+            fail("Failed to create XSKMAP");
+        }
+        uint32_t key = opts_.xdp_queue;
+        uint32_t value = static_cast<uint32_t>(xsk_fd_);
+        std::memset(&attr, 0, sizeof(attr));
+        attr.map_fd = static_cast<uint32_t>(map_fd_);
+        attr.key = reinterpret_cast<uint64_t>(&key);
+        attr.value = reinterpret_cast<uint64_t>(&value);
+        if (xdp_detail::sys_bpf(BPF_MAP_UPDATE_ELEM, attr) < 0) {
+            fail("Failed to insert AF_XDP socket into XSKMAP");
+        }
+
+        std::vector<struct bpf_insn> prog = xdp_detail::build_redirect_prog(map_fd_, ip_, port_);
+        static const char license[] = "GPL";
+        std::vector<char> log(4096, 0);
+        for (int attempt = 0; attempt < 2 && prog_fd_ < 0; ++attempt) {
+            std::memset(&attr, 0, sizeof(attr));
+            attr.prog_type = BPF_PROG_TYPE_XDP;
+            attr.expected_attach_type = BPF_XDP;
+            attr.insn_cnt = static_cast<uint32_t>(prog.size());
+            attr.insns = reinterpret_cast<uint64_t>(prog.data());
+            attr.license = reinterpret_cast<uint64_t>(license);
+            if (attempt == 1) {  // retry only to collect the verifier log
+                attr.log_level = 1;
+                attr.log_buf = reinterpret_cast<uint64_t>(log.data());
+                attr.log_size = static_cast<uint32_t>(log.size());
+            }
+            prog_fd_ = static_cast<int>(xdp_detail::sys_bpf(BPF_PROG_LOAD, attr));
+        }
+        if (prog_fd_ < 0) {
+            fail("Failed to load XDP program" + (log[0] ? " (verifier: " + std::string(log.data()) + ")" : ""));
+        }
+    }
+
+    void setup_mode() {
+        const XdpMode mode = opts_.xdp_mode;
+        bool bound = false;
+        bool zerocopy = false;
+        if (mode == XdpMode::AUTO || mode == XdpMode::ZEROCOPY) {
+            bound = zerocopy = try_bind(XDP_ZEROCOPY);
+            if (!bound && mode == XdpMode::ZEROCOPY) {
+                fail("AF_XDP zero-copy bind on " + dev_ + " queue " + std::to_string(opts_.xdp_queue) + " failed");
+            }
+        }
+        if (!bound && !try_bind(XDP_COPY)) {
+            fail("AF_XDP bind on " + dev_ + " queue " + std::to_string(opts_.xdp_queue) + " failed");
+        }
+
+        load_program();
+        bool native = false;
+        if (mode != XdpMode::GENERIC) {
+            native = try_attach(XDP_FLAGS_DRV_MODE);
+            if (!native && mode != XdpMode::AUTO) {
+                fail("Failed to attach XDP program to " + dev_ + " in driver mode");
+            }
+        }
+        if (!native && !try_attach(XDP_FLAGS_SKB_MODE)) {
+            fail("Failed to attach XDP program to " + dev_ + " (kernel >= 5.9 needed; another XDP program attached?)");
+        }
+        mode_name_ = std::string(native ? "native" : "generic") + (zerocopy ? "+zerocopy" : "+copy");
+    }
+
+    // Hand free pool frames to the kernel
+    void refill() noexcept {
+        const uint32_t cons = __atomic_load_n(fill_.consumer, __ATOMIC_ACQUIRE);
+        uint32_t prod = *fill_.producer;
+        const uint32_t start = prod;
+        uint64_t* addrs = reinterpret_cast<uint64_t*>(fill_.desc);
+        while (prod - cons < ring_size_) {
+            ChunkPool::Chunk c = pool_->try_acquire();
+            if (!c) {
+                ++fill_empty_count_;
+                break;
+            }
+            uint32_t idx = c.index();
+            addrs[prod & fill_.mask] = static_cast<uint64_t>(idx) * pool_->stride();
+            frames_[idx] = std::move(c);
+            ++prod;
+        }
+        if (prod != start) {
+            __atomic_store_n(fill_.producer, prod, __ATOMIC_RELEASE);
+            if (__atomic_load_n(fill_.flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP) {
+                recvfrom(xsk_fd_, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+            }
+        }
+    }
+
+    // Move completed RX descriptors into pending_; returns datagrams added
+    size_t drain_rx() {
+        if (pending_head_ == pending_.size()) {
+            pending_.clear();
+            pending_head_ = 0;
+        }
+        const uint32_t prod = __atomic_load_n(rx_.producer, __ATOMIC_ACQUIRE);
+        uint32_t cons = *rx_.consumer;
+        if (prod == cons) {
+            return 0;
+        }
+        uint64_t now_ns = 0;
+        if (opts_.timestamps != TimestampMode::NONE) {
+            // AF_XDP carries no kernel timestamp: take the dequeue time
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            now_ns = uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+        }
+        const struct xdp_desc* descs = reinterpret_cast<const struct xdp_desc*>(rx_.desc);
+        size_t added = 0;
+        for (; cons != prod; ++cons) {
+            const struct xdp_desc& d = descs[cons & rx_.mask];
+            uint32_t idx = static_cast<uint32_t>(d.addr / pool_->stride());
+            XdpDatagram dg;
+            dg.frame = std::move(frames_[idx]);
+            const uint8_t* frame = pool_->slab() + d.addr;
+            const uint8_t* payload;
+            size_t payload_len;
+            FrameStatus st = parse_udp_frame(frame, d.len, port_, payload, payload_len);
+            if (st != FrameStatus::OK) {
+                ++rejected_count_;
+                count_rejected_frame(counters_, st);
+                continue;  // frame returns to the pool with dg
+            }
+            dg.frame.set_size(d.len);
+            dg.payload = ByteView{payload, payload_len};
+            dg.meta = PacketMeta{};
+            if (opts_.wants_meta()) {
+                dg.meta.ts_ns = now_ns;
+                dg.meta.ts_source = now_ns ? TsSource::SOFTWARE : TsSource::NONE;
+                udp_frame_source(frame, payload, dg.meta);
+            }
+            pending_.push_back(std::move(dg));
+            ++added;
+        }
+        __atomic_store_n(rx_.consumer, cons, __ATOMIC_RELEASE);
+        return added;
+    }
+
+    // Until at least one datagram is pending: OK, WOULD_BLOCK (wait == false)
+    // or TIMEOUT after timeout_ms_
+    ReadStatus wait_pending(bool wait) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms_);
+        while (true) {
+            refill();
+            if (pending_head_ < pending_.size() || drain_rx() > 0) {
+                return ReadStatus::OK;
+            }
+            if (!wait) {
+                return ReadStatus::WOULD_BLOCK;
+            }
+            int wait_ms = -1;
+            if (timeout_ms_ > 0) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (left <= 0) {
+                    return ReadStatus::TIMEOUT;
+                }
+                wait_ms = static_cast<int>(left);
+            }
+            if (opts_.busy_wait) {
+                // Drive the RX queue from this thread (with busy_poll_us: NAPI busy poll)
+                recvfrom(xsk_fd_, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+                spin_pause();
+                continue;
+            }
+            struct pollfd pfd;
+            pfd.fd = xsk_fd_;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, wait_ms) == -1 && errno != EINTR) {
+                throw SocketError("poll on AF_XDP socket failed: " + get_last_socket_error());
+            }
+        }
+    }
+
+public:
+    XdpReader(const std::string& ip,
+              uint16_t port,
+              const std::string& dev,
+              int32_t timeout_ms,
+              size_t chunk_size,
+              const SocketReaderOpts& opts = SocketReaderOpts())
+        : ip_(ip), port_(port), dev_(dev), timeout_ms_(timeout_ms), chunk_size_(chunk_size), opts_(opts)
+        , mcast_(capture_membership(ip, dev, opts))
+    {
+        {
+            // UMEM (pool) and the kernel side of the rings near the NIC
+            ScopedNumaPolicy numa(resolve_numa_node(opts_.numa_node, dev_));
+            setup_socket();
+        }
+        setup_mode();
+        segments_.reserve(opts_.batch);
+    }
+
+    ~XdpReader() override { release(); }
+
+    XdpReader(const XdpReader&) = delete;
+    XdpReader& operator=(const XdpReader&) = delete;
+
+    // Zero-copy: append up to max datagrams to out (blocks until at least one)
+    size_t receive(std::vector<XdpDatagram>& out, size_t max) {
+        if (wait_pending(true) == ReadStatus::TIMEOUT) {
+            throw_timeout();
+        }
+        size_t n = 0;
+        while (n < max && pending_head_ < pending_.size()) {
+            out.push_back(std::move(pending_[pending_head_++]));
+            ++n;
+        }
+        return n;
+    }
+
+private:
+    [[noreturn]] void throw_timeout() const {
+        throw ReadTimeout("AF_XDP receive timeout expired (" + std::to_string(timeout_ms_) + " ms)");
+    }
+
+    // Copying path: whole datagrams, up to opts.batch per chunk
+    size_t read_chunk(uint8_t* buff_ptr, bool wait, ReadStatus& st) {
+        segments_.clear();
+        meta_.clear();
+        st = wait_pending(wait);
+        if (st != ReadStatus::OK) {
+            return 0;
+        }
+        const size_t max_dgrams = opts_.batch ? opts_.batch : 1;
+        size_t pos = 0;
+        while (segments_.size() < max_dgrams) {
+            if (pending_head_ == pending_.size() && drain_rx() == 0) {
+                break;
+            }
+            XdpDatagram& d = pending_[pending_head_];
+            size_t len = d.payload.size;
+            uint32_t flags = 0;
+            if (pos + len > chunk_size_) {
+                if (pos > 0) {
+                    break;  // stays pending for the next chunk
+                }
+                len = chunk_size_;
+                flags = SEG_TRUNCATED;
+            }
+            std::memcpy(buff_ptr + pos, d.payload.data, len);
+            segments_.push_back({pos, len, flags});
+            if (opts_.wants_meta()) {
+                meta_.push_back(d.meta);
+            }
+            pos += len;
+            d.frame.release();
+            ++pending_head_;
+        }
+        refill();
+        return pos;
+    }
+
+public:
+    size_t read_into(uint8_t* buff_ptr) override {
+        return counters_.timed_read(*this, [&]() {
+            ReadStatus st;
+            size_t rd = read_chunk(buff_ptr, true, st);
+            if (st == ReadStatus::TIMEOUT) {
+                throw_timeout();
+            }
+            return rd;
+        });
+    }
+
+    ReadResult try_read_into(uint8_t* buff_ptr) override {
+        return counters_.timed_try_read(*this, [&]() {
+            ReadStatus st;
+            size_t rd = read_chunk(buff_ptr, !opts_.nonblocking, st);
+            return ReadResult{st, rd};
+        });
+    }
+
+    // Readable while the RX ring has descriptors (datagrams already moved
+    // to the pending list do not signal)
+    native_handle_t get_native_handle() const noexcept override { return xsk_fd_; }
+
+    bool get_stats(ReaderStats& st) const noexcept override {
+        if (!ReaderCounters::enabled) {
+            return false;
+        }
+        counters_.snapshot(st);
+        struct xdp_statistics xs;
+        if (get_xdp_stats(xs)) {
+            st.kernel_drops = xs.rx_dropped + xs.rx_ring_full + xs.rx_invalid_descs;
+            st.kernel_drops_valid = true;
+        }
+        return true;
+    }
+
+    size_t get_chunk_size() const noexcept override { return chunk_size_; }
+
+    std::string get_type() const noexcept override { return "SocketReader<XDP " + mode_name_ + ">"; }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+
+    size_t get_packet_meta(const PacketMeta*& meta) const noexcept override {
+        meta = meta_.data();
+        return meta_.size();
+    }
+
+    // Kernel drop counters (rx_dropped: no fill frame / ring full)
+    bool get_xdp_stats(struct xdp_statistics& st) const noexcept {
+        socklen_t len = sizeof(st);
+        return getsockopt(xsk_fd_, SOL_XDP, XDP_STATISTICS, &st, &len) == 0;
+    }
+
+    ChunkPool* get_pool() const noexcept { return pool_.get(); }
+    const std::string& get_mode() const noexcept { return mode_name_; }
+    uint64_t get_rejected_count() const noexcept { return rejected_count_; }
+    uint64_t get_fill_empty_count() const noexcept { return fill_empty_count_; }
+};
+#endif // _WIN32
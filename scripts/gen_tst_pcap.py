@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+import sys
+# print(f"====> Running: {sys.executable}")
+
+import argparse
+import struct
+
+
+def ip_checksum(hdr: bytes) -> int:
+    s = sum(struct.unpack('!10H', hdr))
+    s = (s >> 16) + (s & 0xFFFF)
+    s += s >> 16
+    return ~s & 0xFFFF
+
+
+def make_frame(seq: int, size: int, dst_port: int, src_port: int = 40000) -> bytes:
+    """Ethernet/IPv4/UDP frame, payload = int64 LE seq + filler (gen_tst_udp_test_stream.py layout)"""
+    payload = struct.pack('<q', seq) + bytes((seq + k) & 0xFF for k in range(size - 8))
+    udp = struct.pack('!HHHH', src_port, dst_port, 8 + len(payload), 0) + payload
+    ip = struct.pack('!BBHHHBBH4s4s', 0x45, 0, 20 + len(udp), seq & 0xFFFF, 0, 64, 17, 0,
+                     bytes([127, 0, 0, 1]), bytes([127, 0, 0, 1]))
+    ip = ip[:10] + struct.pack('!H', ip_checksum(ip)) + ip[12:]
+    eth = bytes(6) + bytes(6) + struct.pack('!H', 0x0800)
+    return eth + ip + udp
+
+
+def pcap_file(frames, nsec: bool) -> bytes:
+    magic = 0xA1B23C4D if nsec else 0xA1B2C3D4
+    out = [struct.pack('<IHHiIII', magic, 2, 4, 0, 0, 65535, 1)]
+    for ts_ns, f in frames:
+        frac = ts_ns % 1_000_000_000 if nsec else (ts_ns % 1_000_000_000) // 1000
+        out.append(struct.pack('<IIII', ts_ns // 1_000_000_000, frac, len(f), len(f)) + f)
+    return b''.join(out)
+
+
+def pcapng_block(btype: int, body: bytes) -> bytes:
+    body += bytes((4 - len(body) % 4) % 4)
+    n = 12 + len(body)
+    return struct.pack('<II', btype, n) + body + struct.pack('<I', n)
+
+
+def pcapng_file(frames) -> bytes:
+    shb = pcapng_block(0x0A0D0D0A, struct.pack('<IHHq', 0x1A2B3C4D, 1, 0, -1))
+    tsresol = struct.pack('<HHB', 9, 1, 9) + bytes(3) + struct.pack('<HH', 0, 0)  # ns ticks
+    idb = pcapng_block(0x00000001, struct.pack('<HHI', 1, 0, 65535) + tsresol)
+    out = [shb, idb]
+    for ts_ns, f in frames:
+        out.append(pcapng_block(0x00000006, struct.pack('<IIIII', 0, ts_ns >> 32, ts_ns & 0xFFFFFFFF,
+                                                        len(f), len(f)) + f))
+    return b''.join(out)
+
+
+def main(args: argparse.Namespace):
+    t0 = 1_700_000_000 * 1_000_000_000
+    frames = []
+    for seq in range(args.count):
+        if args.gap and seq % args.gap == args.gap - 1:
+            continue  # simulated loss
+        ts = t0 + seq * args.period_us * 1000
+        frames.append((ts, make_frame(seq, args.size, args.port)))
+        if args.noise:
+            frames.append((ts, make_frame(seq, 64, args.port + 1)))  # other flow
+    data = pcapng_file(frames) if args.ng else pcap_file(frames, args.nsec)
+    with open(args.filepath, 'wb') as f:
+        f.write(data)
+    print(f"Generated: {args.filepath} ({'pcapng' if args.ng else 'pcap'}), {len(frames)} frames, {len(data)} bytes")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Generate pcap / pcapng test capture of the UDP test stream')
+    parser.add_argument('filepath', help='output file')
+    parser.add_argument('--count', type=int, default=1000, help='datagrams (sequence numbers 0..count-1)')
+    parser.add_argument('--size', type=int, default=1032, help='UDP payload bytes (>= 8)')
+    parser.add_argument('--port', type=int, default=9999, help='UDP destination port')
+    parser.add_argument('--period-us', type=int, default=100, help='capture time step')
+    parser.add_argument('--gap', type=int, default=0, help='drop every N-th datagram')
+    parser.add_argument('--noise', action='store_true', help='interleave a second flow on port + 1')
+    parser.add_argument('--nsec', action='store_true', help='nanosecond pcap')
+    parser.add_argument('--ng', action='store_true', help='pcapng instead of pcap')
+    main(parser.parse_args())
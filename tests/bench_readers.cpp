@@ -0,0 +1,459 @@
+// Reader engine benchmark suite: file engines over a chunk / stdio buffer
+// sweep, socket engines against a loopback UdpLoadGen. One JSON object per
+// run (--json) for regression tracking, a table otherwise.
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+#include "../data-stream/file_reader.hpp"
+#include "../data-stream/mmap_file_reader.hpp"
+#include "../data-stream/async_file_reader.hpp"
+#include "../data-stream/sock_reader.hpp"
+#include "../data-stream/seq_tracker.hpp"
+#include "../data-stream/pipeline.hpp"
+#include "udp_load_gen.hpp"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <time.h>
+#endif
+
+using SteadyClock = std::chrono::steady_clock;
+
+// CPU time of the calling thread (the reader side only, not the generator)
+static double thread_cpu_sec()
+{
+#ifdef _WIN32
+    FILETIME c, e, k, u;
+    GetThreadTimes(GetCurrentThread(), &c, &e, &k, &u);
+    auto t100ns = [](const FILETIME& f) { return (uint64_t(f.dwHighDateTime) << 32) | f.dwLowDateTime; };
+    return double(t100ns(k) + t100ns(u)) * 1e-7;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+#endif
+}
+
+// Evict the file from page cache (clean pages only, no root needed)
+static void drop_cache(const std::string& path)
+{
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd != -1) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+struct RunResult {
+    std::string engine;
+    size_t chunk = 0;
+    size_t param = 0;          // stdio buffer / queue depth / batch, engine specific
+    uint64_t bytes = 0;
+    uint64_t reads = 0;
+    uint64_t packets = 0;      // datagrams received (socket engines)
+    size_t pkt = 0;            // datagram size sent (socket engines)
+    uint64_t sent = 0;
+    uint64_t lost = 0;         // by sequence number
+    uint64_t duplicates = 0;
+    uint64_t timeouts = 0;
+    double sec = 0.0;
+    double cpu_sec = 0.0;
+    double p50_us = 0.0, p99_us = 0.0, p999_us = 0.0, max_us = 0.0;
+    std::string error;         // set when the engine could not run here
+};
+
+static void finish_latency(RunResult& r, std::vector<uint32_t>& lat_ns)
+{
+    if (lat_ns.empty()) {
+        return;
+    }
+    std::sort(lat_ns.begin(), lat_ns.end());
+    auto pct = [&](double p) {
+        size_t i = std::min(lat_ns.size() - 1, static_cast<size_t>(p * double(lat_ns.size())));
+        return double(lat_ns[i]) * 1e-3;
+    };
+    r.p50_us = pct(0.50);
+    r.p99_us = pct(0.99);
+    r.p999_us = pct(0.999);
+    r.max_us = double(lat_ns.back()) * 1e-3;
+}
+
+// Times every read_into until EOF
+static RunResult run_file(const std::string& engine, I_STREAM_READER& reader, size_t chunk, size_t param)
+{
+    RunResult r;
+    r.engine = engine;
+    r.chunk = chunk;
+    r.param = param;
+    std::vector<uint8_t> buf(reader.get_chunk_size());
+    std::vector<uint32_t> lat;
+    lat.reserve(1 << 16);
+
+    double cpu0 = thread_cpu_sec();
+    auto t0 = SteadyClock::now();
+    for (;;) {
+        auto a = SteadyClock::now();
+        size_t n = reader.read_into(buf.data());
+        auto b = SteadyClock::now();
+        if (n == 0) {
+            break;  // EOF
+        }
+        lat.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+        r.bytes += n;
+        ++r.reads;
+    }
+    r.sec = std::chrono::duration<double>(SteadyClock::now() - t0).count();
+    r.cpu_sec = thread_cpu_sec() - cpu0;
+    finish_latency(r, lat);
+    return r;
+}
+
+// mmap views without a copy; touches one byte per page so page-in is paid
+static RunResult run_mmap_view(const std::string& path, size_t chunk)
+{
+    MmapFileReader reader(path, chunk);
+    RunResult r;
+    r.engine = "mmap_view";
+    r.chunk = chunk;
+    std::vector<uint32_t> lat;
+    volatile uint8_t sink = 0;
+
+    double cpu0 = thread_cpu_sec();
+    auto t0 = SteadyClock::now();
+    for (;;) {
+        auto a = SteadyClock::now();
+        ByteView v = reader.next_view();
+        uint8_t acc = 0;
+        for (size_t i = 0; i < v.size; i += 4096) {
+            acc ^= v.data[i];
+        }
+        sink = sink ^ acc;
+        auto b = SteadyClock::now();
+        if (v.size == 0) {
+            break;
+        }
+        lat.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+        r.bytes += v.size;
+        ++r.reads;
+    }
+    r.sec = std::chrono::duration<double>(SteadyClock::now() - t0).count();
+    r.cpu_sec = thread_cpu_sec() - cpu0;
+    finish_latency(r, lat);
+    return r;
+}
+
+struct SockBench {
+    size_t pkt_size = 7184;
+    double rate_bps = 0.0;     // 0 = as fast as possible
+    double seconds = 2.0;
+    uint16_t port = 9998;
+    size_t gen_batch = 32;
+};
+
+// Receives from a loopback generator for sb.seconds, then drains until quiet
+static RunResult run_socket(const std::string& engine, bool is_raw, SocketReaderOpts opts,
+                            size_t chunk, const SockBench& sb)
+{
+    RunResult r;
+    r.engine = engine;
+    r.chunk = chunk;
+    r.param = opts.batch;
+    r.pkt = sb.pkt_size;
+    std::unique_ptr<I_STREAM_READER> sock(create_socket_reader("127.0.0.1", sb.port, "lo", 200, chunk, is_raw, opts));
+    SeqTrackingReader reader(sock.get(), SeqTrackerOpts());
+    std::vector<uint8_t> buf(reader.get_chunk_size());
+    std::vector<uint32_t> lat;
+    lat.reserve(1 << 20);
+
+    UdpLoadGen gen("127.0.0.1", sb.port, sb.pkt_size, sb.rate_bps, sb.gen_batch);
+    gen.start();
+    double cpu0 = thread_cpu_sec();
+    auto t0 = SteadyClock::now();
+    auto t_stop = t0 + std::chrono::milliseconds(static_cast<int64_t>(sb.seconds * 1000));
+    bool stopped = false;
+    while (true) {
+        auto a = SteadyClock::now();
+        if (!stopped && a >= t_stop) {
+            gen.stop();
+            stopped = true;
+        }
+        size_t n;
+        try {
+            n = reader.read_into(buf.data());
+        } catch (const ReadTimeout&) {
+            ++r.timeouts;
+            if (stopped) {
+                break;  // generator done and the socket is empty
+            }
+            continue;
+        }
+        auto b = SteadyClock::now();
+        lat.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+        const ChunkSegment* segs;
+        size_t k = reader.get_segments(segs);
+        r.packets += k ? k : (n ? 1 : 0);
+        r.bytes += n;
+        ++r.reads;
+    }
+    // Exclude the final idle timeout from the measured time
+    r.sec = std::chrono::duration<double>(SteadyClock::now() - t0).count() - 0.2;
+    r.cpu_sec = thread_cpu_sec() - cpu0;
+    r.sent = gen.get_sent();
+    const SeqStats& st = reader.get_seq_stats();
+    uint64_t unique = st.received - st.duplicates;
+    r.lost = r.sent > unique ? r.sent - unique : 0;  // includes datagrams lost after the last one seen
+    r.duplicates = st.duplicates;
+    finish_latency(r, lat);
+    return r;
+}
+
+static std::string json_escape(const std::string& s)
+{
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += (c == '\n' || c == '\r') ? ' ' : c;
+    }
+    return out;
+}
+
+static void print_json(std::ostream& os, const RunResult& r)
+{
+    os << "{\"engine\":\"" << r.engine << "\",\"chunk\":" << r.chunk << ",\"param\":" << r.param;
+    if (!r.error.empty()) {
+        os << ",\"error\":\"" << json_escape(r.error) << "\"}\n";
+        return;
+    }
+    double gb = double(r.bytes) / 1e9;
+    os << ",\"bytes\":" << r.bytes << ",\"reads\":" << r.reads << ",\"sec\":" << r.sec
+       << ",\"mib_s\":" << (r.sec > 0 ? double(r.bytes) / (1024.0 * 1024.0) / r.sec : 0.0)
+       << ",\"cpu_sec\":" << r.cpu_sec << ",\"cpu_s_per_gb\":" << (gb > 0 ? r.cpu_sec / gb : 0.0)
+       << ",\"pkt\":" << r.pkt << ",\"packets\":" << r.packets << ",\"pps\":" << (r.sec > 0 ? double(r.packets) / r.sec : 0.0)
+       << ",\"sent\":" << r.sent << ",\"lost\":" << r.lost << ",\"duplicates\":" << r.duplicates
+       << ",\"timeouts\":" << r.timeouts
+       << ",\"p50_us\":" << r.p50_us << ",\"p99_us\":" << r.p99_us << ",\"p999_us\":" << r.p999_us
+       << ",\"max_us\":" << r.max_us << "}\n";
+}
+
+static void print_row(const RunResult& r)
+{
+    char line[256];
+    if (!r.error.empty()) {
+        std::snprintf(line, sizeof(line), "%-10s %9zu %8zu  skipped: %s", r.engine.c_str(), r.chunk, r.param, r.error.c_str());
+        std::cout << line << "\n";
+        return;
+    }
+    double gb = double(r.bytes) / 1e9;
+    std::snprintf(line, sizeof(line), "%-10s %9zu %8zu %10.1f %8.3f %10.0f %8llu %9.1f %9.1f %9.1f",
+                  r.engine.c_str(), r.chunk, r.param,
+                  r.sec > 0 ? double(r.bytes) / (1024.0 * 1024.0) / r.sec : 0.0,
+                  gb > 0 ? r.cpu_sec / gb : 0.0,
+                  r.sec > 0 ? double(r.packets) / r.sec : 0.0,
+                  static_cast<unsigned long long>(r.lost), r.p50_us, r.p99_us, r.p999_us);
+    std::cout << line << "\n";
+}
+
+static std::vector<size_t> parse_sizes(const std::string& s)
+{
+    std::vector<size_t> out;
+    std::stringstream ss(s);
+    std::string tok;
+    while (std::getline(ss, tok, ',')) {
+        char* end;
+        size_t v = std::strtoull(tok.c_str(), &end, 10);
+        if (*end == 'K' || *end == 'k') v <<= 10;
+        if (*end == 'M' || *end == 'm') v <<= 20;
+        if (v) out.push_back(v);
+    }
+    return out;
+}
+
+static bool has(const std::string& list, const std::string& name)
+{
+    std::string l = "," + list + ",";
+    return l.find("," + name + ",") != std::string::npos;
+}
+
+int main(int argc, char** argv)
+{
+    // defaults
+    std::string file;
+    size_t file_size = 256u << 20;
+    std::vector<size_t> chunks = {64u << 10, 1u << 20, 4u << 20, 16u << 20};
+    std::vector<size_t> bufs = {64u << 10, 4u << 20};
+    std::string engines = "stdio,mmap,mmap_view,async,direct,udp,udp_batch";
+    std::string json_path;
+    bool cold = false;
+    SockBench sb;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+        if (a == "--file") file = next();
+        else if (a == "--file-mb") file_size = std::strtoull(next().c_str(), nullptr, 10) << 20;
+        else if (a == "--chunks") chunks = parse_sizes(next());
+        else if (a == "--bufs") bufs = parse_sizes(next());
+        else if (a == "--engines") engines = next();
+        else if (a == "--json") json_path = next();
+        else if (a == "--cold") cold = true;
+        else if (a == "--pkt") sb.pkt_size = std::strtoull(next().c_str(), nullptr, 10);
+        else if (a == "--gbps") sb.rate_bps = std::strtod(next().c_str(), nullptr) * 1e9;
+        else if (a == "--udp-sec") sb.seconds = std::strtod(next().c_str(), nullptr);
+        else if (a == "--port") sb.port = static_cast<uint16_t>(std::atoi(next().c_str()));
+        else {
+            std::cout << "Usage: " << argv[0] << " [--file <path> | --file-mb <n>] [--chunks 64K,1M,..] [--bufs 64K,4M]"
+                      << " [--engines list] [--cold] [--pkt <bytes>] [--gbps <rate>] [--udp-sec <s>] [--port <n>] [--json <out|->]"
+                      << "\n  engines: stdio, mmap, mmap_view, async, direct, chain, pipeline (file); udp, udp_batch, raw, tpacket, xdp (loopback, raw ones need root)"
+                      << "\n  chain / pipeline: file -> seq -> iq_f32, runtime decorators vs. compile-time Pipeline<>"
+                      << "\n  1) file sweep: " << argv[0] << " --file /data/tst.bin --engines stdio,mmap,async --cold"
+                      << "\n  2) sockets at 2 Gbps: " << argv[0] << " --engines udp,udp_batch,tpacket --gbps 2 --json results.jsonl\n";
+            return 2;
+        }
+    }
+
+    // Scratch file when none is given (removed at exit)
+    bool own_file = false;
+    bool want_file = has(engines, "stdio") || has(engines, "mmap") || has(engines, "mmap_view") ||
+                     has(engines, "async") || has(engines, "direct") ||
+                     has(engines, "chain") || has(engines, "pipeline");
+    if (want_file && file.empty()) {
+        file = "bench_readers.tmp";
+        std::ofstream f(file, std::ios::binary);
+        std::vector<char> block(1u << 20);
+        for (size_t i = 0; i < block.size(); ++i) block[i] = static_cast<char>(i * 31);
+        for (size_t done = 0; done < file_size; done += block.size()) {
+            f.write(block.data(), static_cast<std::streamsize>(std::min(block.size(), file_size - done)));
+        }
+        own_file = true;
+    }
+
+    std::ofstream json_file;
+    std::ostream* json = nullptr;
+    if (json_path == "-") {
+        json = &std::cout;
+    } else if (!json_path.empty()) {
+        json_file.open(json_path, std::ios::app);
+        json = &json_file;
+    }
+    if (!json || json == &json_file) {
+        std::cout << "engine         chunk    param      MiB/s   cpu/GB        pps     lost   p50(us)   p99(us)  p999(us)\n";
+    }
+
+    auto report = [&](const RunResult& r) {
+        if (json) print_json(*json, r);
+        if (json != &std::cout) print_row(r);
+    };
+    auto guarded = [&](const std::string& engine, size_t chunk, size_t param, const std::function<RunResult()>& fn) {
+        if (want_file && cold) drop_cache(file);
+        try {
+            report(fn());
+        } catch (const std::exception& e) {
+            RunResult r;
+            r.engine = engine;
+            r.chunk = chunk;
+            r.param = param;
+            r.error = e.what();
+            report(r);
+        }
+    };
+
+    // The scratch file repeats every MiB: keep chunks with a repeated "sequence number"
+    SeqTrackerOpts pass_all;
+    pass_all.drop_duplicates = false;
+
+    for (size_t chunk : chunks) {
+        if (has(engines, "stdio")) {
+            for (size_t buf : bufs) {
+                guarded("stdio", chunk, buf, [&]() {
+                    FileReader rd(file, chunk, 0, buf);
+                    return run_file("stdio", rd, chunk, buf);
+                });
+            }
+        }
+        if (has(engines, "mmap")) {
+            guarded("mmap", chunk, 0, [&]() {
+                MmapFileReader rd(file, chunk);
+                return run_file("mmap", rd, chunk, 0);
+            });
+        }
+        if (has(engines, "mmap_view")) {
+            guarded("mmap_view", chunk, 0, [&]() { return run_mmap_view(file, chunk); });
+        }
+        if (has(engines, "async")) {
+            guarded("async", chunk, 4, [&]() {
+                AsyncFileReader rd(file, chunk, 0, 4, false);
+                return run_file("async", rd, chunk, 4);
+            });
+        }
+        if (has(engines, "direct")) {
+            guarded("direct", chunk, 4, [&]() {
+                AsyncFileReader rd(file, chunk, 0, 4, true);
+                if (!rd.is_direct()) throw std::runtime_error("O_DIRECT not supported on this filesystem");
+                return run_file("direct", rd, chunk, 4);
+            });
+        }
+        if (has(engines, "chain")) {
+            guarded("chain", chunk, 0, [&]() {
+                IqConvertReader rd(new SeqTrackingReader(new FileReader(file, chunk), pass_all, true),
+                                   IqStageOpts(), true);
+                return run_file("chain", rd, chunk, 0);
+            });
+        }
+        if (has(engines, "pipeline")) {
+            guarded("pipeline", chunk, 0, [&]() {
+                Pipeline<FileReader, SeqTracker, I16ToF32> rd(IqStageOpts(), pass_all, file, chunk);
+                return run_file("pipeline", rd, chunk, 0);
+            });
+        }
+    }
+
+    // Socket engines: one chunk size that fits a 64-datagram batch
+    const size_t sock_chunk = 64 * sb.pkt_size;
+    SocketReaderOpts opts;
+    if (has(engines, "udp")) {
+        guarded("udp", sb.pkt_size, 1, [&]() { return run_socket("udp", false, opts, sb.pkt_size, sb); });
+    }
+    opts.batch = 64;
+    if (has(engines, "udp_batch")) {
+        guarded("udp_batch", sock_chunk, 64, [&]() { return run_socket("udp_batch", false, opts, sock_chunk, sb); });
+    }
+    if (has(engines, "raw")) {
+        guarded("raw", sock_chunk, 64, [&]() { return run_socket("raw", true, opts, sock_chunk, sb); });
+    }
+    if (has(engines, "tpacket")) {
+        SocketReaderOpts o = opts;
+        o.engine = SocketEngine::TPACKET;
+        guarded("tpacket", sock_chunk, 64, [&]() { return run_socket("tpacket", true, o, sock_chunk, sb); });
+    }
+    if (has(engines, "xdp")) {
+        SocketReaderOpts o = opts;
+        o.engine = SocketEngine::XDP;
+        o.xdp_mode = XdpMode::GENERIC;  // loopback has no native XDP
+        // A frame must fit one UMEM chunk minus XDP headroom, larger ones never reach the socket
+        SockBench xsb = sb;
+        xsb.pkt_size = std::min<size_t>(sb.pkt_size, o.xdp_frame_size - 256 - MIN_UDP_FRAME_LEN);
+        guarded("xdp", sock_chunk, 64, [&]() { return run_socket("xdp", true, o, sock_chunk, xsb); });
+    }
+
+    if (own_file) {
+        std::remove(file.c_str());
+    }
+    return 0;
+}
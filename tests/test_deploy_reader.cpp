@@ -0,0 +1,92 @@
+#include "../data-stream/deploy_reader.hpp"
+#include <vector>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <csignal>
+#include <atomic>
+
+static std::atomic<bool> g_stop{false};
+
+static void signal_handler(int) { g_stop = true; }
+
+int main(int argc, char* argv[])
+{
+    // defaults
+    std::string uri;
+    size_t chunk_sz = 1024 * 1024;
+    double dur_sec = -1.0;  // negative = until EOF / Ctrl+C
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            chunk_sz = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--dur-sec") == 0 && i + 1 < argc) {
+            dur_sec = std::strtod(argv[++i], nullptr);
+        } else if (argv[i][0] != '-' && uri.empty()) {
+            uri = argv[i];
+        } else {
+            uri.clear();
+            break;
+        }
+    }
+    if (uri.empty()) {
+        std::cout << "Usage: " << argv[0] << " <uri> [--chunk <bytes>] [--dur-sec <sec>]"
+                  << "\n   1) file, mmap: " << argv[0] << " \"file:///data/tst.bin?mode=mmap&offs=4096\""
+                  << "\n   2) file, io_uring: " << argv[0] << " \"file:///data/tst.bin?mode=async&depth=8\""
+                  << "\n   3) capture replay: " << argv[0] << " \"pcap:///data/trace.pcapng?port=9999&stages=seq\""
+                  << "\n   4) UDP batched: " << argv[0] << " \"udp://lo:127.0.0.1:9999?batch=64&stages=seq,thread&thread.cpu=2\" --chunk 459776"
+                  << "\n   5) TPACKET + IQ: " << argv[0] << " \"udp://enp3s0:192.168.250.196:9999?engine=tpacket&batch=64&stages=seq,iq&seq.gap=zero\""
+                  << "\n   6) record while reading: " << argv[0] << " \"udp://lo:127.0.0.1:9999?batch=64&stages=thread,record&record.path=/data/rec.bin&record.rotate=1G\" --chunk 459776"
+                  << "\n   7) rotated segments: " << argv[0] << " \"file:///data/rec_*.bin?mode=multi\""
+                  << "\n";
+        return 1;
+    }
+    std::signal(SIGINT, signal_handler);
+
+    try {
+        std::unique_ptr<I_STREAM_READER> reader(DeployReader(chunk_sz, uri));
+        std::cout << "Reader: " << reader->get_type() << ", chunk " << reader->get_chunk_size() << " bytes\n";
+
+        std::vector<uint8_t> buffer(reader->get_chunk_size());
+        size_t total = 0, chunks = 0, dgrams = 0, timeouts = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        auto elapsed = [&]() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
+        while (!g_stop && (dur_sec < 0 || elapsed() < dur_sec)) {
+            size_t rd;
+            try {
+                rd = reader->read_into(buffer.data());
+            } catch (const ReadTimeout&) {
+                ++timeouts;
+                continue;
+            }
+            if (rd == 0) {
+                break;  // EOF
+            }
+            const ChunkSegment* segs;
+            dgrams += reader->get_segments(segs);
+            total += rd;
+            ++chunks;
+        }
+        double dt = elapsed();
+        std::cout << "Read: " << total << " bytes in " << chunks << " chunks";
+        if (dgrams) {
+            std::cout << ", " << dgrams << " datagrams";
+        }
+        std::cout << ", " << timeouts << " timeouts, " << dt << " s, "
+                  << (dt > 0 ? double(total) / dt / 1e6 : 0.0) << " MB/s\n";
+
+        // Loss counters when the outermost stage is seq
+        if (SeqTrackingReader* seq = dynamic_cast<SeqTrackingReader*>(reader.get())) {
+            const SeqStats& st = seq->get_seq_stats();
+            std::cout << "Seq: received " << st.received << ", lost " << st.lost << " in " << st.gaps
+                      << " gaps, duplicates " << st.duplicates << ", reordered " << st.reordered << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include "../data-stream/sock_reader.hpp"
+#include "../data-stream/reader_event_loop.hpp"
+#include "udp_load_gen.hpp"
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+#include <atomic>
+
+static std::atomic<bool> g_stop{false};
+
+static void signal_handler(int) { g_stop = true; }
+
+struct StreamCount {
+    uint64_t datagrams = 0;
+    uint64_t bytes = 0;
+    uint64_t timeouts = 0;
+    uint64_t wakeups = 0;
+};
+
+#ifdef DATASTREAM_HAS_COROUTINES
+// One coroutine per stream, all on the loop's thread
+static ReaderTask consume(ReaderEventLoop& loop, I_STREAM_READER& reader, std::vector<uint8_t>& buf,
+                          StreamCount& c, int32_t timeout_ms)
+{
+    while (!g_stop) {
+        ReadResult r = co_await loop.async_read_into(reader, buf.data(), timeout_ms);
+        if (r.status == ReadStatus::OK) {
+            const ChunkSegment* segs;
+            size_t n = reader.get_segments(segs);
+            c.datagrams += n ? n : (r.size ? 1 : 0);
+            c.bytes += r.size;
+        } else if (r.status == ReadStatus::TIMEOUT) {
+            ++c.timeouts;
+        }
+        ++c.wakeups;
+    }
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+    // defaults
+    std::string ip = "127.0.0.1";
+    uint16_t port = 9999;
+    size_t streams = 4;
+    size_t chunk_sz = 65536;
+    double dur_sec = 5.0;
+    double gen_mbps = 0.0;     // > 0: built-in sender per stream
+    size_t pkt = 1400;
+    bool coro = false;
+    SocketReaderOpts opts;
+    opts.nonblocking = true;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--addr") == 0 && i + 1 < argc) {
+            std::string a = argv[++i];
+            size_t c = a.rfind(':');
+            ip = a.substr(0, c);
+            port = static_cast<uint16_t>(std::atoi(a.c_str() + c + 1));
+        } else if (std::strcmp(argv[i], "--streams") == 0 && i + 1 < argc) {
+            streams = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            opts.batch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--sz") == 0 && i + 1 < argc) {
+            chunk_sz = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--dur-sec") == 0 && i + 1 < argc) {
+            dur_sec = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--gen") == 0 && i + 1 < argc) {
+            gen_mbps = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--pkt") == 0 && i + 1 < argc) {
+            pkt = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--coro") == 0) {
+            coro = true;
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--addr ip:first_port] [--streams <n>] [--batch <n>] [--sz <chunk>] [--dur-sec <sec>] [--gen <Mbps per stream> [--pkt <bytes>]] [--coro]"
+                      << "\n   1) 16 streams, one thread: " << argv[0] << " --addr 127.0.0.1:9999 --streams 16 --gen 200"
+                      << "\n   2) coroutines + recvmmsg: " << argv[0] << " --streams 16 --batch 32 --gen 200 --coro"
+                      << "\n";
+            return 1;
+        }
+    }
+#ifndef DATASTREAM_HAS_COROUTINES
+    if (coro) {
+        std::cerr << "Error: built without C++20 coroutines\n";
+        return 1;
+    }
+#endif
+    std::signal(SIGINT, signal_handler);
+
+    try {
+        // Readers outlive the loop, the loop outlives the tasks
+        std::vector<std::unique_ptr<I_STREAM_READER>> readers;
+        std::vector<std::vector<uint8_t>> bufs(streams, std::vector<uint8_t>(chunk_sz));
+        std::vector<StreamCount> counts(streams);
+        for (size_t s = 0; s < streams; ++s) {
+            readers.emplace_back(create_socket_reader(ip, static_cast<uint16_t>(port + s), "", 1000, chunk_sz, false, opts));
+        }
+        std::vector<std::unique_ptr<UdpLoadGen>> gens;
+        for (size_t s = 0; gen_mbps > 0 && s < streams; ++s) {
+            gens.emplace_back(new UdpLoadGen(ip, static_cast<uint16_t>(port + s), pkt, gen_mbps * 1e6, 8));
+        }
+
+        ReaderEventLoop loop;
+#ifdef DATASTREAM_HAS_COROUTINES
+        std::vector<ReaderTask> tasks;
+#endif
+        for (size_t s = 0; s < streams; ++s) {
+            if (coro) {
+#ifdef DATASTREAM_HAS_COROUTINES
+                tasks.push_back(consume(loop, *readers[s], bufs[s], counts[s], 1000));
+#endif
+                continue;
+            }
+            loop.add(readers[s].get(), [&, s](I_STREAM_READER& r) {
+                StreamCount& c = counts[s];
+                ++c.wakeups;
+                ReadResult res;
+                while ((res = r.try_read_into(bufs[s].data())).status == ReadStatus::OK) {
+                    const ChunkSegment* segs;
+                    size_t n = r.get_segments(segs);
+                    c.datagrams += n ? n : (res.size ? 1 : 0);
+                    c.bytes += res.size;
+                }
+            });
+        }
+        std::cout << "Event loop: " << streams << " x " << readers[0]->get_type() << " on "
+                  << ip << ":" << port << ".." << port + streams - 1 << ", "
+                  << (coro ? "coroutines" : "handlers") << ", batch " << opts.batch << "\n";
+
+        for (auto& g : gens) {
+            g->start();
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        auto elapsed = [&]() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
+        while (!g_stop && elapsed() < dur_sec) {
+            loop.run_once(100);
+        }
+        for (auto& g : gens) {
+            g->stop();
+        }
+        // Drain what is still queued
+        for (int k = 0; k < 20; ++k) {
+            loop.run_once(10);
+        }
+        double dt = elapsed();
+        g_stop = true;
+
+        uint64_t total = 0, bytes = 0;
+        for (size_t s = 0; s < streams; ++s) {
+            const StreamCount& c = counts[s];
+            std::cout << "  port " << port + s << ": " << c.datagrams << " datagrams, " << c.wakeups << " wakeups";
+            if (coro) {
+                std::cout << ", " << c.timeouts << " timeouts";
+            }
+            if (!gens.empty()) {
+                std::cout << ", sent " << gens[s]->get_sent();
+            }
+            std::cout << "\n";
+            total += c.datagrams;
+            bytes += c.bytes;
+        }
+        std::cout << "Total: " << total << " datagrams, " << std::fixed << std::setprecision(1)
+                  << double(bytes) * 8.0 / dt / 1e6 << " Mbps over " << std::setprecision(2) << dt << " s\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
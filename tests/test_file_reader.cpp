@@ -1,6 +1,9 @@
 #include "../data-stream/file_reader.hpp"
+#include "../data-stream/multi_file_reader.hpp"
+#include "../data-stream/chunk_pool.hpp"
 #include <vector>
 #include <iostream>
+#include <memory>
 
 int main(int argc, char* argv[])
 {
@@ -22,18 +25,34 @@ int main(int argc, char* argv[])
     }
 
     try {
-        FileReader fr(f_path, chunk_sz);
-        
-        std::cout << "File: " << fr.get_file_path().string() << "\n";
-        std::cout << "Size: " << fr.get_size() << " bytes\n";
-        std::cout << "Chunks: " << fr.get_chunk_count() << "\n";
-        std::cout << "Chunk size: " << fr.get_chunk_size() << "\n";
+        // Directory, wildcard or @manifest: rotated segments read as one stream
+        bool multi = f_path[0] == '@' || f_path.find_first_of("*?") != std::string::npos || fs::is_directory(f_path);
+        std::unique_ptr<I_STREAM_READER> reader;
+        if (multi) {
+            MultiFileReader* mr = new MultiFileReader(f_path, chunk_sz);
+            reader.reset(mr);
+            std::cout << "Files: " << mr->get_file_count() << "\n";
+            for (size_t i = 0; i < mr->get_file_count(); ++i) {
+                std::cout << "  " << mr->get_file_path(i).string() << " @" << mr->get_file_offset(i)
+                          << ", " << mr->get_file_size(i) << " bytes\n";
+            }
+            std::cout << "Size: " << mr->get_size() << " bytes\n";
+            std::cout << "Chunks: " << mr->get_chunk_count() << "\n";
+        } else {
+            FileReader* fr = new FileReader(f_path, chunk_sz);
+            reader.reset(fr);
+            std::cout << "File: " << fr->get_file_path().string() << "\n";
+            std::cout << "Size: " << fr->get_size() << " bytes\n";
+            std::cout << "Chunks: " << fr->get_chunk_count() << "\n";
+        }
+        std::cout << "Chunk size: " << reader->get_chunk_size() << "\n";
         
-        std::vector<uint8_t> buffer(chunk_sz);
+        ChunkPool pool(chunk_sz, 1);
+        ChunkPool::Chunk buffer = pool.acquire();
         
         size_t total_read = 0;
         while (true) {
-            size_t rd = fr.read_into(buffer.data());
+            size_t rd = reader->read_into(buffer.data());
             if (rd == 0) break;
             
             total_read += rd;
@@ -0,0 +1,178 @@
+#include "../data-stream/iq_convert.hpp"
+#include "../data-stream/file_reader.hpp"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+
+using SteadyClock = std::chrono::steady_clock;
+
+static const IqKernel ALL_KERNELS[] = {
+    IqKernel::SCALAR, IqKernel::SSE2, IqKernel::AVX2, IqKernel::AVX512, IqKernel::NEON
+};
+
+// Every supported kernel vs. scalar, odd lengths and unaligned source/destination
+static bool check_kernels()
+{
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<uint8_t> raw(4 * 1031 + 3);
+    for (size_t k = 0; k + 1 < raw.size(); k += 2) {
+        int16_t v = static_cast<int16_t>(dist(rng));
+        std::memcpy(raw.data() + k, &v, 2);
+    }
+    // Extremes must survive sign extension
+    int16_t lo = -32768, hi = 32767;
+    std::memcpy(raw.data(), &lo, 2);
+    std::memcpy(raw.data() + 2, &hi, 2);
+
+    IqConverter ref(1.0f / INT16_FULL_SCALE, IqKernel::SCALAR);
+    std::vector<cf32> expect(1100), got(1100);
+    bool ok = true;
+
+    for (IqKernel k : ALL_KERNELS) {
+        if (!iq_kernel_supported(k)) {
+            std::cout << "  " << std::setw(7) << iq_kernel_name(k) << ": not supported, skipped\n";
+            continue;
+        }
+        IqConverter conv(1.0f / INT16_FULL_SCALE, k);
+        size_t bad = 0;
+        for (size_t src_off : {0, 1, 2, 6}) {
+            for (size_t bytes : {0, 4, 28, 60, 124, 128, 1000, 4096, 4 * 1031 - 2}) {
+                if (src_off + bytes > raw.size()) {
+                    continue;
+                }
+                size_t n_ref = ref.convert(raw.data() + src_off, bytes, expect.data());
+                size_t n = conv.convert(raw.data() + src_off, bytes, got.data() + 1);  // unaligned dst
+                if (n != n_ref || std::memcmp(expect.data(), got.data() + 1, n * sizeof(cf32)) != 0) {
+                    ++bad;
+                }
+            }
+        }
+        std::cout << "  " << std::setw(7) << iq_kernel_name(k) << ": " << (bad ? "MISMATCH" : "ok") << "\n";
+        ok &= bad == 0;
+    }
+    return ok;
+}
+
+// Header skip per datagram
+static bool check_chunk()
+{
+    const size_t hdr = 8, payload = 64, n_dgrams = 5;
+    std::vector<uint8_t> chunk((hdr + payload) * n_dgrams, 0xEE);
+    std::vector<ChunkSegment> segs;
+    for (size_t d = 0; d < n_dgrams; ++d) {
+        size_t off = d * (hdr + payload);
+        for (size_t k = 0; k < payload / 2; ++k) {
+            int16_t v = static_cast<int16_t>(d * 1000 + k);
+            std::memcpy(chunk.data() + off + hdr + 2 * k, &v, 2);
+        }
+        segs.push_back({off, hdr + payload, 0});
+    }
+    IqConverter conv(1.0f);
+    std::vector<cf32> out(n_dgrams * payload / 4);
+    size_t n = conv.convert_chunk(chunk.data(), chunk.size(), segs.data(), segs.size(), hdr, out.data());
+    bool ok = n == out.size();
+    for (size_t d = 0; ok && d < n_dgrams; ++d) {
+        for (size_t s = 0; s < payload / 4; ++s) {
+            cf32 v = out[d * payload / 4 + s];
+            ok &= v.real() == float(d * 1000 + 2 * s) && v.imag() == float(d * 1000 + 2 * s + 1);
+        }
+    }
+    std::cout << "  convert_chunk (hdr " << hdr << "): " << (ok ? "ok" : "MISMATCH") << "\n";
+    return ok;
+}
+
+static void bench(size_t bytes, int iters)
+{
+    std::vector<uint8_t> raw(bytes);
+    for (size_t k = 0; k < bytes; ++k) {
+        raw[k] = static_cast<uint8_t>(k * 131 + 7);
+    }
+    std::vector<cf32> out(bytes / 4 + 16);
+    for (IqKernel k : ALL_KERNELS) {
+        if (!iq_kernel_supported(k)) {
+            continue;
+        }
+        IqConverter conv(1.0f / INT16_FULL_SCALE, k);
+        conv.convert(raw.data(), bytes, out.data());  // warm up
+        auto t0 = SteadyClock::now();
+        for (int i = 0; i < iters; ++i) {
+            conv.convert(raw.data(), bytes, out.data());
+        }
+        std::chrono::duration<double> dt = SteadyClock::now() - t0;
+        double msps = (double(bytes / 4) * iters) / dt.count() / 1e6;
+        std::cout << "  " << std::setw(7) << iq_kernel_name(k) << ": "
+                  << std::fixed << std::setprecision(1) << msps << " MS/s, "
+                  << (double(bytes) * iters) / dt.count() / (1024.0 * 1024.0) << " MiB/s in\n";
+    }
+}
+
+// Whole file through the pipeline stage (headerless int16 IQ)
+static int convert_file(const std::string& path, size_t chunk_sz)
+{
+    IqStageOpts opts;
+    opts.hdr_sz = 0;
+    IqConvertReader rd(new FileReader(path, chunk_sz), opts, true);
+    std::cout << "Reader: " << rd.get_type() << "\n";
+
+    double power = 0.0;
+    size_t total = 0;
+    const cf32* s;
+    size_t n;
+    auto t0 = SteadyClock::now();
+    while ((n = rd.read_iq(s)) > 0) {
+        for (size_t k = 0; k < n; ++k) {
+            power += std::norm(s[k]);
+        }
+        total += n;
+    }
+    std::chrono::duration<double> dt = SteadyClock::now() - t0;
+    std::cout << "Samples: " << total << "\n"
+              << "Mean power: " << (total ? power / total : 0.0) << " (FS^2)\n"
+              << "Time: " << dt.count() << " s\n";
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    // defaults
+    size_t bench_bytes = 4 * 1024 * 1024;
+    int iters = 50;
+    std::string file;
+    size_t chunk_sz = 4 * 1024 * 1024;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            bench_bytes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--iters") == 0 && i + 1 < argc) {
+            iters = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--file") == 0 && i + 1 < argc) {
+            file = argv[++i];
+        } else if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            chunk_sz = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--size <bytes>] [--iters <n>] [--file <iq_i16.bin> [--chunk <bytes>]]\n";
+            return 1;
+        }
+    }
+
+    try {
+        if (!file.empty()) {
+            return convert_file(file, chunk_sz);
+        }
+        std::cout << "Best kernel: " << iq_kernel_name(best_iq_kernel()) << "\n";
+        std::cout << "Correctness:\n";
+        bool ok = check_kernels();
+        ok &= check_chunk();
+        std::cout << "Throughput (" << bench_bytes << " bytes x " << iters << "):\n";
+        bench(bench_bytes, iters);
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
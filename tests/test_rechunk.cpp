@@ -0,0 +1,188 @@
+#include "../data-stream/rechunk.hpp"
+#include "../data-stream/pipeline.hpp"
+#include "../data-stream/file_reader.hpp"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+
+using SteadyClock = std::chrono::steady_clock;
+
+// Synthetic datagram socket: `batch` datagrams per chunk, 8-byte seq header,
+// then int16 IQ pairs (i = sample index, q = ~i). Every 7th datagram carries
+// 2 junk tail bytes that are not a whole sample.
+class DatagramSource : public I_STREAM_READER {
+private:
+    size_t payload_samples_;
+    size_t batch_;
+    uint64_t datagrams_;
+    uint64_t seq_ = 0;
+    uint32_t sample_ = 0;
+    std::vector<ChunkSegment> segments_;
+
+public:
+    DatagramSource(size_t payload_samples, size_t batch, uint64_t datagrams)
+        : payload_samples_(payload_samples), batch_(batch), datagrams_(datagrams) {}
+
+    size_t read_into(uint8_t* buff_ptr) override {
+        segments_.clear();
+        size_t pos = 0;
+        for (size_t d = 0; d < batch_ && seq_ < datagrams_; ++d, ++seq_) {
+            size_t start = pos;
+            std::memcpy(buff_ptr + pos, &seq_, 8);
+            pos += 8;
+            for (size_t s = 0; s < payload_samples_; ++s, ++sample_) {
+                int16_t iq[2] = {static_cast<int16_t>(sample_), static_cast<int16_t>(~sample_)};
+                std::memcpy(buff_ptr + pos, iq, 4);
+                pos += 4;
+            }
+            if (seq_ % 7 == 3) {
+                buff_ptr[pos++] = 0xEE;
+                buff_ptr[pos++] = 0xEE;
+            }
+            segments_.push_back({start, pos - start, 0});
+        }
+        return pos;
+    }
+
+    size_t get_chunk_size() const noexcept override { return batch_ * (8 + payload_samples_ * 4 + 2); }
+    std::string get_type() const noexcept override { return "datagram source"; }
+
+    size_t get_segments(const ChunkSegment*& segs) const noexcept override {
+        segs = segments_.data();
+        return segments_.size();
+    }
+};
+
+// Every block holds samples block_sample .. block_sample + N - 1
+template<class R>
+static bool verify(R& rc, uint64_t expect_samples, const char* what)
+{
+    const size_t n = rc.get_opts().block_samples;
+    const size_t hop = n - rc.get_opts().overlap;
+    const uint8_t* b;
+    size_t bad = 0;
+    uint64_t blocks = 0;
+    while (rc.read_block(b) > 0) {
+        uint64_t first = rc.get_block_sample();
+        bad += first != blocks * hop;
+        for (size_t s = 0; s < n; ++s) {
+            int16_t iq[2];
+            std::memcpy(iq, b + 4 * s, 4);
+            uint32_t idx = static_cast<uint32_t>(first + s);
+            bad += iq[0] != static_cast<int16_t>(idx) || iq[1] != static_cast<int16_t>(~idx);
+        }
+        ++blocks;
+    }
+    uint64_t expect_blocks = expect_samples < n ? 0 : (expect_samples - n) / hop + 1;
+    bool ok = bad == 0 && blocks == expect_blocks;
+    std::cout << "  " << std::left << std::setw(40) << what << std::right << blocks << " blocks: "
+              << (ok ? "ok" : "MISMATCH") << "\n";
+    return ok;
+}
+
+static bool check_datagrams()
+{
+    bool ok = true;
+    const size_t payload = 1794;  // 7184-byte datagrams minus the 8-byte header, / 4
+    const uint64_t dgrams = 2000;
+    for (bool mirror : {true, false}) {
+        for (size_t overlap : {0, 1024, 4000}) {
+            RechunkOpts o;
+            o.block_samples = 4096;
+            o.overlap = overlap;
+            o.mirror = mirror;
+            o.ring_blocks = 2;
+            RechunkReader rc(new DatagramSource(payload, 8, dgrams), o, true);
+            std::string what = std::string(mirror ? "mirror" : "linear") + ", overlap " + std::to_string(overlap);
+            ok &= verify(rc, payload * dgrams, what.c_str());
+            ok &= rc.get_trimmed_bytes() == 2 * ((dgrams + 3) / 7);
+            ok &= !mirror || rc.is_mirrored();
+        }
+    }
+    // Static pipeline flavor
+    RechunkOpts o;
+    o.block_samples = 1024;
+    Pipeline<DatagramSource, Rechunk> p(o, size_t(100), size_t(3), uint64_t(500));
+    ok &= verify(p, 100 * 500, "pipeline, 100-sample datagrams");
+    return ok;
+}
+
+// Headerless file, chunk size not a multiple of the sample size
+static bool check_file()
+{
+    const std::string path = "test_rechunk.tmp";
+    const uint32_t samples = 100000;
+    {
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) {
+            throw std::runtime_error("Failed to create " + path);
+        }
+        for (uint32_t k = 0; k < samples; ++k) {
+            int16_t iq[2] = {static_cast<int16_t>(k), static_cast<int16_t>(~k)};
+            fwrite(iq, 4, 1, f);
+        }
+        fclose(f);
+    }
+    RechunkOpts o;
+    o.block_samples = 2048;
+    o.overlap = 512;
+    o.hdr_sz = 0;
+    RechunkReader rc(new FileReader(path, 1001), o, true);
+    bool ok = verify(rc, samples, "file, 1001-byte chunks, overlap 512");
+    std::remove(path.c_str());
+    return ok;
+}
+
+static void bench(uint64_t dgrams)
+{
+    for (bool mirror : {true, false}) {
+        RechunkOpts o;
+        o.block_samples = 4096;
+        o.overlap = 2048;
+        o.mirror = mirror;
+        RechunkReader rc(new DatagramSource(1794, 32, dgrams), o, true);
+        const uint8_t* b;
+        volatile uint8_t sink = 0;
+        uint64_t blocks = 0;
+        auto t0 = SteadyClock::now();
+        while (rc.read_block(b) > 0) {
+            sink = b[0];
+            ++blocks;
+        }
+        std::chrono::duration<double> dt = SteadyClock::now() - t0;
+        std::cout << "  " << (mirror ? "mirror" : "linear") << ": " << std::fixed << std::setprecision(1)
+                  << double(blocks) / dt.count() / 1e3 << " kblocks/s, "
+                  << double(dgrams * 1794) / dt.count() / 1e6 << " MS/s in (last byte "
+                  << int(sink) << ")\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // defaults
+    uint64_t bench_dgrams = 200000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--dgrams") == 0 && i + 1 < argc) {
+            bench_dgrams = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--dgrams <n>]\n";
+            return 1;
+        }
+    }
+
+    try {
+        std::cout << "Correctness:\n";
+        bool ok = check_datagrams();
+        ok &= check_file();
+        std::cout << "Throughput (" << bench_dgrams << " datagrams, 4096/2048 blocks):\n";
+        bench(bench_dgrams);
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
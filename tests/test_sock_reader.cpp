@@ -1,4 +1,8 @@
 #include "../data-stream/sock_reader.hpp"
+#include "../data-stream/threaded_reader.hpp"
+#include "../data-stream/chunk_pool.hpp"
+#include "../data-stream/seq_tracker.hpp"
+#include "../data-stream/multi_queue_reader.hpp"
 #include <vector>
 #include <iostream>
 #include <iomanip>
@@ -32,10 +36,20 @@ constexpr int32_t DEFAULT_TIMEOUT_MS = 1000;  // 1 second
 
 void _usage(const char* proga)
 {
-    std::cout << "Usage: " << proga << " [--addr dev:ip:port] [--sz <pkt_sz_max>] [--dur-sec <sec>] [--raw]"
+    std::cout << "Usage: " << proga << " [--addr dev:ip:port] [--sz <pkt_sz_max>] [--dur-sec <sec>] [--raw] [--batch <n>] [--tpacket | --pcap | --xdp [--xdp-generic]] [--threaded [--cpu <n>|nic|rx] [--rt <prio>]] [--seq [--zero-fill]] [--queues <n> [--balance hash|rr|cpu|seq]] [--tstamp sw|hw] [--busy-poll <us>] [--busy-wait] [--numa <node>|nic] [--rcvbuf <bytes>] [--rcvbuf-auto] [--quiet]"
               << "\n   1) until Ctrl+C: " << proga << " --addr enp3s0:192.168.250.196:9999 --sz 7184" 
               << "\n   2) Fixed dur: " << proga << " --addr lo:127.0.0.1:9999 --dur-sec 1.45"
               << "\n   3) Raw socket: " << proga << " --addr enp3s0:192.168.250.196:9999 --sz 7184 --raw"
+              << "\n   4) Batched: " << proga << " --addr lo:127.0.0.1:9999 --sz 459776 --batch 64"
+              << "\n   5) TPACKET_V3 ring: " << proga << " --addr enp3s0:192.168.250.196:9999 --sz 7184 --raw --tpacket"
+              << "\n   6) Capture thread: " << proga << " --addr lo:127.0.0.1:9999 --threaded --cpu 2"
+              << "\n   7) Loss accounting: " << proga << " --addr lo:127.0.0.1:9999 --batch 64 --sz 459776 --seq --zero-fill"
+              << "\n   8) Multi-queue: " << proga << " --addr lo:127.0.0.1:9999 --batch 64 --sz 459776 --queues 4 --cpu 0 --balance seq"
+              << "\n   9) Kernel timestamps: " << proga << " --addr lo:127.0.0.1:9999 --tstamp sw"
+              << "\n  10) libpcap / Npcap: " << proga << " --addr \\Device\\NPF_{GUID}:192.168.250.196:9999 --sz 459776 --batch 64 --pcap"
+              << "\n  11) AF_XDP: " << proga << " --addr enp3s0:192.168.250.196:9999 --sz 459776 --batch 64 --xdp"
+              << "\n  12) Low latency: " << proga << " --addr enp3s0:192.168.250.196:9999 --batch 64 --sz 459776 --threaded --cpu nic --rt 50 --busy-poll 50 --numa nic"
+              << "\n  13) Bursty source: " << proga << " --addr lo:127.0.0.1:9999 --sz 7184 --rcvbuf 1048576 --rcvbuf-auto"
               << "\n" 
               << std::endl;
 }
@@ -80,6 +94,14 @@ int main(int argc, const char* argv[])
     bool is_raw = false;
     size_t chunk_sz = 9000;
     double dur_sec = -1.0;  // negative = infinite
+    bool quiet = false;     // no per-read lines (rate tests)
+    SocketReaderOpts opts;
+    bool threaded = false;
+    ThreadedReaderOpts thr_opts;
+    bool track_seq = false;
+    SeqTrackerOpts seq_opts;
+    MultiQueueOpts mq_opts;
+    mq_opts.queues = 0;  // 0 = single socket
     
     // Parse arguments
     for (int i = 1; i < argc; ++i) {
@@ -124,6 +146,138 @@ int main(int argc, const char* argv[])
                 return 1;
             }
         }
+        else if (std::strcmp(argv[i], "--batch") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --batch requires argument\n";
+                _usage(argv[0]);
+                return 1;
+            }
+            char* end;
+            long val = std::strtol(argv[++i], &end, 10);
+            if (*end != '\0' || val <= 0) {
+                std::cerr << "Invalid batch: " << argv[i] << "\n";
+                return 1;
+            }
+            opts.batch = static_cast<size_t>(val);
+        }
+        else if (std::strcmp(argv[i], "--threaded") == 0) {
+            threaded = true;
+        }
+        else if (std::strcmp(argv[i], "--cpu") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --cpu requires argument\n";
+                _usage(argv[0]);
+                return 1;
+            }
+            ++i;
+            if (std::strcmp(argv[i], "nic") == 0) {
+                thr_opts.cpu = CPU_NIC_LOCAL;
+                continue;
+            }
+            if (std::strcmp(argv[i], "rx") == 0) {
+                thr_opts.cpu = CPU_FOLLOW_RX;
+                continue;
+            }
+            char* end;
+            long val = std::strtol(argv[i], &end, 10);
+            if (*end != '\0' || val < 0) {
+                std::cerr << "Invalid cpu: " << argv[i] << "\n";
+                return 1;
+            }
+            thr_opts.cpu = static_cast<int>(val);
+        }
+        else if (std::strcmp(argv[i], "--rt") == 0 && i + 1 < argc) {
+            thr_opts.rt_priority = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--busy-poll") == 0 && i + 1 < argc) {
+            opts.busy_poll_us = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--busy-wait") == 0) {
+            opts.busy_wait = true;
+        }
+        else if (std::strcmp(argv[i], "--rcvbuf") == 0 && i + 1 < argc) {
+            opts.rcvbuf = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--rcvbuf-auto") == 0) {
+            opts.rcvbuf_auto = true;
+        }
+        else if (std::strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        }
+        else if (std::strcmp(argv[i], "--numa") == 0 && i + 1 < argc) {
+            ++i;
+            opts.numa_node = std::strcmp(argv[i], "nic") == 0 ? NUMA_NIC_NODE : std::atoi(argv[i]);
+        }
+        else if (std::strcmp(argv[i], "--queues") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --queues requires argument\n";
+                _usage(argv[0]);
+                return 1;
+            }
+            char* end;
+            long val = std::strtol(argv[++i], &end, 10);
+            if (*end != '\0' || val <= 0) {
+                std::cerr << "Invalid queue count: " << argv[i] << "\n";
+                return 1;
+            }
+            mq_opts.queues = static_cast<size_t>(val);
+        }
+        else if (std::strcmp(argv[i], "--balance") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --balance requires argument\n";
+                _usage(argv[0]);
+                return 1;
+            }
+            const char* b = argv[++i];
+            if (std::strcmp(b, "hash") == 0) {
+                mq_opts.balance = QueueBalance::HASH;
+            } else if (std::strcmp(b, "rr") == 0) {
+                mq_opts.balance = QueueBalance::ROUND_ROBIN;
+            } else if (std::strcmp(b, "cpu") == 0) {
+                mq_opts.balance = QueueBalance::CPU;
+            } else if (std::strcmp(b, "seq") == 0) {
+                mq_opts.balance = QueueBalance::SEQ;
+            } else {
+                std::cerr << "Invalid balance: " << b << "\n";
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--seq") == 0) {
+            track_seq = true;
+        }
+        else if (std::strcmp(argv[i], "--zero-fill") == 0) {
+            seq_opts.policy = GapPolicy::ZERO_FILL;
+        }
+        else if (std::strcmp(argv[i], "--tstamp") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --tstamp requires argument\n";
+                _usage(argv[0]);
+                return 1;
+            }
+            const char* t = argv[++i];
+            if (std::strcmp(t, "sw") == 0) {
+                opts.timestamps = TimestampMode::SOFTWARE;
+            } else if (std::strcmp(t, "hw") == 0) {
+                opts.timestamps = TimestampMode::HARDWARE;
+            } else {
+                std::cerr << "Invalid timestamp mode: " << t << "\n";
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--tpacket") == 0) {
+            opts.engine = SocketEngine::TPACKET;
+        }
+        else if (std::strcmp(argv[i], "--pcap") == 0) {
+            opts.engine = SocketEngine::PCAP;
+            is_raw = true;
+        }
+        else if (std::strcmp(argv[i], "--xdp") == 0) {
+            opts.engine = SocketEngine::XDP;
+            is_raw = true;
+        }
+        else if (std::strcmp(argv[i], "--xdp-generic") == 0) {
+            opts.xdp_mode = XdpMode::GENERIC;
+        }
         else if (std::strcmp(argv[i], "--raw") == 0) {
             is_raw = true;
         }
@@ -136,12 +290,32 @@ int main(int argc, const char* argv[])
     
     try {
         // Create socket reader
-        I_STREAM_READER* reader = create_socket_reader(
-            src_ip, port, dev,
-            DEFAULT_TIMEOUT_MS,
-            chunk_sz,
-            is_raw
-        );
+        I_STREAM_READER* reader = nullptr;
+        MultiQueueReader* mq_reader = nullptr;
+        if (mq_opts.queues > 0) {
+            mq_opts.first_cpu = thr_opts.cpu;
+            mq_opts.rt_priority = thr_opts.rt_priority;
+            mq_reader = new MultiQueueReader(src_ip, port, dev, DEFAULT_TIMEOUT_MS, chunk_sz, is_raw, opts, mq_opts);
+            reader = mq_reader;
+        } else {
+            reader = create_socket_reader(
+                src_ip, port, dev,
+                DEFAULT_TIMEOUT_MS,
+                chunk_sz,
+                is_raw,
+                opts
+            );
+        }
+        if (threaded) {
+            thr_opts.cpu = resolve_cpu(thr_opts.cpu, dev);
+            thr_opts.numa_node = resolve_numa_node(opts.numa_node, dev);
+            reader = new ThreadedStreamReader(reader, thr_opts, true);
+        }
+        SeqTrackingReader* seq_reader = nullptr;
+        if (track_seq) {
+            seq_reader = new SeqTrackingReader(reader, seq_opts, true);
+            reader = seq_reader;
+        }
         
         std::cout << "Starting reader: " << reader->get_type() 
                   << " [" << src_ip << ":" << port << "]"
@@ -151,6 +325,9 @@ int main(int argc, const char* argv[])
         if (is_raw) {
             std::cout << " dev=" << dev;
         }
+        if (opts.batch > 1) {
+            std::cout << " batch=" << opts.batch;
+        }
         
         if (dur_sec > 0) {
             std::cout << " duration=" << dur_sec << "s";
@@ -160,7 +337,8 @@ int main(int argc, const char* argv[])
         std::cout << "\n" << std::endl;
         
         // Allocate buffer
-        std::vector<uint8_t> buffer(chunk_sz);
+        ChunkPool pool(chunk_sz, 1);
+        ChunkPool::Chunk buffer = pool.acquire();
         
         // Statistics
         size_t total_bytes = 0;
@@ -193,13 +371,52 @@ int main(int argc, const char* argv[])
                 auto since_last = now - last_packet_time;
                 last_packet_time = now;
                 
+                const ChunkSegment* segs;
+                size_t seg_count = reader->get_segments(segs);
+                if (seg_count == 0 && bytes_read > 0) {
+                    seg_count = 1;
+                }
+
                 total_bytes += bytes_read;
-                packet_count++;
+                packet_count += seg_count;
+                if (quiet) {
+                    continue;  // summary only: per-read output caps the rate at stdout speed
+                }
                 
                 std::cout << "[" << (now - start_time) << "] "
                           << "Packet #" << packet_count 
-                          << ": " << bytes_read << " bytes"
-                          << " (gap: " << since_last << ")"
+                          << ": " << bytes_read << " bytes";
+                if (seg_count > 1) {
+                    std::cout << " in " << seg_count << " datagrams";
+                }
+                size_t filled = 0;
+                bool truncated = false;
+                for (size_t k = 0; segs && k < seg_count; ++k) {
+                    truncated |= (segs[k].flags & SEG_TRUNCATED) != 0;
+                    filled += (segs[k].flags & SEG_FILLED) ? 1 : 0;
+                }
+                if (truncated) {
+                    std::cout << " [TRUNCATED]";
+                }
+                if (filled) {
+                    std::cout << " [FILLED " << filled << "]";
+                }
+                const PacketMeta* meta;
+                size_t meta_count = reader->get_packet_meta(meta);
+                if (meta_count > 0) {
+                    const PacketMeta& m = meta[meta_count - 1];
+                    std::cout << " from " << (m.src_ip >> 24) << "." << ((m.src_ip >> 16) & 0xFF) << "."
+                              << ((m.src_ip >> 8) & 0xFF) << "." << (m.src_ip & 0xFF) << ":" << m.src_port;
+                    if (m.ts_source == TsSource::SOFTWARE) {
+                        // Kernel receive -> here, same clock (CLOCK_REALTIME)
+                        int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count();
+                        std::cout << " latency: " << (now_ns - static_cast<int64_t>(m.ts_ns)) / 1000 << "us";
+                    } else if (m.ts_source == TsSource::HARDWARE) {
+                        std::cout << " nic_ts: " << m.ts_ns << "ns";
+                    }
+                }
+                std::cout << " (gap: " << since_last << ")"
                           << std::endl;
                 
             } catch (const ReadTimeout& e) {
@@ -240,6 +457,39 @@ int main(int argc, const char* argv[])
             }
         }
         
+        if (mq_reader) {
+            std::cout << "Per queue datagrams:";
+            for (size_t q = 0; q < mq_reader->get_queue_count(); ++q) {
+                std::cout << " " << mq_reader->get_queue_datagrams(q);
+            }
+            std::cout << " (out of order: " << mq_reader->get_out_of_order_count()
+                      << ", forced: " << mq_reader->get_forced_count() << ")" << std::endl;
+        }
+        if (seq_reader) {
+            const SeqStats& st = seq_reader->get_seq_stats();
+            std::cout << "Seq range: " << st.first_seq << " .. " << st.last_seq << std::endl;
+            std::cout << "Lost: " << st.lost << " in " << st.gaps << " gaps"
+                      << " (" << std::fixed << std::setprecision(4) << seq_reader->get_loss_ratio() * 100.0 << "%)" << std::endl;
+            std::cout << "Duplicates: " << st.duplicates << ", reordered: " << st.reordered
+                      << ", filled: " << st.filled << ", resyncs: " << st.resyncs << std::endl;
+        }
+        
+        ReaderStats rs;
+        if (reader->get_stats(rs)) {  // built with DATASTREAM_WITH_STATS
+            std::cout << "Reader stats: " << rs.reads << " reads, " << rs.packets << " datagrams, "
+                      << rs.wrong_port << " wrong port, " << rs.bad_frames << " bad frames, "
+                      << rs.truncated << " truncated, "
+                      << rs.timeouts << " timeouts";
+            if (rs.kernel_drops_valid) {
+                std::cout << ", kernel drops " << rs.kernel_drops;
+            }
+            if (rs.rcvbuf_bytes) {
+                std::cout << ", rcvbuf " << rs.rcvbuf_bytes << " bytes (" << rs.rcvbuf_raises << " raises)";
+            }
+            std::cout << "\nread_into: p50 <= " << rs.read_ns_quantile(0.5) << " ns, p99 <= "
+                      << rs.read_ns_quantile(0.99) << " ns" << std::endl;
+        }
+
         // Cleanup
         delete reader;
         
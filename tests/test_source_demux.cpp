@@ -0,0 +1,186 @@
+#include "../data-stream/sock_reader.hpp"
+#include "../data-stream/source_demux.hpp"
+#include "../data-stream/seq_tracker.hpp"
+#include "udp_load_gen.hpp"
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <atomic>
+
+static std::atomic<bool> g_stop{false};
+
+static void signal_handler(int) { g_stop = true; }
+
+struct SourceCount {
+    uint64_t datagrams = 0;
+    uint64_t bytes = 0;
+    SeqStats seq;
+};
+
+// One consumer thread per source, loss accounting through SeqTrackingReader
+static void consume(SourceStream* src, SourceCount& c)
+{
+    SeqTrackerOpts so;
+    so.drop_duplicates = false;
+    SeqTrackingReader tracker(src, so);
+    std::vector<uint8_t> buf(tracker.get_chunk_size());
+    try {
+        while (!g_stop) {
+            size_t rd;
+            try {
+                rd = tracker.read_into(buf.data());
+            } catch (const ReadTimeout&) {
+                continue;
+            }
+            if (rd == 0) {
+                break;
+            }
+            const ChunkSegment* segs;
+            c.datagrams += tracker.get_segments(segs);
+            c.bytes += rd;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << src->get_type() << ": " << e.what() << "\n";
+    }
+    c.seq = tracker.get_seq_stats();
+}
+
+int main(int argc, char* argv[])
+{
+    // defaults
+    std::string ip = "127.0.0.1";
+    uint16_t port = 9999;
+    std::string dev;
+    size_t gens_n = 4;           // built-in senders, one source each
+    double gen_mbps = 100.0;
+    size_t pkt = 1400;
+    size_t chunk_sz = 65536;
+    double dur_sec = 5.0;
+    bool is_raw = false;
+    SocketReaderOpts opts;
+    opts.packet_meta = true;
+    SourceDemuxOpts dopts;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--addr") == 0 && i + 1 < argc) {
+            std::string a = argv[++i];
+            size_t c = a.rfind(':');
+            ip = a.substr(0, c);
+            if (ip.size() > 1 && ip.front() == '[' && ip.back() == ']') {
+                ip = ip.substr(1, ip.size() - 2);
+            }
+            port = static_cast<uint16_t>(std::atoi(a.c_str() + c + 1));
+        } else if (std::strcmp(argv[i], "--dev") == 0 && i + 1 < argc) {
+            dev = argv[++i];
+        } else if (std::strcmp(argv[i], "--gen") == 0 && i + 1 < argc) {
+            gen_mbps = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--sources") == 0 && i + 1 < argc) {
+            gens_n = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--pkt") == 0 && i + 1 < argc) {
+            pkt = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--sz") == 0 && i + 1 < argc) {
+            chunk_sz = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--dur-sec") == 0 && i + 1 < argc) {
+            dur_sec = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            opts.batch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            dopts.depth = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--ssm") == 0 && i + 1 < argc) {
+            opts.mcast_sources.push_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--raw") == 0) {
+            is_raw = true;
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--addr ip:port] [--dev <iface>] [--sources <n>] [--gen <Mbps per source>] [--pkt <bytes>]"
+                      << " [--sz <chunk>] [--dur-sec <sec>] [--batch <n>] [--depth <datagrams>] [--ssm <src ip>]... [--raw]"
+                      << "\n   1) unicast, 4 senders:   " << argv[0] << " --addr 127.0.0.1:9999 --sources 4 --gen 100"
+                      << "\n   2) multicast on lo:      " << argv[0] << " --addr 239.1.2.3:9999 --dev lo --batch 32"
+                      << "\n   3) source-specific:      " << argv[0] << " --addr 232.1.2.3:9999 --dev lo --ssm 127.0.0.1  (senders bind to the --ssm address)"
+                      << "\n   4) IPv6:                 " << argv[0] << " --addr [::1]:9999"
+                      << "\n";
+            return 1;
+        }
+    }
+    std::signal(SIGINT, signal_handler);
+
+    try {
+        SourceDemux demux(create_socket_reader(ip, port, dev, 100, chunk_sz, is_raw, opts), dopts, true);
+
+        std::vector<std::unique_ptr<UdpLoadGen>> gens;
+        for (size_t g = 0; g < gens_n; ++g) {
+            gens.emplace_back(new UdpLoadGen(ip, port, pkt, gen_mbps * 1e6, 8));
+            if (is_multicast_address(ip)) {
+                gens.back()->set_multicast_interface(dev.empty() ? "lo" : dev);
+            }
+            if (!opts.mcast_sources.empty()) {
+                // Otherwise the kernel sources the group from the host's primary address
+                gens.back()->set_source_address(opts.mcast_sources[g % opts.mcast_sources.size()]);
+            }
+        }
+        std::cout << "Source demux: " << demux.get_inner()->get_type() << " on " << ip << ":" << port
+                  << (dev.empty() ? "" : " dev " + dev) << ", " << gens_n << " senders x " << gen_mbps << " Mbps\n";
+
+        for (auto& g : gens) {
+            g->start();
+        }
+        std::vector<SourceCount> counts(gens_n);
+        std::vector<std::thread> consumers;
+        auto t0 = std::chrono::steady_clock::now();
+        auto elapsed = [&]() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
+        for (size_t s = 0; s < gens_n && !g_stop; ++s) {
+            SourceStream* src = demux.wait_for_source(s, 2000);
+            if (!src) {
+                std::cerr << "Warning: source " << s << " did not appear\n";
+                break;
+            }
+            consumers.emplace_back(consume, src, std::ref(counts[s]));
+        }
+        while (!g_stop && elapsed() < dur_sec) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        for (auto& g : gens) {
+            g->stop();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));  // drain
+        double dt = elapsed();
+        g_stop = true;
+        for (auto& t : consumers) {
+            t.join();
+        }
+
+        uint64_t total = 0, bytes = 0;
+        for (size_t s = 0; s < consumers.size(); ++s) {
+            const SourceStream* src = demux.get_source(s);
+            const SourceCount& c = counts[s];
+            std::cout << "  " << std::left << std::setw(24) << src->get_source().to_string() << std::right
+                      << c.datagrams << " datagrams, lost " << c.seq.lost << " (" << c.seq.gaps << " gaps), reordered "
+                      << c.seq.reordered << ", queue drops " << src->get_dropped_count() << "\n";
+            total += c.datagrams;
+            bytes += c.bytes;
+        }
+        uint64_t sent = 0;
+        for (auto& g : gens) {
+            sent += g->get_sent();
+        }
+        std::cout << "Total: " << total << " of " << sent << " sent, unmatched " << demux.get_unmatched_count() << ", "
+                  << std::fixed << std::setprecision(1) << double(bytes) * 8.0 / dt / 1e6 << " Mbps over "
+                  << std::setprecision(2) << dt << " s\n";
+        if (consumers.size() < gens_n || total == 0) {
+            std::cerr << "Error: " << consumers.size() << " of " << gens_n << " sources seen, " << total
+                      << " datagrams received\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include "../data-stream/spectrum.hpp"
+#include "../data-stream/file_reader.hpp"
+#include "../data-stream/sock_reader.hpp"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <atomic>
+
+using SteadyClock = std::chrono::steady_clock;
+
+std::atomic<bool> g_shutdown_requested{false};
+
+void signal_handler(int signal) {
+    if (signal == SIGINT) {
+        g_shutdown_requested.store(true);
+    }
+}
+
+// Plan vs. naive DFT, every length 2..4096
+static bool check_fft()
+{
+    bool ok = true;
+    for (size_t n = 2; n <= 4096; n *= 2) {
+        std::vector<cf32> x(n), ref(n);
+        for (size_t k = 0; k < n; ++k) {
+            x[k] = cf32(std::sin(0.37f * k) + 0.1f * (k % 7), std::cos(1.3f * k));
+        }
+        for (size_t f = 0; f < n; ++f) {
+            std::complex<double> s = 0.0;
+            for (size_t k = 0; k < n; ++k) {
+                double a = -2.0 * fft_detail::PI * double(f * k % n) / double(n);
+                s += std::complex<double>(x[k]) * std::complex<double>(std::cos(a), std::sin(a));
+            }
+            ref[f] = cf32(s);
+        }
+        get_fft_plan(n)->execute(x.data());
+        double err = 0.0, mag = 0.0;
+        for (size_t f = 0; f < n; ++f) {
+            err = std::max(err, double(std::abs(x[f] - ref[f])));
+            mag = std::max(mag, double(std::abs(ref[f])));
+        }
+        bool pass = err <= 1e-4 * mag * std::log2(double(n));
+        ok &= pass;
+        if (!pass) {
+            std::cout << "  fft " << n << ": max error " << err << " MISMATCH\n";
+        }
+    }
+    std::cout << "  fft 2..4096 vs DFT (" << (get_fft_plan(1024)->is_simd() ? "avx2" : "scalar") << "): "
+              << (ok ? "ok" : "MISMATCH") << "\n";
+    return ok;
+}
+
+// Full-scale complex tone must read 0 dBFS at its bin with every window
+static bool check_tone()
+{
+    bool ok = true;
+    const size_t n = 1024, bin = 100;
+    for (WindowType w : {WindowType::RECT, WindowType::HANN, WindowType::BLACKMAN_HARRIS, WindowType::GAUSS}) {
+        SpectrumOpts opts;
+        opts.fft_n = n;
+        opts.window = w;
+        opts.averages = 4;
+        opts.overlap = n / 2;
+        SpectrumEngine eng(opts);
+        std::vector<cf32> tone(8 * n);
+        for (size_t k = 0; k < tone.size(); ++k) {
+            double a = 2.0 * fft_detail::PI * double(bin) * double(k) / double(n);
+            tone[k] = cf32(float(std::cos(a)), float(std::sin(a))) * std::sqrt(COMPLEX_SCALING_FACTOR);
+        }
+        eng.push(tone.data(), tone.size());
+        SpectrumFrame f;
+        bool got = eng.get_latest(f);
+        size_t peak = 0;
+        for (size_t k = 0; got && k < n; ++k) {
+            if (f.bins[k] > f.bins[peak]) {
+                peak = k;
+            }
+        }
+        bool pass = got && peak == n / 2 + bin && std::fabs(f.bins[peak]) < 0.01f && eng.get_window_count() == 15;
+        ok &= pass;
+        std::cout << "  tone " << std::setw(2) << int(w) << ": peak " << (got ? f.bins[peak] : 0.0f)
+                  << " dBFS @ bin " << peak << (pass ? " ok" : " MISMATCH") << "\n";
+    }
+    return ok;
+}
+
+static void bench(size_t n, int iters)
+{
+    auto plan = get_fft_plan(n);
+    std::vector<cf32> x(n, cf32(0.5f, -0.25f));
+    auto t0 = SteadyClock::now();
+    for (int i = 0; i < iters; ++i) {
+        plan->execute(x.data());
+    }
+    std::chrono::duration<double> dt = SteadyClock::now() - t0;
+    std::cout << "  fft " << n << ": " << std::fixed << std::setprecision(2)
+              << dt.count() / iters * 1e6 << " us, "
+              << double(n) * iters / dt.count() / 1e6 << " MS/s\n";
+    std::cout.unsetf(std::ios::fixed);
+}
+
+void parse_addr(const char* addr, std::string& dev, std::string& ip, uint16_t& port)
+{
+    std::string full(addr);
+    size_t c1 = full.find(':');
+    size_t c2 = c1 == std::string::npos ? c1 : full.find(':', c1 + 1);
+    if (c2 == std::string::npos) {
+        throw std::runtime_error("Invalid format, expected dev:ip:port");
+    }
+    dev = full.substr(0, c1);
+    ip = full.substr(c1 + 1, c2 - c1 - 1);
+    port = static_cast<uint16_t>(std::strtoul(full.substr(c2 + 1).c_str(), nullptr, 10));
+}
+
+// Stream through the stage; a display thread polls the mailbox at render rate
+static int run_stream(I_STREAM_READER* reader, const SpectrumOpts& opts, const IqStageOpts& iq,
+                      double fs, double render_sec)
+{
+    SpectrumStage stage(reader, opts, iq, true);
+    std::cout << "Reader: " << stage.get_converter().get_type() << "\n"
+              << "FFT: " << opts.fft_n << " overlap " << opts.overlap << " avg " << opts.averages
+              << " publish 1/" << opts.publish_every << "\n";
+    std::vector<double> freqs = stage.get_engine().get_freqs(fs);
+
+    std::atomic<bool> done{false};
+    std::thread display([&] {
+        SpectrumFrame f;
+        while (!done.load()) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(render_sec));
+            if (!stage.get_engine().get_latest(f)) {
+                continue;
+            }
+            size_t peak = 0;
+            for (size_t k = 1; k < f.bins.size(); ++k) {
+                if (f.bins[k] > f.bins[peak]) {
+                    peak = k;
+                }
+            }
+            std::cout << "[FRAME " << f.index << "] peak " << std::fixed << std::setprecision(2)
+                      << f.bins[peak] << " dBFS @ " << freqs[peak] * 1e-3 << " kHz\n";
+            std::cout.unsetf(std::ios::fixed);
+        }
+    });
+
+    auto t0 = SteadyClock::now();
+    uint64_t samples = stage.run(g_shutdown_requested);
+    std::chrono::duration<double> dt = SteadyClock::now() - t0;
+    done.store(true);
+    display.join();
+
+    const SpectrumEngine& eng = stage.get_engine();
+    std::cout << "Samples: " << samples << "\n"
+              << "Windows: " << eng.get_window_count() << "\n"
+              << "Frames: " << eng.get_frame_count() << " (published " << eng.get_published_count() << ")\n"
+              << "Time: " << dt.count() << " s, " << double(samples) / dt.count() / 1e6 << " MS/s\n";
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    // defaults
+    SpectrumOpts opts;
+    IqStageOpts iq;
+    std::string file;
+    std::string addr;
+    size_t chunk_sz = 1024 * 1024;
+    size_t pkt_sz = 8192 + 8;
+    size_t batch = 1;
+    double fs = 480e3;
+    double render_sec = 0.1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--file") == 0 && i + 1 < argc) {
+            file = argv[++i];
+        } else if (std::strcmp(argv[i], "--addr") == 0 && i + 1 < argc) {
+            addr = argv[++i];
+        } else if (std::strcmp(argv[i], "--sz") == 0 && i + 1 < argc) {
+            pkt_sz = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--fft") == 0 && i + 1 < argc) {
+            opts.fft_n = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--overlap") == 0 && i + 1 < argc) {
+            opts.overlap = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--avg") == 0 && i + 1 < argc) {
+            opts.averages = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--ema") == 0 && i + 1 < argc) {
+            opts.ema_alpha = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--publish-every") == 0 && i + 1 < argc) {
+            opts.publish_every = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--fs") == 0 && i + 1 < argc) {
+            fs = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--hdr") == 0 && i + 1 < argc) {
+            iq.hdr_sz = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--file <iq_i16.bin> | --addr dev:ip:port [--sz <pkt_sz>] [--batch <n>]]"
+                      << " [--fft <n>] [--overlap <n>] [--avg <n>] [--ema <alpha>] [--publish-every <n>] [--fs <Hz>] [--hdr <bytes>]"
+                      << "\n   1) self test: " << argv[0]
+                      << "\n   2) file: " << argv[0] << " --file iq.bin --fft 4096 --overlap 2048"
+                      << "\n   3) UDP (fft_opt.py layout): " << argv[0] << " --addr lo:127.0.0.1:9999 --batch 32\n";
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, signal_handler);
+    try {
+        if (!file.empty()) {
+            iq.hdr_sz = 0;
+            return run_stream(new FileReader(file, chunk_sz), opts, iq, fs, render_sec);
+        }
+        if (!addr.empty()) {
+            std::string dev, ip;
+            uint16_t port;
+            parse_addr(addr.c_str(), dev, ip, port);
+            SocketReaderOpts sopts;
+            sopts.batch = batch;
+            size_t sz = pkt_sz * (batch ? batch : 1);
+            return run_stream(create_socket_reader(ip, port, dev, 750, sz, false, sopts), opts, iq, fs, render_sec);
+        }
+        std::cout << "Correctness:\n";
+        bool ok = check_fft();
+        ok &= check_tone();
+        std::cout << "Throughput:\n";
+        for (size_t n : {256, 1024, 4096, 65536}) {
+            bench(n, int(4000000 / n) + 1);
+        }
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,319 @@
+// End-to-end UDP qualification: a paced UdpLoadGen (or an external udp_gen)
+// drives a DeployReader URI at each rate of a sweep; the receiver stays
+// quiet and reports loss, reordering and one-way latency per rate, then the
+// highest rate whose loss stayed within --max-loss.
+// One-way latency = receive time in user space - send stamp in the datagram
+// (same host, or hosts on PTP / NTP synced clocks). With tstamp=sw in the
+// URI the kernel receive time splits it into stack and reader parts.
+#include "../data-stream/deploy_reader.hpp"
+#include "../data-stream/seq_tracker.hpp"
+#include "udp_load_gen.hpp"
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+#include <atomic>
+
+using SteadyClock = std::chrono::steady_clock;
+
+static std::atomic<bool> g_stop{false};
+
+static void signal_handler(int) { g_stop = true; }
+
+struct Latency {
+    double p50_us = 0.0, p99_us = 0.0, p999_us = 0.0, max_us = 0.0;
+    size_t samples = 0;
+};
+
+struct RateResult {
+    double target_gbps = 0.0;  // 0 = generator at max rate, < 0 = external generator
+    uint64_t sent = 0;         // 0 when external
+    uint64_t received = 0;     // unique datagrams
+    uint64_t lost = 0;
+    uint64_t reordered = 0;
+    uint64_t duplicates = 0;
+    bool kernel_drops_valid = false;
+    uint64_t kernel_drops = 0;
+    double rx_gbps = 0.0;      // first to last datagram
+    Latency app;               // send -> read_into() returned
+    Latency kernel;            // send -> kernel receive timestamp (tstamp=sw)
+
+    double loss_ratio() const noexcept {
+        uint64_t total = received + lost;
+        return total ? double(lost) / double(total) : 0.0;
+    }
+};
+
+// Samples kept per rate (uint32 ns); later datagrams still count for loss
+constexpr size_t MAX_LAT_SAMPLES = 1u << 24;
+
+static Latency summarize(std::vector<uint32_t>& ns)
+{
+    Latency l;
+    l.samples = ns.size();
+    if (ns.empty()) {
+        return l;
+    }
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&](double p) {
+        size_t i = std::min(ns.size() - 1, static_cast<size_t>(p * double(ns.size())));
+        return double(ns[i]) * 1e-3;
+    };
+    l.p50_us = pct(0.50);
+    l.p99_us = pct(0.99);
+    l.p999_us = pct(0.999);
+    l.max_us = double(ns.back()) * 1e-3;
+    return l;
+}
+
+static void add_sample(std::vector<uint32_t>& v, int64_t ns)
+{
+    if (v.size() < MAX_LAT_SAMPLES) {
+        v.push_back(static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(ns, 0), UINT32_MAX)));
+    }
+}
+
+struct RunCfg {
+    ReaderUri uri;
+    size_t chunk = 0;
+    size_t pkt = 1400;
+    size_t gen_batch = 32;
+    double seconds = 3.0;
+    bool external = false;
+};
+
+static RateResult run_rate(const RunCfg& cfg, double gbps)
+{
+    RateResult r;
+    r.target_gbps = cfg.external ? -1.0 : gbps;
+
+    std::string dev, ip;
+    uint16_t port = 0;
+    deploy_detail::parse_endpoint(cfg.uri.location, dev, ip, port);
+    std::unique_ptr<I_STREAM_READER> sock(DeployReader(cfg.chunk, cfg.uri));
+    SeqTrackingReader reader(sock.get(), SeqTrackerOpts());
+    std::vector<uint8_t> buf(reader.get_chunk_size());
+    std::vector<uint32_t> app_ns, kernel_ns;
+
+    std::unique_ptr<UdpLoadGen> gen;
+    if (!cfg.external) {
+        // Wildcard bind: send over loopback
+        std::string dst = ip == "0.0.0.0" ? "127.0.0.1" : (ip == "::" ? "::1" : ip);
+        gen.reset(new UdpLoadGen(dst, port, cfg.pkt, gbps * 1e9, cfg.gen_batch));
+        gen->set_timestamps(true);
+        if (is_multicast_address(dst)) {
+            gen->set_multicast_interface(dev.empty() ? "lo" : dev);
+        }
+        gen->start();
+    }
+
+    const auto t_stop = SteadyClock::now() + std::chrono::milliseconds(static_cast<int64_t>(cfg.seconds * 1000));
+    SteadyClock::time_point first{}, last{};
+    uint64_t bytes = 0;
+    bool stopped = false;
+    while (true) {
+        if (!stopped && (g_stop || SteadyClock::now() >= t_stop)) {
+            if (gen) {
+                gen->stop();
+            }
+            stopped = true;
+            if (cfg.external) {
+                break;
+            }
+        }
+        size_t n;
+        try {
+            n = reader.read_into(buf.data());
+        } catch (const ReadTimeout&) {
+            if (stopped) {
+                break;  // generator done and the queue drained
+            }
+            continue;
+        }
+        if (n == 0) {
+            break;  // interrupted
+        }
+        const int64_t rx_ns = load_gen_now_ns();
+        last = SteadyClock::now();
+        if (first == SteadyClock::time_point{}) {
+            first = last;
+        }
+        bytes += n;
+
+        const ChunkSegment* segs;
+        size_t k = reader.get_segments(segs);
+        ChunkSegment whole{0, n, 0};
+        if (k == 0) {
+            segs = &whole;
+            k = 1;
+        }
+        const PacketMeta* meta;
+        const bool have_meta = reader.get_packet_meta(meta) == k;
+        for (size_t i = 0; i < k; ++i) {
+            if ((segs[i].flags & SEG_FILLED) || segs[i].length < LOAD_GEN_TS_OFFSET + 8) {
+                continue;
+            }
+            int64_t tx_ns;
+            std::memcpy(&tx_ns, buf.data() + segs[i].offset + LOAD_GEN_TS_OFFSET, 8);
+            add_sample(app_ns, rx_ns - tx_ns);
+            if (have_meta && meta[i].ts_source == TsSource::SOFTWARE) {
+                add_sample(kernel_ns, static_cast<int64_t>(meta[i].ts_ns) - tx_ns);
+            }
+        }
+    }
+
+    const SeqStats& st = reader.get_seq_stats();
+    r.received = st.received - st.duplicates;
+    r.duplicates = st.duplicates;
+    r.reordered = st.reordered;
+    if (gen) {
+        r.sent = gen->get_sent();
+        r.lost = r.sent > r.received ? r.sent - r.received : 0;  // includes the tail after the last one seen
+    } else {
+        r.lost = st.lost;
+    }
+    ReaderStats rs;
+    if (reader.get_stats(rs)) {
+        r.kernel_drops_valid = rs.kernel_drops_valid;
+        r.kernel_drops = rs.kernel_drops;
+    }
+    double sec = std::chrono::duration<double>(last - first).count();
+    r.rx_gbps = sec > 0 ? double(bytes) * 8.0 / sec / 1e9 : 0.0;
+    r.app = summarize(app_ns);
+    r.kernel = summarize(kernel_ns);
+    return r;
+}
+
+static void print_header()
+{
+    std::printf("%8s %10s %10s %9s %8s %6s %8s %9s %9s %9s %9s %9s\n", "target", "sent", "received", "loss %",
+                "reorder", "dup", "rx Gbps", "p50 us", "p99 us", "p99.9 us", "max us", "kern p99");
+}
+
+static void print_row(const RateResult& r, bool ok)
+{
+    char target[16];
+    if (r.target_gbps < 0) {
+        std::snprintf(target, sizeof(target), "ext");
+    } else if (r.target_gbps == 0) {
+        std::snprintf(target, sizeof(target), "max");
+    } else {
+        std::snprintf(target, sizeof(target), "%.2f", r.target_gbps);
+    }
+    std::printf("%8s %10llu %10llu %9.4f %8llu %6llu %8.2f %9.1f %9.1f %9.1f %9.1f", target,
+                static_cast<unsigned long long>(r.sent), static_cast<unsigned long long>(r.received),
+                r.loss_ratio() * 100.0, static_cast<unsigned long long>(r.reordered),
+                static_cast<unsigned long long>(r.duplicates), r.rx_gbps, r.app.p50_us, r.app.p99_us,
+                r.app.p999_us, r.app.max_us);
+    if (r.kernel.samples) {
+        std::printf(" %9.1f", r.kernel.p99_us);
+    } else {
+        std::printf(" %9s", "-");
+    }
+    if (r.kernel_drops_valid) {
+        std::printf("  kernel drops %llu", static_cast<unsigned long long>(r.kernel_drops));
+    }
+    std::printf("  %s\n", ok ? "ok" : "LOSS");
+    std::fflush(stdout);
+}
+
+static std::vector<double> parse_rates(const std::string& s)
+{
+    std::vector<double> out;
+    std::stringstream ss(s);
+    std::string tok;
+    while (std::getline(ss, tok, ',')) {
+        if (!tok.empty()) {
+            out.push_back(tok == "max" ? 0.0 : std::strtod(tok.c_str(), nullptr));
+        }
+    }
+    return out;
+}
+
+int main(int argc, char* argv[])
+{
+    // defaults
+    std::string uri = "udp://lo:127.0.0.1:9999?batch=64&timeout=200";
+    std::string rates = "0.5,1,2,4";
+    double max_loss = 1e-4;
+    RunCfg cfg;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--uri") == 0 && i + 1 < argc) {
+            uri = argv[++i];
+        } else if (std::strcmp(argv[i], "--gbps") == 0 && i + 1 < argc) {
+            rates = argv[++i];
+        } else if (std::strcmp(argv[i], "--pkt") == 0 && i + 1 < argc) {
+            cfg.pkt = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            cfg.chunk = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--dur-sec") == 0 && i + 1 < argc) {
+            cfg.seconds = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--gen-batch") == 0 && i + 1 < argc) {
+            cfg.gen_batch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--max-loss") == 0 && i + 1 < argc) {
+            max_loss = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--external") == 0) {
+            cfg.external = true;
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--uri <reader uri>] [--gbps r1,r2,..|max] [--pkt <bytes>] [--chunk <bytes>]"
+                      << " [--dur-sec <sec per rate>] [--gen-batch <n>] [--max-loss <fraction>] [--external]"
+                      << "\n   1) UDP engine sweep:  " << argv[0] << " --uri \"udp://lo:127.0.0.1:9999?batch=64&timeout=200\" --gbps 1,2,4,8"
+                      << "\n   2) TPACKET, 8K pkts:  " << argv[0] << " --uri \"udp://lo:127.0.0.1:9999?engine=tpacket&batch=64&timeout=200\" --pkt 7184"
+                      << "\n   3) capture thread:    " << argv[0] << " --uri \"udp://lo:127.0.0.1:9999?batch=64&timeout=200&stages=thread&thread.cpu=rx\""
+                      << "\n   4) stack latency:     " << argv[0] << " --uri \"udp://lo:127.0.0.1:9999?batch=64&timeout=200&tstamp=sw\" --gbps 1"
+                      << "\n   5) remote udp_gen:    " << argv[0] << " --uri \"udp://enp3s0:0.0.0.0:9999?batch=64\" --external --dur-sec 10"
+                      << "\n";
+            return 1;
+        }
+    }
+    std::signal(SIGINT, signal_handler);
+
+    try {
+        cfg.uri = parse_reader_uri(uri);
+        if (cfg.chunk == 0) {
+            cfg.chunk = std::max<size_t>(64 * cfg.pkt, 65536);
+        }
+        std::vector<double> sweep = cfg.external ? std::vector<double>{-1.0} : parse_rates(rates);
+        if (sweep.empty()) {
+            throw std::runtime_error("No rates in --gbps '" + rates + "'");
+        }
+        std::cout << "Reader: " << uri << ", " << cfg.pkt << "-byte datagrams, " << cfg.seconds << " s per rate, "
+                  << "max loss " << max_loss * 100.0 << " %\n";
+        print_header();
+
+        double best = -1.0;
+        bool best_max = false;
+        for (double gbps : sweep) {
+            if (g_stop) {
+                break;
+            }
+            RateResult r = run_rate(cfg, gbps);
+            bool ok = r.received > 0 && r.loss_ratio() <= max_loss;
+            print_row(r, ok);
+            if (ok && !cfg.external && r.rx_gbps > best) {
+                best = r.rx_gbps;
+                best_max = gbps == 0.0;
+            }
+        }
+        if (!cfg.external) {
+            if (best < 0) {
+                std::cout << "No rate sustained within the loss limit\n";
+            } else {
+                std::cout << "Max sustained: " << std::fixed << std::setprecision(2) << best << " Gbps"
+                          << (best_max ? " (generator at full speed)" : "") << "\n";
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
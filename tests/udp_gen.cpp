@@ -0,0 +1,108 @@
+// udp_gen - paced sendmmsg UDP load generator (seq + send timestamp per
+// datagram), the C++ replacement for scripts/gen_tst_udp_test_stream.py
+// at line rate. Pair with test_udp_e2e --external on the receiving host.
+#include "udp_load_gen.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <atomic>
+
+static std::atomic<bool> g_stop{false};
+
+static void signal_handler(int) { g_stop = true; }
+
+int main(int argc, char* argv[])
+{
+    // defaults
+    std::string ip = "127.0.0.1";
+    uint16_t port = 9999;
+    std::string dev;
+    size_t pkt = 1400;
+    double gbps = 1.0;
+    size_t batch = 32;
+    double dur_sec = -1.0;
+    bool timestamps = true;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--addr") == 0 && i + 1 < argc) {
+            std::string a = argv[++i];
+            size_t c = a.rfind(':');
+            ip = a.substr(0, c);
+            if (ip.size() > 1 && ip.front() == '[' && ip.back() == ']') {
+                ip = ip.substr(1, ip.size() - 2);
+            }
+            port = static_cast<uint16_t>(std::atoi(a.c_str() + c + 1));
+        } else if (std::strcmp(argv[i], "--dev") == 0 && i + 1 < argc) {
+            dev = argv[++i];
+        } else if (std::strcmp(argv[i], "--pkt") == 0 && i + 1 < argc) {
+            pkt = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--gbps") == 0 && i + 1 < argc) {
+            gbps = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--dur-sec") == 0 && i + 1 < argc) {
+            dur_sec = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--no-ts") == 0) {
+            timestamps = false;
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--addr ip:port] [--dev <iface>] [--pkt <bytes>] [--gbps <rate>, 0 = max]"
+                      << " [--batch <n>] [--dur-sec <sec>] [--no-ts]"
+                      << "\n   1) 5 Gbps jumbo:    " << argv[0] << " --addr 192.168.250.196:9999 --pkt 7184 --gbps 5"
+                      << "\n   2) as fast as able: " << argv[0] << " --addr 127.0.0.1:9999 --gbps 0 --batch 64 --dur-sec 10"
+                      << "\n   3) multicast:       " << argv[0] << " --addr 239.1.2.3:9999 --dev enp3s0 --gbps 2"
+                      << "\n";
+            return 1;
+        }
+    }
+    std::signal(SIGINT, signal_handler);
+
+    try {
+        UdpLoadGen gen(ip, port, pkt, gbps * 1e9, batch);
+        gen.set_timestamps(timestamps);
+        if (is_multicast_address(ip)) {
+            gen.set_multicast_interface(dev);
+        }
+        std::cout << "Sending to " << ip << ":" << port << ", " << pkt << "-byte datagrams, ";
+        if (gbps > 0) {
+            std::cout << gbps << " Gbps";
+        } else {
+            std::cout << "max rate";
+        }
+        std::cout << ", batch " << batch << (timestamps ? ", timestamped" : "") << "\n";
+
+        gen.start();
+        auto t0 = std::chrono::steady_clock::now();
+        auto elapsed = [&]() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
+        uint64_t last_sent = 0;
+        double last_t = 0.0;
+        while (!g_stop && (dur_sec < 0 || elapsed() < dur_sec)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            double t = elapsed();
+            if (t - last_t < 1.0) {
+                continue;
+            }
+            uint64_t sent = gen.get_sent();
+            double pps = double(sent - last_sent) / (t - last_t);
+            std::cout << "[" << std::fixed << std::setprecision(1) << t << " s] " << sent << " sent, "
+                      << std::setprecision(0) << pps << " pps, " << std::setprecision(2)
+                      << pps * double(pkt) * 8.0 / 1e9 << " Gbps\n";
+            last_sent = sent;
+            last_t = t;
+        }
+        gen.stop();
+        double dt = elapsed();
+        std::cout << "Total: " << gen.get_sent() << " datagrams in " << std::fixed << std::setprecision(2) << dt
+                  << " s, " << double(gen.get_sent()) * double(pkt) * 8.0 / dt / 1e9 << " Gbps, "
+                  << gen.get_send_errors() << " send stalls\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
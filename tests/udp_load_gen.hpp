@@ -0,0 +1,191 @@
+// udp_load_gen.hpp - paced UDP sender for benchmarks (test side, not part of the library)
+#pragma once
+#include "../data-stream/socket_common.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+// Datagram layout: int64 LE sequence number at 0, then (set_timestamps)
+// int64 LE send time at LOAD_GEN_TS_OFFSET, ns since the system_clock
+// epoch, so a receiver on a synced clock can measure one-way latency
+constexpr size_t LOAD_GEN_TS_OFFSET = 8;
+
+inline int64_t load_gen_now_ns() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Sends datagrams of pkt_size bytes with the gen_tst_udp_test_stream.py
+// layout (int64 LE sequence number, then filler) from a background thread.
+// rate_bps = 0 sends as fast as the socket accepts. Linux sends `batch`
+// datagrams per sendmmsg call; Windows uses sendto. Pacing is per call
+// (sleep, then spin to the due time), so batch is also the burst size.
+// ip may be IPv6 or a multicast group (see set_multicast_interface()).
+class UdpLoadGen {
+private:
+    std::string ip_;
+    uint16_t port_;
+    size_t pkt_size_;
+    double rate_bps_;
+    size_t batch_;
+    bool timestamps_ = false;
+    std::atomic<bool> run_{false};
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> send_errors_{0};
+    std::thread thr_;
+
+#ifdef _WIN32
+    SOCKET sock_ = INVALID_SOCKET_FD;
+#else
+    int sock_ = INVALID_SOCKET_FD;
+#endif
+
+    void loop() {
+        struct sockaddr_storage dst;
+        const socklen_t dst_len = make_sockaddr(ip_, port_, dst);
+
+        const size_t batch = batch_ ? batch_ : 1;
+        std::vector<uint8_t> bufs(batch * pkt_size_);
+        for (size_t i = 0; i < bufs.size(); ++i) {
+            bufs[i] = static_cast<uint8_t>(i * 7);
+        }
+#ifndef _WIN32
+        std::vector<struct mmsghdr> msgs(batch);
+        std::vector<struct iovec> iovs(batch);
+        for (size_t i = 0; i < batch; ++i) {
+            iovs[i].iov_base = bufs.data() + i * pkt_size_;
+            iovs[i].iov_len = pkt_size_;
+            std::memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &dst;
+            msgs[i].msg_hdr.msg_namelen = dst_len;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+#endif
+        // Pacing: datagram n is due at t0 + n * period
+        const double period_ns = rate_bps_ > 0 ? double(pkt_size_) * 8.0 * 1e9 / rate_bps_ : 0.0;
+        const auto t0 = std::chrono::steady_clock::now();
+        uint64_t seq = 0;
+        while (run_.load(std::memory_order_relaxed)) {
+            if (period_ns > 0) {
+                auto due = t0 + std::chrono::nanoseconds(static_cast<int64_t>(double(seq) * period_ns));
+                auto now = std::chrono::steady_clock::now();
+                if (due > now + std::chrono::microseconds(200)) {
+                    std::this_thread::sleep_for(due - now - std::chrono::microseconds(100));
+                    continue;
+                }
+                while (std::chrono::steady_clock::now() < due) {
+                }
+            }
+            const int64_t ts = timestamps_ ? load_gen_now_ns() : 0;
+            for (size_t i = 0; i < batch; ++i) {
+                uint64_t s = seq + i;
+                uint8_t* d = bufs.data() + i * pkt_size_;
+                std::memcpy(d, &s, 8);  // LE hosts
+                if (timestamps_) {
+                    std::memcpy(d + LOAD_GEN_TS_OFFSET, &ts, 8);
+                }
+            }
+#ifdef _WIN32
+            size_t n = 0;
+            for (; n < batch; ++n) {
+                if (sendto(sock_, reinterpret_cast<const char*>(bufs.data() + n * pkt_size_),
+                           static_cast<int>(pkt_size_), 0,
+                           reinterpret_cast<const struct sockaddr*>(&dst), dst_len) < 0) {
+                    break;
+                }
+            }
+#else
+            int rc = sendmmsg(sock_, msgs.data(), static_cast<unsigned>(batch), 0);
+            size_t n = rc > 0 ? static_cast<size_t>(rc) : 0;
+#endif
+            if (n == 0) {
+                send_errors_.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::yield();  // ENOBUFS / EAGAIN: let the receiver catch up
+                continue;
+            }
+            seq += n;
+            sent_.store(seq, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    UdpLoadGen(const std::string& ip, uint16_t port, size_t pkt_size, double rate_bps = 0.0, size_t batch = 32)
+        : ip_(ip), port_(port), pkt_size_(pkt_size < 8 ? 8 : pkt_size), rate_bps_(rate_bps), batch_(batch)
+    {
+#ifdef _WIN32
+        WSAInitializer::instance();
+#endif
+        sock_ = socket(is_ipv6_address(ip) ? AF_INET6 : AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock_ == INVALID_SOCKET_FD) {
+            throw SocketError("Failed to create sender socket: " + get_last_socket_error());
+        }
+        int sndbuf = SOCKET_RCVBUF_SIZE;
+        setsockopt(sock_, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&sndbuf), sizeof(sndbuf));
+    }
+
+    ~UdpLoadGen() {
+        stop();
+        close_socket(sock_);
+    }
+
+    UdpLoadGen(const UdpLoadGen&) = delete;
+    UdpLoadGen& operator=(const UdpLoadGen&) = delete;
+
+    // Egress interface (name or index) for a multicast group; loops back locally
+    void set_multicast_interface(const std::string& dev) {
+        const uint32_t ifindex = interface_index(dev);
+        const int loop = 1;
+        int rc;
+        if (is_ipv6_address(ip_)) {
+            const int idx = static_cast<int>(ifindex);
+            rc = setsockopt(sock_, IPPROTO_IPV6, IPV6_MULTICAST_IF, reinterpret_cast<const char*>(&idx), sizeof(idx));
+            setsockopt(sock_, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, reinterpret_cast<const char*>(&loop), sizeof(loop));
+        } else {
+#ifdef _WIN32
+            const DWORD idx = htonl(ifindex);  // 0.0.0.x form selects by index
+            rc = setsockopt(sock_, IPPROTO_IP, IP_MULTICAST_IF, reinterpret_cast<const char*>(&idx), sizeof(idx));
+#else
+            struct ip_mreqn req;
+            std::memset(&req, 0, sizeof(req));
+            req.imr_ifindex = static_cast<int>(ifindex);
+            rc = setsockopt(sock_, IPPROTO_IP, IP_MULTICAST_IF, &req, sizeof(req));
+#endif
+            setsockopt(sock_, IPPROTO_IP, IP_MULTICAST_LOOP, reinterpret_cast<const char*>(&loop), sizeof(loop));
+        }
+        if (rc != 0) {
+            throw SocketError("Failed to set multicast interface " + dev + ": " + get_last_socket_error());
+        }
+    }
+
+    // Send from this local address (ephemeral port), e.g. the SSM source a
+    // receiver filters on; by default the kernel picks the egress address
+    void set_source_address(const std::string& src) {
+        struct sockaddr_storage ss;
+        const socklen_t len = make_sockaddr(src, 0, ss);
+        if (bind(sock_, reinterpret_cast<const struct sockaddr*>(&ss), len) != 0) {
+            throw SocketError("Failed to bind sender to " + src + ": " + get_last_socket_error());
+        }
+    }
+
+    // Stamp the send time into every datagram (pkt_size >= 16; call before start())
+    void set_timestamps(bool on) noexcept { timestamps_ = on && pkt_size_ >= LOAD_GEN_TS_OFFSET + 8; }
+
+    void start() {
+        if (!run_.exchange(true)) {
+            thr_ = std::thread(&UdpLoadGen::loop, this);
+        }
+    }
+
+    void stop() {
+        run_ = false;
+        if (thr_.joinable()) {
+            thr_.join();
+        }
+    }
+
+    uint64_t get_sent() const noexcept { return sent_.load(std::memory_order_relaxed); }
+    uint64_t get_send_errors() const noexcept { return send_errors_.load(std::memory_order_relaxed); }
+};